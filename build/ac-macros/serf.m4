@@ -184,6 +184,38 @@ AC_DEFUN(SVN_SERF_PKG_CONFIG,
   fi
 ])
 
+dnl SVN_SERF_HTTP2_CHECK()
+dnl Check whether the serf library found by SVN_LIB_SERF can negotiate
+dnl HTTP/2 via ALPN.  No released serf version does yet, so test for the
+dnl API itself instead of relying on a version number.
+AC_DEFUN(SVN_SERF_HTTP2_CHECK,
+[
+  AC_MSG_CHECKING([whether serf supports HTTP/2])
+  svn_serf_save_CPPFLAGS="$CPPFLAGS"
+  svn_serf_save_LIBS="$LIBS"
+  CPPFLAGS="$CPPFLAGS $SVN_APR_INCLUDES $SVN_APRUTIL_INCLUDES $SVN_SERF_INCLUDES"
+  LIBS="$LIBS $SVN_SERF_LIBS $SVN_APRUTIL_LIBS $SVN_APR_LIBS"
+  AC_LINK_IFELSE([AC_LANG_PROGRAM([[
+#include "serf.h"
+static apr_status_t
+negotiated(void *data, const char *protocol)
+{
+  return APR_SUCCESS;
+}
+]], [[
+  serf_ssl_context_t *ssl_ctx = NULL;
+  serf_connection_t *conn = NULL;
+  serf_ssl_negotiate_protocol(ssl_ctx, "h2,http/1.1", negotiated, NULL);
+  serf_connection_set_framing_type(conn, SERF_CONNECTION_FRAMING_TYPE_HTTP2);
+]])],
+    [AC_MSG_RESULT([yes])
+     AC_DEFINE([SVN_SERF_HAVE_HTTP2], 1,
+               [Defined if serf supports negotiating HTTP/2])],
+    [AC_MSG_RESULT([no])])
+  CPPFLAGS="$svn_serf_save_CPPFLAGS"
+  LIBS="$svn_serf_save_LIBS"
+])
+
 dnl SVN_DOWNLOAD_SERF()
 dnl no serf found, print out a message telling the user what to do
 AC_DEFUN(SVN_DOWNLOAD_SERF,
@@ -81,6 +81,44 @@ svn_io__is_finfo_read_only(svn_boolean_t *read_only,
 apr_size_t
 svn_io__next_chunk_size(apr_off_t total_read);
 
+/** Copy the contents of @a from_file to @a to_file, both of which must be
+ * positioned at their start, without translating them.
+ *
+ * Where the platform and filesystem support it (e.g. FICLONE on btrfs or
+ * XFS), @a to_file is created as a copy-on-write clone of @a from_file that
+ * shares all data blocks with it.  Otherwise the data is copied inside the
+ * kernel if possible, or by reading and writing it as a last resort.  Set
+ * @a *shared_bytes to the number of bytes that are known to be shared
+ * between both files (0 if the data was copied).
+ *
+ * Use @a cancel_func and @a cancel_baton for cancellation and
+ * @a scratch_pool for temporary allocations.  The file positions are
+ * undefined after this call.
+ *
+ * @since New in 1.9.
+ */
+svn_error_t *
+svn_io__copy_file_contents(svn_filesize_t *shared_bytes,
+                           apr_file_t *from_file,
+                           apr_file_t *to_file,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool);
+
+/** Create @a new_abspath as an additional hard link to the existing file
+ * @a existing_abspath.  Both paths must be on the same filesystem.
+ *
+ * Return the error of the underlying operating system call (e.g. EXDEV
+ * or EPERM) if the link can't be created, and #APR_ENOTIMPL on platforms
+ * that don't support hard links.
+ *
+ * @since New in 1.9.
+ */
+svn_error_t *
+svn_io__create_hardlink(const char *existing_abspath,
+                        const char *new_abspath,
+                        apr_pool_t *scratch_pool);
+
 /** Buffer test handler function for a generic stream. @see svn_stream_t
  * and svn_stream__is_buffered().
  *
@@ -263,6 +263,14 @@ svn_rangelist__merge_many(svn_rangelist_t *merged_rangelist,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/* Set *HITS and *MISSES to the number of lookups in the process-wide
+ * cache of parsed mergeinfo used by svn_mergeinfo_parse() that could
+ * respectively could not be served from the cache.  Only mergeinfo
+ * strings large enough to be worth caching are counted. */
+svn_error_t *
+svn_mergeinfo__get_parse_cache_stats(apr_uint64_t *hits,
+                                     apr_uint64_t *misses);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -38,7 +38,8 @@
  * Two modes are supported: shared use and exclusive use.  In shared mode,
  * any object can be handed out to multiple users and in potentially
  * different threads at the same time.  In exclusive mode, the same object
- * will only be referenced at most once.
+ * will only be referenced at most once and only a limited number of
+ * unused instances will be kept per key.
  *
  * Object creation and access must be provided outside this structure.
  * In particular, the using container will usually wrap the actual object
@@ -90,6 +91,11 @@ typedef svn_error_t * (* svn_object_pool__setter_t)(void **target,
  * one (or both) may be NULL and the default implementation assumes that
  * wrapper == object and updating is a no-op.
  *
+ * If SHARE_OBJECTS is set, objects will be handed out to any number of
+ * users at the same time (shared mode).  Otherwise, every object will be
+ * used by at most one user at a time and lookups will only return objects
+ * that have been released by their previous user (exclusive mode).
+ *
  * If THREAD_SAFE is not set, neither the object pool nor the object
  * references returned from it may be accessed from multiple threads.
  *
@@ -102,6 +108,7 @@ svn_error_t *
 svn_object_pool__create(svn_object_pool__t **object_pool,
                         svn_object_pool__getter_t getter,
                         svn_object_pool__setter_t setter,
+                        svn_boolean_t share_objects,
                         svn_boolean_t thread_safe,
                         apr_pool_t *pool);
 
@@ -133,7 +140,9 @@ svn_object_pool__lookup(void **object,
                         apr_pool_t *result_pool);
 
 /* Store the wrapped object WRAPPER under KEY in OBJECT_POOL and return
- * a reference to the object in *OBJECT (just like lookup).
+ * a reference to the object in *OBJECT (just like lookup).  In exclusive
+ * mode, WRAPPER will always be added as a new instance and only become
+ * available to lookups once that reference has been released.
  *
  * The object must have been created in WRAPPER_POOL and the latter must
  * be a sub-pool of OBJECT_POOL's root POOL (see #svn_object_pool__pool).
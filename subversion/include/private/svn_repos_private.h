@@ -127,6 +127,22 @@ svn_repos__replay_ev2(svn_fs_root_t *root,
                       void *authz_read_baton,
                       apr_pool_t *scratch_pool);
 
+/* Make the report REPORT_BATON, as returned by svn_repos_begin_report3(),
+ * call AUTHZ_SUBTREE_FUNC with AUTHZ_SUBTREE_BATON to find out whether
+ * all of a directory's subtree is readable.  For every directory where
+ * that is the case, the authz_read_func given to svn_repos_begin_report3()
+ * will not be called for any node within that directory's subtree.
+ * AUTHZ_SUBTREE_FUNC will only be asked for #svn_authz_read combined with
+ * #svn_authz_recursive.  It may be NULL to disable that optimization.
+ *
+ * This must be called before the report is finished.
+ */
+void
+svn_repos__report_set_authz_subtree_func(
+  void *report_baton,
+  svn_repos_authz_callback_t authz_subtree_func,
+  void *authz_subtree_baton);
+
 /* Given a PATH which might be a relative repo URL (^/), an absolute
  * local repo URL (file://), an absolute path outside of the repo
  * or a location in the Windows registry.
@@ -260,6 +276,56 @@ svn_repos__authz_pool_get(svn_authz_t **authz_p,
 
 /** @} */
 
+/**
+ * @defgroup svn_repos_pool Repository object pool API
+ * @{
+ */
+
+/* Opaque thread-safe factory and container for repository objects.
+ *
+ * Repository objects are not thread-safe.  Hence, every instance will be
+ * handed out to at most one user at a time.  Once released, an instance
+ * will be reset and may be handed out to the next user that requests the
+ * same repository.  Unused repository objects may linger for a while
+ * before being cleaned up.
+ */
+typedef struct svn_repos__repos_pool_t svn_repos__repos_pool_t;
+
+/* Create a new repository pool object with a lifetime determined by
+ * POOL and return it in *REPOS_POOL.  All repositories will be opened
+ * with FS_CONFIG, which must remain valid at least until POOL cleanup.
+ *
+ * The THREAD_SAFE flag indicates whether the pool actually needs to be
+ * thread-safe and POOL must be also be thread-safe if this flag is set.
+ */
+svn_error_t *
+svn_repos__repos_pool_create(svn_repos__repos_pool_t **repos_pool,
+                             apr_hash_t *fs_config,
+                             svn_boolean_t thread_safe,
+                             apr_pool_t *pool);
+
+/* Set *REPOS_P to an exclusive reference to the repository at PATH.
+ * The repository will either be taken from REPOS_POOL or be opened
+ * freshly using svn_repos_open3().
+ *
+ * The reference will be returned to REPOS_POOL when RESULT_POOL gets
+ * cleaned up.  At that point, any FS access context, FS warning function
+ * and client capabilities set on the repository will be reset.  Users
+ * must not keep any other state in the repository object or its pool.
+ *
+ * RESULT_POOL must not exceed the lifetime of the pool provided to
+ * #svn_repos__repos_pool_create.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+svn_error_t *
+svn_repos__repos_pool_get(svn_repos_t **repos_p,
+                          svn_repos__repos_pool_t *repos_pool,
+                          const char *path,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -1520,6 +1520,11 @@ SVN_ERROR_START
              SVN_ERR_RA_SVN_CATEGORY_START + 8,
              "Editor drive was aborted")
 
+  /** @since New in 1.9. */
+  SVN_ERRDEF(SVN_ERR_RA_SVN_AUTH_REQUIRED,
+             SVN_ERR_RA_SVN_CATEGORY_START + 9,
+             "Authentication required but not possible for pipelined command")
+
   /* libsvn_auth errors */
 
        /* this error can be used when an auth provider doesn't have
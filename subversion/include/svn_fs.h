@@ -95,6 +95,17 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_CACHE_REVPROPS       "fsfs-cache-revprops"
 
+/** Enable / disable lock caching for a FSFS repository.
+ *
+ * Like #SVN_FS_CONFIG_FSFS_CACHE_REVPROPS, "2" is allowed, too and
+ * means "enable if efficient".  When enabled, lock queries and commit
+ * time lock verification will be served from the cache as long as no
+ * lock has been added or removed in the meantime.
+ *
+ * @since New in 1.9.
+ */
+#define SVN_FS_CONFIG_FSFS_CACHE_LOCKS          "fsfs-cache-locks"
+
 /** Select the cache namespace.  If you potentially share the cache with
  * another FS object for the same repository, objects read through one FS
  * will not need to be read again for the other.  In most cases, that is
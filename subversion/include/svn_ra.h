@@ -1097,6 +1097,40 @@ svn_ra_get_file(svn_ra_session_t *session,
                 apr_hash_t **props,
                 apr_pool_t *pool);
 
+/**
+ * Like svn_ra_get_file(), but for all paths in @a paths
+ * (<tt>const char *</tt>, each relative to the @a session's URL).
+ *
+ * @a streams must be @c NULL or have the same number of elements as
+ * @a paths.  In the latter case, the contents of each file will be
+ * pushed into the @c svn_stream_t * at the same index in @a streams.
+ * Elements may be @c NULL if the respective contents are not wanted.
+ *
+ * All files will be retrieved from the same revision.  If @a revision
+ * is @c SVN_INVALID_REVNUM (meaning 'head') and @a fetched_rev is not
+ * @c NULL, set @a *fetched_rev to the revision that was retrieved.
+ *
+ * If @a props is non @c NULL, set @a *props to a hash mapping each path
+ * to its properties as described for svn_ra_get_file().
+ *
+ * RA layers may process the paths without waiting for the server's
+ * response to one path before requesting the next one.  If one of the
+ * paths cannot be retrieved, the other streams may or may not have
+ * received their contents.
+ *
+ * Use @a pool for all allocations.
+ *
+ * @since New in 1.9.
+ */
+svn_error_t *
+svn_ra_get_file_many(svn_ra_session_t *session,
+                     const apr_array_header_t *paths,
+                     svn_revnum_t revision,
+                     const apr_array_header_t *streams,
+                     svn_revnum_t *fetched_rev,
+                     apr_hash_t **props,
+                     apr_pool_t *pool);
+
 /**
  * If @a dirents is non @c NULL, set @a *dirents to contain all the entries
  * of directory @a path at @a revision.  The keys of @a dirents will be
@@ -1134,6 +1168,37 @@ svn_ra_get_dir2(svn_ra_session_t *session,
                 apr_uint32_t dirent_fields,
                 apr_pool_t *pool);
 
+/**
+ * Like svn_ra_get_dir2(), but for all paths in @a paths
+ * (<tt>const char *</tt>, each relative to the @a session's URL).
+ *
+ * If @a dirents is non @c NULL, set @a *dirents to a hash mapping each
+ * path to a hash of its entries as described for svn_ra_get_dir2().
+ * Likewise, if @a props is non @c NULL, set @a *props to a hash mapping
+ * each path to its properties.
+ *
+ * All directories will be retrieved from the same revision.  If
+ * @a revision is @c SVN_INVALID_REVNUM (meaning 'head') and
+ * @a fetched_rev is not @c NULL, set @a *fetched_rev to the revision
+ * that was retrieved.
+ *
+ * RA layers may process the paths without waiting for the server's
+ * response to one path before requesting the next one.
+ *
+ * Use @a pool for all allocations.
+ *
+ * @since New in 1.9.
+ */
+svn_error_t *
+svn_ra_get_dir_many(svn_ra_session_t *session,
+                    apr_hash_t **dirents,
+                    svn_revnum_t *fetched_rev,
+                    apr_hash_t **props,
+                    const apr_array_header_t *paths,
+                    svn_revnum_t revision,
+                    apr_uint32_t dirent_fields,
+                    apr_pool_t *pool);
+
 /**
  * Similar to @c svn_ra_get_dir2, but with @c SVN_DIRENT_ALL for the
  * @a dirent_fields parameter.
@@ -1714,6 +1779,29 @@ svn_ra_stat(svn_ra_session_t *session,
             svn_dirent_t **dirent,
             apr_pool_t *pool);
 
+/**
+ * Like svn_ra_stat(), but for all paths in @a paths (<tt>const char *</tt>,
+ * each relative to the @a session's URL).  Set @a *dirents to a hash
+ * mapping each path that exists in @a revision to its @c svn_dirent_t.
+ * Paths that do not exist will not be contained in @a *dirents.
+ *
+ * If @a revision is @c SVN_INVALID_REVNUM, all paths will be looked up in
+ * the same HEAD revision.
+ *
+ * RA layers may process the paths without waiting for the server's
+ * response to one path before requesting the next one.
+ *
+ * Use @a pool for memory allocation.
+ *
+ * @since New in 1.9.
+ */
+svn_error_t *
+svn_ra_stat_many(svn_ra_session_t *session,
+                 const apr_array_header_t *paths,
+                 svn_revnum_t revision,
+                 apr_hash_t **dirents,
+                 apr_pool_t *pool);
+
 
 /**
  * Set @a *uuid to the repository's UUID, allocated in @a pool.
@@ -68,6 +68,8 @@ extern "C" {
 #define SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS "ephemeral-txnprops"
 /* maps to SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE */
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
+/* server supports the "pipelined" command wrapper, see svn_ra_stat_many() */
+#define SVN_RA_SVN_CAP_PIPELINED_READS "pipelined-reads"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
@@ -2468,6 +2468,102 @@ locate_dir_cache(svn_fs_t *fs,
     }
 }
 
+/* Return a deep copy of the directory ENTRIES allocated in POOL. */
+static apr_array_header_t *
+copy_dir_entries(const apr_array_header_t *entries,
+                 apr_pool_t *pool)
+{
+  apr_array_header_t *result
+    = apr_array_make(pool, entries->nelts, sizeof(svn_fs_dirent_t *));
+  int i;
+
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      const svn_fs_dirent_t *entry
+        = APR_ARRAY_IDX(entries, i, const svn_fs_dirent_t *);
+      svn_fs_dirent_t *copy = apr_palloc(pool, sizeof(*copy));
+
+      copy->name = apr_pstrdup(pool, entry->name);
+      copy->id = svn_fs_fs__id_copy(entry->id, pool);
+      copy->kind = entry->kind;
+
+      APR_ARRAY_PUSH(result, svn_fs_dirent_t *) = copy;
+    }
+
+  return result;
+}
+
+/* Return TRUE, if the committed directory ENTRIES may fit into the dir
+ * cache of FS.  Only membuffer caches limit the size of their entries.
+ * For them, this is a cheap check based on a lower bound of the serialized
+ * size.  It saves us from serializing huge directories just to see them
+ * rejected.
+ */
+static svn_boolean_t
+is_dir_cachable(svn_fs_t *fs,
+                const apr_array_header_t *entries)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_size_t size = 0;
+  int i;
+
+  if (!ffd->dir_cache_size_limited)
+    return TRUE;
+
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      const svn_fs_dirent_t *entry
+        = APR_ARRAY_IDX(entries, i, const svn_fs_dirent_t *);
+      size += sizeof(*entry) + sizeof(entry) + sizeof(apr_uint32_t)
+            + strlen(entry->name) + 1;
+    }
+
+  return svn_cache__is_cachable(ffd->dir_cache, size);
+}
+
+/* If KEY identifies one of the large directories remembered in FS, return
+ * its entries.  Otherwise, return NULL.  The result is only valid until
+ * the next call to remember_large_dir() for FS.
+ */
+static apr_array_header_t *
+get_large_dir(svn_fs_t *fs,
+              const pair_cache_key_t *key)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  int i;
+
+  for (i = 0; i < SVN_FS_FS__LARGE_DIR_SLOTS; ++i)
+    if (   ffd->large_dirs[i]
+        && ffd->large_dir_keys[i].revision == key->revision
+        && ffd->large_dir_keys[i].second == key->second)
+      return ffd->large_dirs[i];
+
+  return NULL;
+}
+
+/* Remember a copy of the directory ENTRIES identified by KEY in FS,
+ * replacing the least recently added large directory if all slots are
+ * in use.
+ */
+static void
+remember_large_dir(svn_fs_t *fs,
+                   const pair_cache_key_t *key,
+                   const apr_array_header_t *entries)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  int slot = ffd->large_dir_next;
+
+  if (ffd->large_dir_pools[slot])
+    svn_pool_clear(ffd->large_dir_pools[slot]);
+  else
+    ffd->large_dir_pools[slot] = svn_pool_create(fs->pool);
+
+  ffd->large_dir_keys[slot] = *key;
+  ffd->large_dirs[slot] = copy_dir_entries(entries,
+                                           ffd->large_dir_pools[slot]);
+  ffd->large_dir_next = (slot + 1) % SVN_FS_FS__LARGE_DIR_SLOTS;
+}
+
 svn_error_t *
 svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
                             svn_fs_t *fs,
@@ -2491,13 +2587,31 @@ svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
         return SVN_NO_ERROR;
     }
 
+  /* Copying a directory that is too large for the cache is still much
+     cheaper than reading and parsing it again. */
+  if (key == &pair_key)
+    {
+      apr_array_header_t *large_dir = get_large_dir(fs, &pair_key);
+      if (large_dir)
+        {
+          *entries_p = copy_dir_entries(large_dir, result_pool);
+          return SVN_NO_ERROR;
+        }
+    }
+
   /* Read in the directory contents. */
   SVN_ERR(get_dir_contents(entries_p, fs, noderev, result_pool,
                            scratch_pool));
 
-  /* Update the cache, if we are to use one. */
+  /* Update the cache, if we are to use one.  Committed directories that
+     are too large for it will at least be remembered in FS. */
   if (cache)
-    SVN_ERR(svn_cache__set(cache, key, *entries_p, scratch_pool));
+    {
+      if (key != &pair_key || is_dir_cachable(fs, *entries_p))
+        SVN_ERR(svn_cache__set(cache, key, *entries_p, scratch_pool));
+      else
+        remember_large_dir(fs, &pair_key, *entries_p);
+    }
 
   return SVN_NO_ERROR;
 }
@@ -2542,14 +2656,19 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
   /* fetch data from disk if we did not find it in the cache */
   if (! found)
     {
-      apr_array_header_t *entries;
+      apr_array_header_t *entries = NULL;
       svn_fs_dirent_t *entry;
       svn_fs_dirent_t *entry_copy = NULL;
 
+      /* Large directories may have been remembered outside the cache. */
+      if (key == &pair_key)
+        entries = get_large_dir(fs, &pair_key);
+
       /* read the dir from the file system. It will probably be put it
          into the cache for faster lookup in future calls. */
-      SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, noderev,
-                                          scratch_pool, scratch_pool));
+      if (entries == NULL)
+        SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, noderev,
+                                            scratch_pool, scratch_pool));
 
       /* find desired entry and return a copy in POOL, if found */
       entry = svn_fs_fs__find_dir_entry(entries, name, NULL);
@@ -66,8 +66,8 @@ normalize_key_part(const char *original,
   return normalized->data;
 }
 
-/* *CACHE_TXDELTAS, *CACHE_FULLTEXTS and *CACHE_REVPROPS flags will be set
-   according to FS->CONFIG.  *CACHE_NAMESPACE receives the cache prefix
+/* *CACHE_TXDELTAS, *CACHE_FULLTEXTS, *CACHE_REVPROPS and *CACHE_LOCKS
+   flags will be set according to FS->CONFIG.  *CACHE_NAMESPACE receives the cache prefix
    to use.
 
    Use FS->pool for allocating the memcache and CACHE_NAMESPACE, and POOL
@@ -77,6 +77,7 @@ read_config(const char **cache_namespace,
             svn_boolean_t *cache_txdeltas,
             svn_boolean_t *cache_fulltexts,
             svn_boolean_t *cache_revprops,
+            svn_boolean_t *cache_locks,
             svn_fs_t *fs,
             apr_pool_t *pool)
 {
@@ -137,6 +138,20 @@ read_config(const char **cache_namespace,
   else
     *cache_revprops = svn_named_atomic__is_efficient();
 
+  /* don't cache locks by default.
+   * Like revprop caching, this requires named atomics to detect lock
+   * changes made by other processes.  Option "2" means "if efficient".
+   */
+  if (strcmp(svn_hash__get_cstring(fs->config,
+                                   SVN_FS_CONFIG_FSFS_CACHE_LOCKS,
+                                   ""), "2"))
+    *cache_locks
+      = svn_hash__get_bool(fs->config,
+                           SVN_FS_CONFIG_FSFS_CACHE_LOCKS,
+                           FALSE);
+  else
+    *cache_locks = svn_named_atomic__is_efficient();
+
   return SVN_NO_ERROR;
 }
 
@@ -369,6 +384,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   svn_boolean_t cache_txdeltas;
   svn_boolean_t cache_fulltexts;
   svn_boolean_t cache_revprops;
+  svn_boolean_t cache_locks;
   const char *cache_namespace;
 
   /* Evaluating the cache configuration. */
@@ -376,6 +392,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                       &cache_txdeltas,
                       &cache_fulltexts,
                       &cache_revprops,
+                      &cache_locks,
                       fs,
                       pool));
 
@@ -456,6 +473,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  ffd->dir_cache_size_limited = ffd->dir_cache && membuffer;
 
   /* Only 16 bytes per entry (a revision number + the corresponding offset).
      Since we want ~8k pages, that means 512 entries per page. */
@@ -572,6 +590,20 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+
+      SVN_ERR(create_cache(&(ffd->descendant_mergeinfo_cache),
+                           NULL,
+                           membuffer,
+                           0, 0, /* Do not use inprocess cache */
+                           svn_fs_fs__serialize_properties,
+                           svn_fs_fs__deserialize_properties,
+                           APR_HASH_KEY_STRING,
+                           apr_pstrcat(pool, prefix, "SUB_MERGEINFO",
+                                       SVN_VA_NULL),
+                           0,
+                           fs,
+                           no_handler,
+                           fs->pool, pool));
     }
   else
     {
@@ -579,6 +611,7 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
       ffd->properties_cache = NULL;
       ffd->mergeinfo_cache = NULL;
       ffd->mergeinfo_existence_cache = NULL;
+      ffd->descendant_mergeinfo_cache = NULL;
     }
 
   /* if enabled, cache revprops */
@@ -588,9 +621,9 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            NULL,
                            membuffer,
                            0, 0, /* Do not use inprocess cache */
-                           svn_fs_fs__serialize_properties,
-                           svn_fs_fs__deserialize_properties,
-                           sizeof(pair_cache_key_t),
+                           svn_fs_fs__serialize_revprops,
+                           svn_fs_fs__deserialize_revprops,
+                           sizeof(svn_revnum_t),
                            apr_pstrcat(pool, prefix, "REVPROP",
                                        SVN_VA_NULL),
                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
@@ -603,6 +636,28 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
       ffd->revprop_cache = NULL;
     }
 
+  /* if enabled, cache lock digest files */
+  if (cache_locks)
+    {
+      SVN_ERR(create_cache(&(ffd->lock_cache),
+                           NULL,
+                           membuffer,
+                           0, 0, /* Do not use inprocess cache */
+                           svn_fs_fs__serialize_properties,
+                           svn_fs_fs__deserialize_properties,
+                           APR_HASH_KEY_STRING,
+                           apr_pstrcat(pool, prefix, "LOCK",
+                                       SVN_VA_NULL),
+                           SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                           fs,
+                           no_handler,
+                           fs->pool, pool));
+    }
+  else
+    {
+      ffd->lock_cache = NULL;
+    }
+
   /* if enabled, cache text deltas and their combinations */
   if (cache_txdeltas)
     {
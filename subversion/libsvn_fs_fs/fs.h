@@ -69,6 +69,7 @@ extern "C" {
                                                     has not been packed. */
 #define PATH_REVPROP_GENERATION "revprop-generation"
                                                  /* Current revprop generation*/
+#define PATH_LOCK_GENERATION  "lock-generation"  /* Current lock generation */
 #define PATH_MANIFEST         "manifest"         /* Manifest file name */
 #define PATH_PACKED           "pack"             /* Packed revision data file */
 #define PATH_EXT_PACKED_SHARD ".pack"            /* Extension for packed
@@ -265,6 +266,13 @@ typedef struct fs_fs_shared_data_t
 /* Data structure for the 1st level DAG node cache. */
 typedef struct fs_fs_dag_cache_t fs_fs_dag_cache_t;
 
+/* In-memory filter of the SHA1 keys in the rep-cache database. */
+typedef struct fs_fs_rep_cache_filter_t fs_fs_rep_cache_filter_t;
+
+/* Number of directories too large for the dir cache that each svn_fs_t
+   keeps around. */
+#define SVN_FS_FS__LARGE_DIR_SLOTS 4
+
 /* Key type for all caches that use revision + offset / counter as key.
 
    Note: Cache keys should be 16 bytes for best performance and there
@@ -348,6 +356,22 @@ typedef struct fs_fs_data_t
      names to (svn_fs_dirent_t *). */
   svn_cache__t *dir_cache;
 
+  /* TRUE if DIR_CACHE is a membuffer cache.  Those drop entries that
+     are too large for them, so we check the size of directories before
+     caching them. */
+  svn_boolean_t dir_cache_size_limited;
+
+  /* The committed directories most recently read that were too large for
+     DIR_CACHE, identified by the (revision, item index) of their data
+     reps.  Keeping them around saves us from re-reading huge directories
+     for every entry lookup.  LARGE_DIRS[i] is NULL for unused slots and
+     otherwise allocated in LARGE_DIR_POOLS[i], a sub-pool of the FS pool.
+     LARGE_DIR_NEXT is the slot to be replaced next. */
+  pair_cache_key_t large_dir_keys[SVN_FS_FS__LARGE_DIR_SLOTS];
+  apr_array_header_t *large_dirs[SVN_FS_FS__LARGE_DIR_SLOTS];
+  apr_pool_t *large_dir_pools[SVN_FS_FS__LARGE_DIR_SLOTS];
+  int large_dir_next;
+
   /* Fulltext cache; currently only used with memcached.  Maps from
      rep key (revision/offset) to svn_stringbuf_t. */
   svn_cache__t *fulltext_cache;
@@ -364,9 +388,26 @@ typedef struct fs_fs_data_t
      the first access. */
   svn_named_atomic__t *revprop_timeout;
 
-  /* Revision property cache.  Maps from (rev,generation) to apr_hash_t. */
+  /* Access objects to the revprop change log, i.e. pairs of generation
+     and revision atomics.  Will be NULL until the first access. */
+  svn_named_atomic__t **revprop_change_log;
+
+  /* Revision property cache.  Maps from svn_revnum_t to
+     svn_fs_fs__revprops_cache_entry_t. */
   svn_cache__t *revprop_cache;
 
+  /* Access object to the atomics namespace used by lock caching.
+     Will be NULL until the first access. */
+  svn_atomic_namespace__t *lock_namespace;
+
+  /* Access object to the lock "generation". Will be NULL until
+     the first access. */
+  svn_named_atomic__t *lock_generation;
+
+  /* Lock digest file cache.  Maps from "generation/digest" to the
+     apr_hash_t of svn_string_t found in that digest file. */
+  svn_cache__t *lock_cache;
+
   /* Node properties cache.  Maps from rep key to apr_hash_t. */
   svn_cache__t *properties_cache;
 
@@ -407,6 +448,11 @@ typedef struct fs_fs_data_t
      if the node has mergeinfo, "0" if it doesn't. */
   svn_cache__t *mergeinfo_existence_cache;
 
+  /* Cache for the unparsed mergeinfo of all descendants of a directory,
+     i.e. apr_hash_t mapping relpaths to svn_string_t; the key is the
+     unparsed node-revision ID of that directory. */
+  svn_cache__t *descendant_mergeinfo_cache;
+
   /* Cache for l2p_header_t objects; the key is (revision, is-packed).
      Will be NULL for pre-format7 repos */
   svn_cache__t *l2p_header_cache;
@@ -443,6 +489,21 @@ typedef struct fs_fs_data_t
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
+  /* Bloom filter over the rep-cache keys, used to skip lookups of
+     representations that are definitely not in the rep-cache DB.
+     NULL until enough lookups have been made through this object.
+     Its size is bounded by a share of the configured cache size and
+     by 32MB; see rep-cache.c. */
+  fs_fs_rep_cache_filter_t *rep_cache_filter;
+
+  /* Number of rep-cache lookups made while there was no filter. */
+  int rep_cache_lookups;
+
+  /* Number of lookups after which to build the filter, based on the size
+     of the rep-cache.  0 if not determined yet, negative if the rep-cache
+     is too large to be filtered. */
+  apr_int64_t rep_cache_filter_threshold;
+
   /* The oldest revision not in a pack file.  It also applies to revprops
    * if revprop packing has been enabled by the FSFS format version. */
   svn_revnum_t min_unpacked_rev;
@@ -26,6 +26,7 @@
 #include "fs_fs.h"
 #include "hotcopy.h"
 #include "util.h"
+#include "lock.h"
 #include "recovery.h"
 #include "revprops.h"
 #include "rep-cache.h"
@@ -940,6 +941,15 @@ hotcopy_body(void *baton, apr_pool_t *pool)
 
   SVN_ERR(svn_fs_fs__cleanup_revprop_namespace(dst_fs));
 
+  /* Same for the lock generation.  The locks tree has been replaced
+   * above without going through the lock cache invalidation. */
+  SVN_ERR(svn_io_check_path(svn_fs_fs__path_lock_generation(src_fs, pool),
+                            &kind, pool));
+  if (kind == svn_node_file)
+    SVN_ERR(svn_fs_fs__write_lock_generation_file(dst_fs, 0, pool));
+
+  SVN_ERR(svn_fs_fs__cleanup_lock_namespace(dst_fs));
+
   return SVN_NO_ERROR;
 }
 
@@ -42,6 +42,7 @@
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_string_private.h"
 #include "svn_private_config.h"
 
 /* Names of hash keys used to store a lock for writing to disk. */
@@ -237,42 +238,28 @@ write_digest_file(apr_hash_t *children,
 }
 
 
-/* Parse the file at DIGEST_PATH, populating the lock LOCK_P in that
-   file (if it exists, and if *LOCK_P is non-NULL) and the hash of
-   CHILDREN_P (if any exist, and if *CHILDREN_P is non-NULL).  Use POOL
-   for all allocations.  */
+/* Read the file at DIGEST_PATH into *HASH_P, a hash of svn_string_t
+   values.  If that file does not exist, set *HASH_P to an empty hash.
+   Use POOL for all allocations.  */
 static svn_error_t *
-read_digest_file(apr_hash_t **children_p,
-                 svn_lock_t **lock_p,
-                 const char *fs_path,
+read_digest_hash(apr_hash_t **hash_p,
                  const char *digest_path,
                  apr_pool_t *pool)
 {
   svn_error_t *err = SVN_NO_ERROR;
-  svn_lock_t *lock;
-  apr_hash_t *hash;
   svn_stream_t *stream;
-  const char *val;
-  svn_node_kind_t kind;
 
-  if (lock_p)
-    *lock_p = NULL;
-  if (children_p)
-    *children_p = apr_hash_make(pool);
-
-  SVN_ERR(svn_io_check_path(digest_path, &kind, pool));
-  if (kind == svn_node_none)
-    return SVN_NO_ERROR;
+  *hash_p = apr_hash_make(pool);
 
-  /* If our caller doesn't care about anything but the presence of the
-     file... whatever. */
-  if (kind == svn_node_file && !lock_p && !children_p)
-    return SVN_NO_ERROR;
-
-  SVN_ERR(svn_stream_open_readonly(&stream, digest_path, pool, pool));
+  err = svn_stream_open_readonly(&stream, digest_path, pool, pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
 
-  hash = apr_hash_make(pool);
-  if ((err = svn_hash_read2(hash, stream, SVN_HASH_TERMINATOR, pool)))
+  if ((err = svn_hash_read2(*hash_p, stream, SVN_HASH_TERMINATOR, pool)))
     {
       svn_error_clear(svn_stream_close(stream));
       return svn_error_createf(err->apr_err,
@@ -280,7 +267,29 @@ read_digest_file(apr_hash_t **children_p,
                                _("Can't parse lock/entries hashfile '%s'"),
                                svn_dirent_local_style(digest_path, pool));
     }
-  SVN_ERR(svn_stream_close(stream));
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+/* Populate the lock LOCK_P (if there is one, and if *LOCK_P is non-NULL)
+   and the hash of CHILDREN_P (if any exist, and if *CHILDREN_P is
+   non-NULL) from HASH, the contents of a digest file in the repository
+   at FS_PATH as returned by read_digest_hash().  Use POOL for all
+   allocations.  */
+static svn_error_t *
+parse_digest_hash(apr_hash_t **children_p,
+                  svn_lock_t **lock_p,
+                  apr_hash_t *hash,
+                  const char *fs_path,
+                  apr_pool_t *pool)
+{
+  svn_lock_t *lock;
+  const char *val;
+
+  if (lock_p)
+    *lock_p = NULL;
+  if (children_p)
+    *children_p = apr_hash_make(pool);
 
   /* If our caller cares, see if we have a lock path in our hash. If
      so, we'll assume we have a lock here. */
@@ -331,27 +340,332 @@ read_digest_file(apr_hash_t **children_p,
   return SVN_NO_ERROR;
 }
 
+/* Parse the file at DIGEST_PATH, populating the lock LOCK_P in that
+   file (if it exists, and if *LOCK_P is non-NULL) and the hash of
+   CHILDREN_P (if any exist, and if *CHILDREN_P is non-NULL).  Use POOL
+   for all allocations.  */
+static svn_error_t *
+read_digest_file(apr_hash_t **children_p,
+                 svn_lock_t **lock_p,
+                 const char *fs_path,
+                 const char *digest_path,
+                 apr_pool_t *pool)
+{
+  apr_hash_t *hash;
+
+  SVN_ERR(read_digest_hash(&hash, digest_path, pool));
+  return svn_error_trace(parse_digest_hash(children_p, lock_p, hash,
+                                           fs_path, pool));
+}
+
+
+
+/*** Lock caching ***/
+
+/*
+ * Reading digest files is the dominant cost of lock queries: listing
+ * the locks below a path walks one file per lock and per ancestor of a
+ * lock, and so does verifying the locks below a deleted or replaced
+ * directory at commit time.  Optionally, we keep the parsed contents of
+ * those files in FFD->LOCK_CACHE.
+ *
+ * The cache keys are (generation, digest) pairs.  Much like the revprop
+ * generation (see revprops.c), the lock generation is a named atomic
+ * shared by all processes on this machine and backed by a file in the
+ * repository for when the shared memory has been cleaned up.  It gets
+ * set to an odd value before the first digest file of a lock or unlock
+ * batch is touched and to the next even value once all of them have
+ * been written.  Readers bypass the cache while the generation is odd.
+ *
+ * All changes happen under the repository write lock.  A lock change
+ * that fails still sets the next even value.  If a writer gets killed,
+ * the generation remains odd and we simply don't use the cache until the
+ * next lock change.  Updating the generation is best-effort: if the
+ * shared memory is unavailable, no process can cache locks anyway.
+ */
+
+/* The following are names of atomics that will be used to communicate
+ * lock changes across all processes on this machine. */
+#define ATOMIC_LOCK_GENERATION "lock-generation"
+#define ATOMIC_LOCK_NAMESPACE  "lock-atomics"
+
+/* Read lock generation as stored on disk for repository FS. The result
+ * is returned in *CURRENT. Default to 2 if no such file is available.
+ */
+static svn_error_t *
+read_lock_generation_file(apr_int64_t *current,
+                          svn_fs_t *fs,
+                          apr_pool_t *pool)
+{
+  svn_error_t *err;
+  apr_file_t *file;
+  char buf[80];
+  apr_size_t len;
+  const char *path = svn_fs_fs__path_lock_generation(fs, pool);
+
+  err = svn_io_file_open(&file, path,
+                         APR_READ | APR_BUFFERED,
+                         APR_OS_DEFAULT, pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *current = 2;
+
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  len = sizeof(buf);
+  SVN_ERR(svn_io_read_length_line(file, buf, &len, pool));
+
+  /* Check that the first line contains only digits. */
+  SVN_ERR(svn_fs_fs__check_file_buffer_numeric(buf, 0, path,
+                                               "Lock Generation", pool));
+  SVN_ERR(svn_cstring_atoi64(current, buf));
+
+  return svn_io_file_close(file, pool);
+}
+
+svn_error_t *
+svn_fs_fs__write_lock_generation_file(svn_fs_t *fs,
+                                      apr_int64_t current,
+                                      apr_pool_t *pool)
+{
+  char buf[SVN_INT64_BUFFER_SIZE];
+  apr_size_t len = svn__i64toa(buf, current);
+  buf[len] = '\n';
+
+  SVN_ERR(svn_io_write_atomic(svn_fs_fs__path_lock_generation(fs, pool),
+                              buf, len + 1,
+                              NULL /* copy_perms */, pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__cleanup_lock_namespace(svn_fs_t *fs)
+{
+  const char *name = svn_dirent_join(fs->path,
+                                     ATOMIC_LOCK_NAMESPACE,
+                                     fs->pool);
+  return svn_error_trace(svn_atomic_namespace__cleanup(name, fs->pool));
+}
+
+/* Make sure the lock_generation member in FS is set and, if necessary,
+ * initialized with the latest value stored on disk.
+ */
+static svn_error_t *
+ensure_lock_generation(svn_fs_t *fs, apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->lock_namespace == NULL)
+    SVN_ERR(svn_atomic_namespace__create(&ffd->lock_namespace,
+                                         svn_dirent_join(fs->path,
+                                                         ATOMIC_LOCK_NAMESPACE,
+                                                         fs->pool),
+                                         fs->pool));
+
+  if (ffd->lock_generation == NULL)
+    {
+      apr_int64_t current;
+
+      SVN_ERR(svn_named_atomic__get(&ffd->lock_generation,
+                                    ffd->lock_namespace,
+                                    ATOMIC_LOCK_GENERATION,
+                                    TRUE));
+
+      /* If the generation is at 0, we just created a new namespace
+       * (it would be at least 2 otherwise). Read the latest generation
+       * from disk and if we are the first one to initialize the atomic
+       * (i.e. is still 0), set it to the value just gotten.
+       */
+      SVN_ERR(svn_named_atomic__read(&current, ffd->lock_generation));
+      if (current == 0)
+        {
+          SVN_ERR(read_lock_generation_file(&current, fs, pool));
+          SVN_ERR(svn_named_atomic__cmpxchg(NULL, current, 0,
+                                            ffd->lock_generation));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Test whether the lock cache and the necessary infrastructure are
+   available in FS.  Disable the lock cache for good if they are not. */
+static svn_boolean_t
+has_lock_cache(svn_fs_t *fs, apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err;
+
+  if (ffd->lock_cache == NULL)
+    return FALSE;
+
+  /* Without efficient named atomics, the cache would not pay off. */
+  if (!svn_named_atomic__is_efficient())
+    {
+      ffd->lock_cache = NULL;
+      return FALSE;
+    }
+
+  err = ensure_lock_generation(fs, pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      ffd->lock_cache = NULL;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Test whether FS can take part in announcing lock changes to other
+   processes.  That needs efficient named atomics (otherwise, no process
+   caches locks) and FS' lock generation. */
+static svn_boolean_t
+has_lock_generation(svn_fs_t *fs, apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err;
+
+  if (!svn_named_atomic__is_efficient())
+    return FALSE;
+
+  if (ffd->lock_generation)
+    return TRUE;
+
+  err = ensure_lock_generation(fs, pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Increment the lock generation in FS until it is odd, if ODD is set,
+   or even, otherwise.  Return the new value in *CURRENT. */
+static svn_error_t *
+bump_lock_generation(apr_int64_t *current,
+                     svn_fs_t *fs,
+                     svn_boolean_t odd)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  do
+    {
+      SVN_ERR(svn_named_atomic__add(current, 1, ffd->lock_generation));
+    }
+  while ((*current % 2 != 0) != odd);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set the lock generation in FS to the next odd number to indicate
+   that digest files are about to be modified.
+
+   This must happen even if FS itself does not cache locks: other
+   processes using the same repository may, and they must not continue
+   to use their cached data.  Failures are ignored. */
+static void
+begin_lock_change(svn_fs_t *fs, apr_pool_t *pool)
+{
+  apr_int64_t current;
+
+  if (has_lock_generation(fs, pool))
+    svn_error_clear(bump_lock_generation(&current, fs, TRUE));
+}
+
+/* Set the lock generation in FS to the next even number to indicate
+   that all digest file modifications have been completed, or given up,
+   and that readers must not use any data cached before.  Persist the new
+   value.  Like begin_lock_change(), this is independent of FS' own lock
+   cache and ignores failures. */
+static void
+end_lock_change(svn_fs_t *fs, apr_pool_t *pool)
+{
+  apr_int64_t current;
+  svn_error_t *err;
+
+  if (!has_lock_generation(fs, pool))
+    return;
+
+  err = bump_lock_generation(&current, fs, FALSE);
+
+  /* FS is currently in a "locked" state such that we can be sure
+   * to be the only ones to write that file. */
+  if (!err)
+    err = svn_fs_fs__write_lock_generation_file(fs, current, pool);
+
+  svn_error_clear(err);
+}
+
+/* Like read_digest_file() but for repository FS and served from the
+   lock cache, if possible.  Use POOL for all allocations. */
+static svn_error_t *
+read_cached_digest_file(apr_hash_t **children_p,
+                        svn_lock_t **lock_p,
+                        svn_fs_t *fs,
+                        const char *digest_path,
+                        apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_hash_t *hash = NULL;
+  const char *key = NULL;
+
+  if (has_lock_cache(fs, pool))
+    {
+      apr_int64_t generation;
+
+      SVN_ERR(svn_named_atomic__read(&generation, ffd->lock_generation));
+      if (generation % 2 == 0)
+        {
+          svn_boolean_t found;
+
+          key = apr_psprintf(pool, "%" APR_INT64_T_FMT "/%s", generation,
+                             svn_dirent_basename(digest_path, pool));
+          SVN_ERR(svn_cache__get((void **)&hash, &found, ffd->lock_cache,
+                                 key, pool));
+          if (!found)
+            hash = NULL;
+        }
+    }
+
+  if (hash == NULL)
+    {
+      SVN_ERR(read_digest_hash(&hash, digest_path, pool));
+      if (key)
+        SVN_ERR(svn_cache__set(ffd->lock_cache, key, hash, pool));
+    }
+
+  return svn_error_trace(parse_digest_hash(children_p, lock_p, hash,
+                                           fs->path, pool));
+}
+
+
 
-
 /*** Lock helper functions (path here are still FS paths, not on-disk
      schema-supporting paths) ***/
 
 
-/* Write LOCK in FS to the actual OS filesystem.
+/* Write LOCK in FS to the actual OS filesystem, using DIGEST as the
+   digest of LOCK->path.
 
    Use PERMS_REFERENCE for the permissions of any digest files.
  */
 static svn_error_t *
 set_lock(const char *fs_path,
          svn_lock_t *lock,
+         const char *digest,
          const char *perms_reference,
          apr_pool_t *pool)
 {
-  const char *digest_path;
+  const char *digest_path = digest_path_from_digest(fs_path, digest, pool);
   apr_hash_t *children;
 
-  SVN_ERR(digest_path_from_path(&digest_path, fs_path, lock->path, pool));
-
   /* We could get away without reading the file as children should
      always come back empty. */
   SVN_ERR(read_digest_file(&children, NULL, fs_path, digest_path, pool));
@@ -362,23 +676,25 @@ set_lock(const char *fs_path,
   return SVN_NO_ERROR;
 }
 
+/* Remove the lock file with digest DIGEST from FS. */
 static svn_error_t *
 delete_lock(const char *fs_path,
-            const char *path,
+            const char *digest,
             apr_pool_t *pool)
 {
-  const char *digest_path;
-
-  SVN_ERR(digest_path_from_path(&digest_path, fs_path, path, pool));
+  const char *digest_path = digest_path_from_digest(fs_path, digest, pool);
 
   SVN_ERR(svn_io_remove_file2(digest_path, TRUE, pool));
 
   return SVN_NO_ERROR;
 }
 
+/* Add the lock files with the digests in DIGESTS to the entries file of
+   INDEX_PATH in FS, writing that file only once and only if that changes
+   it.  Use PERMS_REFERENCE for the permissions of the entries file.  */
 static svn_error_t *
 add_to_digest(const char *fs_path,
-              apr_array_header_t *paths,
+              apr_array_header_t *digests,
               const char *index_path,
               const char *perms_reference,
               apr_pool_t *pool)
@@ -394,15 +710,9 @@ add_to_digest(const char *fs_path,
 
   original_count = apr_hash_count(children);
 
-  for (i = 0; i < paths->nelts; ++i)
-    {
-      const char *path = APR_ARRAY_IDX(paths, i, const char *);
-      const char *digest_path, *digest_file;
-
-      SVN_ERR(digest_path_from_path(&digest_path, fs_path, path, pool));
-      digest_file = svn_dirent_basename(digest_path, NULL);
-      svn_hash_sets(children, digest_file, (void *)1);
-    }
+  for (i = 0; i < digests->nelts; ++i)
+    svn_hash_sets(children, APR_ARRAY_IDX(digests, i, const char *),
+                  (void *)1);
 
   if (apr_hash_count(children) != original_count)
     SVN_ERR(write_digest_file(children, lock, fs_path, index_digest_path, 
@@ -411,9 +721,12 @@ add_to_digest(const char *fs_path,
   return SVN_NO_ERROR;
 }
 
+/* Remove the lock files with the digests in DIGESTS from the entries
+   file of INDEX_PATH in FS, writing (or removing) that file only once.
+   Use PERMS_REFERENCE for the permissions of the entries file.  */
 static svn_error_t *
 delete_from_digest(const char *fs_path,
-                   apr_array_header_t *paths,
+                   apr_array_header_t *digests,
                    const char *index_path,
                    const char *perms_reference,
                    apr_pool_t *pool)
@@ -427,15 +740,8 @@ delete_from_digest(const char *fs_path,
 
   SVN_ERR(read_digest_file(&children, &lock, fs_path, index_digest_path, pool));
 
-  for (i = 0; i < paths->nelts; ++i)
-    {
-      const char *path = APR_ARRAY_IDX(paths, i, const char *);
-      const char *digest_path, *digest_file;
-
-      SVN_ERR(digest_path_from_path(&digest_path, fs_path, path, pool));
-      digest_file = svn_dirent_basename(digest_path, NULL);
-      svn_hash_sets(children, digest_file, NULL);
-    }
+  for (i = 0; i < digests->nelts; ++i)
+    svn_hash_sets(children, APR_ARRAY_IDX(digests, i, const char *), NULL);
 
   if (apr_hash_count(children) || lock)
     SVN_ERR(write_digest_file(children, lock, fs_path, index_digest_path, 
@@ -467,14 +773,11 @@ get_lock(svn_lock_t **lock_p,
 {
   svn_lock_t *lock = NULL;
   const char *digest_path;
-  svn_node_kind_t kind;
 
   SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
-  SVN_ERR(svn_io_check_path(digest_path, &kind, pool));
 
   *lock_p = NULL;
-  if (kind != svn_node_none)
-    SVN_ERR(read_digest_file(NULL, &lock, fs->path, digest_path, pool));
+  SVN_ERR(read_cached_digest_file(NULL, &lock, fs, digest_path, pool));
 
   if (! lock)
     return must_exist ? SVN_FS__ERR_NO_SUCH_LOCK(fs, path) : SVN_NO_ERROR;
@@ -584,7 +887,7 @@ typedef svn_error_t *(*walk_digests_callback_t)(void *baton,
    HAVE_WRITE_LOCK should be true if the caller (directly or indirectly)
    has the FS write lock. */
 static svn_error_t *
-walk_digest_files(const char *fs_path,
+walk_digest_files(svn_fs_t *fs,
                   const char *digest_path,
                   walk_digests_callback_t walk_digests_func,
                   void *walk_digests_baton,
@@ -597,9 +900,9 @@ walk_digest_files(const char *fs_path,
   svn_lock_t *lock;
 
   /* First, send up any locks in the current digest file. */
-  SVN_ERR(read_digest_file(&children, &lock, fs_path, digest_path, pool));
+  SVN_ERR(read_cached_digest_file(&children, &lock, fs, digest_path, pool));
 
-  SVN_ERR(walk_digests_func(walk_digests_baton, fs_path, digest_path,
+  SVN_ERR(walk_digests_func(walk_digests_baton, fs->path, digest_path,
                             children, lock,
                             have_write_lock, pool));
 
@@ -612,7 +915,7 @@ walk_digest_files(const char *fs_path,
       const char *digest = svn__apr_hash_index_key(hi);
       svn_pool_clear(subpool);
       SVN_ERR(walk_digest_files
-              (fs_path, digest_path_from_digest(fs_path, digest, subpool),
+              (fs, digest_path_from_digest(fs->path, digest, subpool),
                walk_digests_func, walk_digests_baton, have_write_lock, subpool));
     }
   svn_pool_destroy(subpool);
@@ -636,7 +939,7 @@ walk_locks(svn_fs_t *fs,
   wlb.get_locks_func = get_locks_func;
   wlb.get_locks_baton = get_locks_baton;
   wlb.fs = fs;
-  SVN_ERR(walk_digest_files(fs->path, digest_path, locks_walker, &wlb,
+  SVN_ERR(walk_digest_files(fs, digest_path, locks_walker, &wlb,
                             have_write_lock, pool));
   return SVN_NO_ERROR;
 }
@@ -827,61 +1130,28 @@ check_lock(svn_error_t **fs_err,
 
 struct lock_info_t {
   const char *path;
+  /* The digest of PATH, identifying its lock file */
+  const char *digest;
   const char *component;
   svn_lock_t *lock;
   svn_error_t *fs_err;
 };
 
-/* The body of svn_fs_fs__lock(), which see.
-
-   BATON is a 'struct lock_baton *' holding the effective arguments.
-   BATON->targets is an array of 'svn_sort__item_t' targets, sorted by
-   path, mapping canonical path to 'svn_fs_lock_target_t'.  Set
-   BATON->infos to an array of 'lock_info_t' holding the results.  For
-   the other arguments, see svn_fs_lock_many().
+/* Write the locks for all entries in LB->infos without an error
+   and the digest file indexes leading to them.  OUTSTANDING is the
+   number of those entries.  REV_0_PATH is passed to set_lock() and
+   add_to_digest().  Use SCRATCH_POOL for temporary allocations.
 
-   This implements the svn_fs_fs__with_write_lock() 'body' callback
-   type, and assumes that the write lock is held.
+   This assumes that the write lock is held.
  */
 static svn_error_t *
-lock_body(void *baton, apr_pool_t *pool)
+write_locks(struct lock_baton *lb,
+            int outstanding,
+            const char *rev_0_path,
+            apr_pool_t *scratch_pool)
 {
-  struct lock_baton *lb = baton;
-  svn_fs_root_t *root;
-  svn_revnum_t youngest;
-  const char *rev_0_path;
-  int i, outstanding = 0;
-  apr_pool_t *iterpool = svn_pool_create(pool);
-
-  lb->infos = apr_array_make(lb->result_pool, lb->targets->nelts,
-                             sizeof(struct lock_info_t));
-
-  /* Until we implement directory locks someday, we only allow locks
-     on files or non-existent paths. */
-  /* Use fs->vtable->foo instead of svn_fs_foo to avoid circular
-     library dependencies, which are not portable. */
-  SVN_ERR(lb->fs->vtable->youngest_rev(&youngest, lb->fs, pool));
-  SVN_ERR(lb->fs->vtable->revision_root(&root, lb->fs, youngest, pool));
-
-  for (i = 0; i < lb->targets->nelts; ++i)
-    {
-      const svn_sort__item_t *item = &APR_ARRAY_IDX(lb->targets, i,
-                                                    svn_sort__item_t);
-      const svn_fs_lock_target_t *target = item->value;
-      struct lock_info_t info;
-
-      svn_pool_clear(iterpool);
-
-      info.path = item->key;
-      SVN_ERR(check_lock(&info.fs_err, info.path, target, lb, root, iterpool));
-      info.lock = NULL;
-      info.component = NULL;
-      APR_ARRAY_PUSH(lb->infos, struct lock_info_t) = info;
-      if (!info.fs_err)
-        ++outstanding;
-    }
-
-  rev_0_path = svn_fs_fs__path_rev_absolute(lb->fs, 0, pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
 
   /* Given the paths:
 
@@ -903,7 +1173,6 @@ lock_body(void *baton, apr_pool_t *pool)
      index is inconsistent, svn_fs_fs__allow_locked_operation will
      show locked on the file but unlocked on the parent. */
 
-    
   while (outstanding)
     {
       const char *last_path = NULL;
@@ -925,7 +1194,7 @@ lock_body(void *baton, apr_pool_t *pool)
               if (!info->component)
                 {
                   info->component = info->path;
-                  APR_ARRAY_PUSH(paths, const char *) = info->path;
+                  APR_ARRAY_PUSH(paths, const char *) = info->digest;
                   last_path = "/";
                 }
               else
@@ -958,7 +1227,8 @@ lock_body(void *baton, apr_pool_t *pool)
                       info->lock->expiration_date = lb->expiration_date;
 
                       info->fs_err = set_lock(lb->fs->path, info->lock,
-                                              rev_0_path, iterpool);
+                                              info->digest, rev_0_path,
+                                              iterpool);
                       --outstanding;
                     }
                   else
@@ -976,7 +1246,7 @@ lock_body(void *baton, apr_pool_t *pool)
                           apr_array_clear(paths);
                           last_path = NULL;
                         }
-                      APR_ARRAY_PUSH(paths, const char *) = info->path;
+                      APR_ARRAY_PUSH(paths, const char *) = info->digest;
                       if (!last_path)
                         last_path = apr_pstrndup(iterpool, info->path, len);
                     }
@@ -988,7 +1258,76 @@ lock_body(void *baton, apr_pool_t *pool)
                                   rev_0_path, iterpool));
         }
     }
-      
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* The body of svn_fs_fs__lock(), which see.
+
+   BATON is a 'struct lock_baton *' holding the effective arguments.
+   BATON->targets is an array of 'svn_sort__item_t' targets, sorted by
+   path, mapping canonical path to 'svn_fs_lock_target_t'.  Set
+   BATON->infos to an array of 'lock_info_t' holding the results.  For
+   the other arguments, see svn_fs_lock_many().
+
+   This implements the svn_fs_fs__with_write_lock() 'body' callback
+   type, and assumes that the write lock is held.
+ */
+static svn_error_t *
+lock_body(void *baton, apr_pool_t *pool)
+{
+  struct lock_baton *lb = baton;
+  svn_fs_root_t *root;
+  svn_revnum_t youngest;
+  const char *rev_0_path;
+  int i, outstanding = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  lb->infos = apr_array_make(lb->result_pool, lb->targets->nelts,
+                             sizeof(struct lock_info_t));
+
+  /* Until we implement directory locks someday, we only allow locks
+     on files or non-existent paths. */
+  /* Use fs->vtable->foo instead of svn_fs_foo to avoid circular
+     library dependencies, which are not portable. */
+  SVN_ERR(lb->fs->vtable->youngest_rev(&youngest, lb->fs, pool));
+  SVN_ERR(lb->fs->vtable->revision_root(&root, lb->fs, youngest, pool));
+
+  for (i = 0; i < lb->targets->nelts; ++i)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(lb->targets, i,
+                                                    svn_sort__item_t);
+      const svn_fs_lock_target_t *target = item->value;
+      struct lock_info_t info;
+
+      svn_pool_clear(iterpool);
+
+      info.path = item->key;
+      SVN_ERR(check_lock(&info.fs_err, info.path, target, lb, root, iterpool));
+      info.lock = NULL;
+      info.component = NULL;
+      info.digest = NULL;
+      if (!info.fs_err)
+        SVN_ERR(make_digest(&info.digest, info.path, pool));
+      APR_ARRAY_PUSH(lb->infos, struct lock_info_t) = info;
+      if (!info.fs_err)
+        ++outstanding;
+    }
+
+  rev_0_path = svn_fs_fs__path_rev_absolute(lb->fs, 0, pool);
+
+  if (outstanding)
+    {
+      svn_error_t *err;
+
+      begin_lock_change(lb->fs, pool);
+      err = write_locks(lb, outstanding, rev_0_path, pool);
+      end_lock_change(lb->fs, pool);
+      SVN_ERR(err);
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -1029,12 +1368,96 @@ check_unlock(svn_error_t **fs_err,
 
 struct unlock_info_t {
   const char *path;
+  /* The digest of PATH, identifying its lock file */
+  const char *digest;
   const char *component;
   svn_error_t *fs_err;
   svn_boolean_t done;
   int components;
 };
 
+/* Delete the locks for all entries in UB->infos without an error and
+   remove them from the digest file indexes leading to them.
+   MAX_COMPONENTS is the largest number of path components among those
+   entries.  REV_0_PATH is passed to delete_from_digest().  Use
+   SCRATCH_POOL for temporary allocations.
+
+   This assumes that the write lock is held.
+ */
+static svn_error_t *
+delete_locks(struct unlock_baton *ub,
+             int max_components,
+             const char *rev_0_path,
+             apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = max_components; i >= 0; --i)
+    {
+      const char *last_path = NULL;
+      apr_array_header_t *paths;
+      int j;
+
+      svn_pool_clear(iterpool);
+      paths = apr_array_make(scratch_pool, 1, sizeof(const char *));
+
+      for (j = 0; j < ub->infos->nelts; ++j)
+        {
+          struct unlock_info_t *info = &APR_ARRAY_IDX(ub->infos, j,
+                                                      struct unlock_info_t);
+
+          if (!info->fs_err && info->path)
+            {
+
+              if (info->components == i)
+                {
+                  SVN_ERR(delete_lock(ub->fs->path, info->digest, iterpool));
+                  info->done = TRUE;
+                }
+              else if (info->components > i)
+                {
+                  apr_size_t len = info->component - info->path;
+
+                  if (last_path
+                      && strcmp(last_path, "/")
+                      && (strncmp(last_path, info->path, len)
+                          || strlen(last_path) != len))
+                    {
+                      SVN_ERR(delete_from_digest(ub->fs->path, paths, last_path,
+                                                 rev_0_path, iterpool));
+                      apr_array_clear(paths);
+                      last_path = NULL;
+                    }
+                  APR_ARRAY_PUSH(paths, const char *) = info->digest;
+                  if (!last_path)
+                    {
+                      if (info->component > info->path)
+                        last_path = apr_pstrndup(scratch_pool, info->path, len);
+                      else
+                        last_path = "/";
+                    }
+
+                  if (info->component > info->path)
+                    {
+                      --info->component;
+                      while(info->component[0] != '/')
+                        --info->component;
+                    }
+                }
+            }
+
+          if (last_path && j == ub->infos->nelts - 1)
+            SVN_ERR(delete_from_digest(ub->fs->path, paths, last_path,
+                                       rev_0_path, iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The body of svn_fs_fs__unlock(), which see.
 
    BATON is a 'struct unlock_baton *' holding the effective arguments.
@@ -1055,6 +1478,7 @@ unlock_body(void *baton, apr_pool_t *pool)
   const char *rev_0_path;
   int i, max_components = 0, outstanding = 0;
   apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_error_t *err;
 
   ub->infos = apr_array_make(ub->result_pool, ub->targets->nelts,
                              sizeof(struct unlock_info_t));
@@ -1079,6 +1503,8 @@ unlock_body(void *baton, apr_pool_t *pool)
         {
           const char *s;
 
+          SVN_ERR(make_digest(&info.digest, info.path, pool));
+
           info.components = 1;
           info.component = info.path;
           while((s = strchr(info.component + 1, '/')))
@@ -1097,67 +1523,14 @@ unlock_body(void *baton, apr_pool_t *pool)
 
   rev_0_path = svn_fs_fs__path_rev_absolute(ub->fs, 0, pool);
 
-  for (i = max_components; i >= 0; --i)
-    {
-      const char *last_path = NULL;
-      apr_array_header_t *paths;
-      int j;
-
-      svn_pool_clear(iterpool);
-      paths = apr_array_make(pool, 1, sizeof(const char *));
-
-      for (j = 0; j < ub->infos->nelts; ++j)
-        {
-          struct unlock_info_t *info = &APR_ARRAY_IDX(ub->infos, j,
-                                                      struct unlock_info_t);
-
-          if (!info->fs_err && info->path)
-            {
-
-              if (info->components == i)
-                {
-                  SVN_ERR(delete_lock(ub->fs->path, info->path, iterpool));
-                  info->done = TRUE;
-                }
-              else if (info->components > i)
-                {
-                  apr_size_t len = info->component - info->path;
-
-                  if (last_path
-                      && strcmp(last_path, "/")
-                      && (strncmp(last_path, info->path, len)
-                          || strlen(last_path) != len))
-                    {
-                      SVN_ERR(delete_from_digest(ub->fs->path, paths, last_path,
-                                                 rev_0_path, iterpool));
-                      apr_array_clear(paths);
-                      last_path = NULL;
-                    }
-                  APR_ARRAY_PUSH(paths, const char *) = info->path;
-                  if (!last_path)
-                    {
-                      if (info->component > info->path)
-                        last_path = apr_pstrndup(pool, info->path, len);
-                      else
-                        last_path = "/";
-                    }
-
-                  if (info->component > info->path)
-                    {
-                      --info->component;
-                      while(info->component[0] != '/')
-                        --info->component;
-                    }
-                }
-            }
+  if (!outstanding)
+    return SVN_NO_ERROR;
 
-          if (last_path && j == ub->infos->nelts - 1)
-            SVN_ERR(delete_from_digest(ub->fs->path, paths, last_path,
-                                       rev_0_path, iterpool));
-        }
-    }
+  begin_lock_change(ub->fs, pool);
+  err = delete_locks(ub, max_components, rev_0_path, pool);
+  end_lock_change(ub->fs, pool);
 
-  return SVN_NO_ERROR;
+  return svn_error_trace(err);
 }
 
 /* Unlock the lock described by LOCK->path and LOCK->token in FS.
@@ -1441,6 +1814,19 @@ svn_fs_fs__get_locks(svn_fs_t *fs,
   SVN_ERR(svn_fs__check_fs(fs, TRUE));
   path = svn_fs__canonicalize_abspath(path, pool);
 
+  /* Only PATH itself can match: there is no need to read the locks on
+     its descendants. */
+  if (depth == svn_depth_empty)
+    {
+      svn_lock_t *lock;
+
+      SVN_ERR(get_lock_helper(fs, &lock, path, FALSE, pool));
+      if (lock)
+        SVN_ERR(get_locks_func(get_locks_baton, lock, pool));
+
+      return SVN_NO_ERROR;
+    }
+
   glfb.path = path;
   glfb.requested_depth = depth;
   glfb.get_locks_func = get_locks_func;
@@ -103,6 +103,18 @@ svn_error_t *svn_fs_fs__allow_locked_operation(const char *path,
                                                svn_boolean_t have_write_lock,
                                                apr_pool_t *pool);
 
+/* Write the CURRENT lock generation to disk for repository FS.
+ */
+svn_error_t *
+svn_fs_fs__write_lock_generation_file(svn_fs_t *fs,
+                                      apr_int64_t current,
+                                      apr_pool_t *pool);
+
+/* Remove the shared memory files backing the lock generation of
+ * repository FS. */
+svn_error_t *
+svn_fs_fs__cleanup_lock_namespace(svn_fs_t *fs);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
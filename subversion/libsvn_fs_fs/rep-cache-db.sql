@@ -43,6 +43,30 @@ WHERE hash = ?1
 INSERT OR FAIL INTO rep_cache (hash, revision, offset, size, expanded_size)
 VALUES (?1, ?2, ?3, ?4, ?5)
 
+/* Same as STMT_SET_REP but for 8 rows at once.  Existing rows are kept;
+   the caller checks them if fewer than 8 rows got inserted.
+   Keep in sync with REP_CACHE_BATCH_SIZE in rep-cache.c. */
+-- STMT_SET_REP_BATCH
+INSERT OR IGNORE INTO rep_cache (hash, revision, offset, size, expanded_size)
+VALUES (?1, ?2, ?3, ?4, ?5),
+       (?6, ?7, ?8, ?9, ?10),
+       (?11, ?12, ?13, ?14, ?15),
+       (?16, ?17, ?18, ?19, ?20),
+       (?21, ?22, ?23, ?24, ?25),
+       (?26, ?27, ?28, ?29, ?30),
+       (?31, ?32, ?33, ?34, ?35),
+       (?36, ?37, ?38, ?39, ?40)
+
+-- STMT_GET_MAX_ROWID
+SELECT MAX(_ROWID_)
+FROM rep_cache
+
+-- STMT_GET_HASHES_AFTER_ROWID
+SELECT hash, _ROWID_
+FROM rep_cache
+WHERE _ROWID_ > ?1
+ORDER BY _ROWID_
+
 -- STMT_GET_REPS_FOR_RANGE
 SELECT hash, revision, offset, size, expanded_size
 FROM rep_cache
@@ -21,6 +21,8 @@
  */
 
 #include "svn_pools.h"
+#include "svn_sorts.h"
+#include "svn_cache_config.h"
 
 #include "svn_private_config.h"
 
@@ -38,6 +40,36 @@
 /* A few magic values */
 #define REP_CACHE_SCHEMA_FORMAT   1
 
+/* Number of rows written by a single STMT_SET_REP_BATCH. */
+#define REP_CACHE_BATCH_SIZE      8
+
+/* Don't consider building the rep-cache filter before that many lookups
+   have been made through the same FS object.  Small commits are cheaper
+   without it. */
+#define REP_CACHE_FILTER_THRESHOLD 256
+
+/* Building the filter reads every row of the rep-cache while a lookup
+   only reads a few pages.  So for large rep-caches, only build it once
+   there has been at least one lookup per that many rows. */
+#define REP_CACHE_FILTER_ROWS_PER_LOOKUP 64
+
+/* Filter bits per rep-cache entry and bits to set per key.  This gives
+   a false positive rate of about 1%. */
+#define REP_CACHE_FILTER_BITS_PER_KEY 10
+#define REP_CACHE_FILTER_HASHES    7
+
+/* Minimum and maximum size of the filter in bits (8kB and 32MB).
+   Rep-caches too large for the effective maximum, see filter_max_bits(),
+   are not filtered at all. */
+#define REP_CACHE_FILTER_MIN_BITS  ((apr_uint64_t)1 << 16)
+#define REP_CACHE_FILTER_MAX_BITS  ((apr_uint64_t)1 << 28)
+
+/* Every svn_fs_t builds its own filter, and idle instances kept in a
+   repository pool (see svn_repos__pool_t) keep theirs.  So we limit each
+   filter to that fraction of the configured cache size (svn_cache_config_t).
+   With the default 16MB, that is 1MB per svn_fs_t. */
+#define REP_CACHE_FILTER_CACHE_SHARE 16
+
 REP_CACHE_DB_SQL_DECLARE_STATEMENTS(statements);
 
 
@@ -51,6 +83,291 @@ path_rep_cache_db(const char *fs_path,
 }
 
 
+/* A bloom filter over the SHA1 keys in the rep-cache DB.
+
+   Looking up a representation that is not in the rep-cache is the common
+   case for new content and costs an SQLite query each time.  The filter
+   lets us skip most of those queries.  It may report false positives,
+   in which case we simply query the DB.
+
+   A key missing from the filter while being in the DB only means that
+   a representation does not get shared.  That happens if other processes
+   added rows after we last read the DB.  To limit it, the rows added
+   since then are read whenever this FS object learns of a revision that
+   the filter does not cover yet.  Rows are never modified and only get
+   deleted by recovery, so the new rows are those with a larger rowid.
+ */
+struct fs_fs_rep_cache_filter_t
+{
+  /* The filter bits.  BIT_MASK + 1 of them, which is a power of 2. */
+  unsigned char *bits;
+  apr_uint32_t bit_mask;
+
+  /* All reps of this and older revisions are in the filter, except
+     where they were added to the DB after we last read from it. */
+  svn_revnum_t youngest;
+
+  /* All DB rows up to this rowid have been added to the filter. */
+  apr_int64_t last_rowid;
+
+  /* Number of DB rows added and the number of keys that the filter has
+     been sized for. */
+  apr_int64_t key_count;
+  apr_int64_t capacity;
+
+  /* Pool containing this filter. */
+  apr_pool_t *pool;
+};
+
+/* Set *H1 and *H2 to the base values of the filter hash functions for
+   the SHA1 DIGEST. */
+static void
+filter_hashes(apr_uint32_t *h1,
+              apr_uint32_t *h2,
+              const unsigned char *digest)
+{
+  /* SHA1 is a good hash function already, so just use its bits. */
+  *h1 = ((apr_uint32_t)digest[0] << 24) | ((apr_uint32_t)digest[1] << 16)
+      | ((apr_uint32_t)digest[2] << 8) | digest[3];
+  *h2 = ((apr_uint32_t)digest[4] << 24) | ((apr_uint32_t)digest[5] << 16)
+      | ((apr_uint32_t)digest[6] << 8) | digest[7] | 1;
+}
+
+/* Add the SHA1 DIGEST to FILTER. */
+static void
+filter_add(fs_fs_rep_cache_filter_t *filter,
+           const unsigned char *digest)
+{
+  apr_uint32_t h1, h2;
+  int i;
+
+  filter_hashes(&h1, &h2, digest);
+  for (i = 0; i < REP_CACHE_FILTER_HASHES; ++i, h1 += h2)
+    filter->bits[(h1 & filter->bit_mask) / 8] |= 1 << (h1 % 8);
+}
+
+/* Return TRUE if the SHA1 DIGEST may be in FILTER. */
+static svn_boolean_t
+filter_contains(fs_fs_rep_cache_filter_t *filter,
+                const unsigned char *digest)
+{
+  apr_uint32_t h1, h2;
+  int i;
+
+  filter_hashes(&h1, &h2, digest);
+  for (i = 0; i < REP_CACHE_FILTER_HASHES; ++i, h1 += h2)
+    if ((filter->bits[(h1 & filter->bit_mask) / 8] & (1 << (h1 % 8))) == 0)
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Drop the rep-cache filter of FS, if there is one. */
+static void
+drop_filter(svn_fs_t *fs)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->rep_cache_filter)
+    {
+      svn_pool_destroy(ffd->rep_cache_filter->pool);
+      ffd->rep_cache_filter = NULL;
+    }
+
+  ffd->rep_cache_lookups = 0;
+  ffd->rep_cache_filter_threshold = 0;
+}
+
+/* Set *COUNT to an estimate of the number of rows in the rep-cache DB of
+   FS.  Rows only get deleted by recovery, so the largest rowid is close
+   to the actual number and, unlike COUNT(*), cheap to get. */
+static svn_error_t *
+estimate_row_count(apr_int64_t *count,
+                   svn_fs_t *fs)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_MAX_ROWID));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  *count = svn_sqlite__column_int64(stmt, 0);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Add the keys of all rows in the rep-cache DB of FS with a rowid larger
+   than FILTER->LAST_ROWID to FILTER.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+filter_add_new_rows(fs_fs_rep_cache_filter_t *filter,
+                    svn_fs_t *fs,
+                    apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  int iterations = 0;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_HASHES_AFTER_ROWID));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, 1, filter->last_rowid));
+
+  err = svn_sqlite__step(&have_row, stmt);
+  while (!err && have_row)
+    {
+      svn_checksum_t *checksum;
+
+      if (iterations++ % 1024 == 0)
+        svn_pool_clear(iterpool);
+
+      err = svn_checksum_parse_hex(&checksum, svn_checksum_sha1,
+                                   svn_sqlite__column_text(stmt, 0, NULL),
+                                   iterpool);
+      if (err)
+        break;
+
+      if (checksum)
+        filter_add(filter, checksum->digest);
+
+      filter->last_rowid = svn_sqlite__column_int64(stmt, 1);
+      filter->key_count++;
+
+      err = svn_sqlite__step(&have_row, stmt);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_error_compose_create(err,
+                                                  svn_sqlite__reset(stmt)));
+}
+
+/* Return the maximum size of the filter in bits, a power of two.  0 if
+   the configured cache size is too small to have a filter. */
+static apr_uint64_t
+filter_max_bits(void)
+{
+  apr_uint64_t limit = svn_cache_config_get()->cache_size * 8
+                     / REP_CACHE_FILTER_CACHE_SHARE;
+  apr_uint64_t max_bits = REP_CACHE_FILTER_MAX_BITS;
+
+  while (max_bits > limit)
+    max_bits /= 2;
+
+  return max_bits < REP_CACHE_FILTER_MIN_BITS ? 0 : max_bits;
+}
+
+/* Read all keys from the rep-cache DB of FS, which has about ROW_COUNT
+   rows, into a new filter and set FS's rep_cache_filter to it.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+build_filter(svn_fs_t *fs,
+             apr_int64_t row_count,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter;
+  apr_uint64_t bit_count = REP_CACHE_FILTER_MIN_BITS;
+  apr_uint64_t max_bits = filter_max_bits();
+  apr_pool_t *pool;
+  svn_error_t *err;
+
+  /* Leave some room for the reps that we will add ourselves. */
+  while (   bit_count < (apr_uint64_t)(row_count + row_count / 4)
+                      * REP_CACHE_FILTER_BITS_PER_KEY
+         && bit_count < max_bits)
+    bit_count *= 2;
+
+  pool = svn_pool_create(fs->pool);
+  filter = apr_pcalloc(pool, sizeof(*filter));
+  filter->bits = apr_pcalloc(pool, (apr_size_t)(bit_count / 8));
+  filter->bit_mask = (apr_uint32_t)(bit_count - 1);
+  filter->youngest = ffd->youngest_rev_cache;
+  filter->last_rowid = 0;
+  filter->key_count = 0;
+  filter->capacity = (apr_int64_t)(bit_count / REP_CACHE_FILTER_BITS_PER_KEY);
+  filter->pool = pool;
+
+  err = filter_add_new_rows(filter, fs, scratch_pool);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  ffd->rep_cache_filter = filter;
+
+  return SVN_NO_ERROR;
+}
+
+/* Count another rep-cache lookup through FS and build the filter once
+   this has become worth it.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+maybe_build_filter(svn_fs_t *fs,
+                   apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_int64_t row_count;
+
+  if (++ffd->rep_cache_lookups <= REP_CACHE_FILTER_THRESHOLD)
+    return SVN_NO_ERROR;
+
+  /* A negative threshold means the rep-cache is too large to filter. */
+  if (ffd->rep_cache_filter_threshold == 0)
+    {
+      SVN_ERR(estimate_row_count(&row_count, fs));
+      apr_uint64_t max_bits = filter_max_bits();
+
+      if (   max_bits == 0
+          || (apr_uint64_t)row_count * REP_CACHE_FILTER_BITS_PER_KEY
+               > max_bits)
+        ffd->rep_cache_filter_threshold = -1;
+      else
+        ffd->rep_cache_filter_threshold
+          = MAX(REP_CACHE_FILTER_THRESHOLD,
+                row_count / REP_CACHE_FILTER_ROWS_PER_LOOKUP);
+    }
+
+  if (   ffd->rep_cache_filter_threshold < 0
+      || ffd->rep_cache_lookups <= ffd->rep_cache_filter_threshold)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(estimate_row_count(&row_count, fs));
+  return svn_error_trace(build_filter(fs, row_count, scratch_pool));
+}
+
+/* Make the rep-cache filter of FS cover all revisions that FS knows of,
+   by adding the rows that other processes added in the meantime.  Drop
+   the filter if that fails or if it got too full to be useful.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+update_filter(svn_fs_t *fs,
+              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_rep_cache_filter_t *filter = ffd->rep_cache_filter;
+  svn_revnum_t youngest = ffd->youngest_rev_cache;
+  svn_error_t *err;
+
+  err = filter_add_new_rows(filter, fs, scratch_pool);
+  if (err)
+    {
+      drop_filter(fs);
+      return svn_error_trace(err);
+    }
+
+  filter->youngest = youngest;
+
+  /* It will be rebuilt with a larger size, if still worth it. */
+  if (filter->key_count > filter->capacity)
+    drop_filter(fs);
+
+  return SVN_NO_ERROR;
+}
+
 /** Library-private API's. **/
 
 /* Body of svn_fs_fs__open_rep_cache().
@@ -257,6 +574,23 @@ svn_fs_fs__get_rep_reference(representation_t **rep,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
+  /* The filter is only valid as long as it contains the reps of all
+     revisions that we know of. */
+  if (   ffd->rep_cache_filter
+      && ffd->rep_cache_filter->youngest < ffd->youngest_rev_cache)
+    SVN_ERR(update_filter(fs, pool));
+
+  /* Large commits will look up many reps.  Filter out the misses. */
+  if (!ffd->rep_cache_filter)
+    SVN_ERR(maybe_build_filter(fs, pool));
+
+  if (   ffd->rep_cache_filter
+      && !filter_contains(ffd->rep_cache_filter, checksum->digest))
+    {
+      *rep = NULL;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_GET_REP));
   SVN_ERR(svn_sqlite__bindf(stmt, "s",
                             svn_checksum_to_cstring(checksum, pool)));
@@ -294,6 +628,34 @@ svn_fs_fs__get_rep_reference(representation_t **rep,
   return SVN_NO_ERROR;
 }
 
+/* Storing REP in the rep-cache of FS failed because there is a row for
+   its SHA1 already.  That's fine as long as that row is valid, so read it
+   back, which also checks that it refers to an existing revision. */
+static svn_error_t *
+verify_existing_rep(svn_fs_t *fs,
+                    const representation_t *rep,
+                    apr_pool_t *pool)
+{
+  representation_t *old_rep;
+  svn_checksum_t checksum;
+  checksum.kind = svn_checksum_sha1;
+  checksum.digest = rep->sha1_digest;
+
+  /* Constraint failed so the mapping for SHA1_CHECKSUM->REP
+     should exist.  If so that's cool -- just do nothing.  If not,
+     that's a red flag!  */
+  SVN_ERR(svn_fs_fs__get_rep_reference(&old_rep, fs, &checksum, pool));
+
+  if (!old_rep)
+    {
+      /* Something really odd at this point, we failed to insert the
+         checksum AND failed to read an existing checksum.  Do we need
+         to flag this? */
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                              representation_t *rep,
@@ -327,26 +689,101 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
   err = svn_sqlite__insert(NULL, stmt);
   if (err)
     {
-      representation_t *old_rep;
-
       if (err->apr_err != SVN_ERR_SQLITE_CONSTRAINT)
         return svn_error_trace(err);
 
       svn_error_clear(err);
+      SVN_ERR(verify_existing_rep(fs, rep, pool));
+    }
+
+  if (ffd->rep_cache_filter)
+    filter_add(ffd->rep_cache_filter, rep->sha1_digest);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              svn_revnum_t revision,
+                              apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i = 0;
+
+  SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
+  if (! ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
-      /* Constraint failed so the mapping for SHA1_CHECKSUM->REP
-         should exist.  If so that's cool -- just do nothing.  If not,
-         that's a red flag!  */
-      SVN_ERR(svn_fs_fs__get_rep_reference(&old_rep, fs, &checksum, pool));
+  /* Write full batches first. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_SET_REP_BATCH));
+  for (; i + REP_CACHE_BATCH_SIZE <= reps->nelts; i += REP_CACHE_BATCH_SIZE)
+    {
+      int k;
+      int affected_rows;
 
-      if (!old_rep)
+      svn_pool_clear(iterpool);
+
+      for (k = 0; k < REP_CACHE_BATCH_SIZE; ++k)
         {
-          /* Something really odd at this point, we failed to insert the
-             checksum AND failed to read an existing checksum.  Do we need
-             to flag this? */
+          representation_t *rep = APR_ARRAY_IDX(reps, i + k,
+                                                representation_t *);
+          int slot = 5 * k;
+          svn_checksum_t checksum;
+          checksum.kind = svn_checksum_sha1;
+          checksum.digest = rep->sha1_digest;
+
+          /* We only allow SHA1 checksums in this table. */
+          if (! rep->has_sha1)
+            return svn_error_create(SVN_ERR_BAD_CHECKSUM_KIND, NULL,
+                                    _("Only SHA1 checksums can be used as "
+                                      "keys in the rep_cache table.\n"));
+          SVN_ERR_ASSERT(rep->revision == revision);
+
+          SVN_ERR(svn_sqlite__bind_text(stmt, slot + 1,
+                                        svn_checksum_to_cstring(&checksum,
+                                                                iterpool)));
+          SVN_ERR(svn_sqlite__bind_revnum(stmt, slot + 2, rep->revision));
+          SVN_ERR(svn_sqlite__bind_int64(stmt, slot + 3, rep->item_index));
+          SVN_ERR(svn_sqlite__bind_int64(stmt, slot + 4, rep->size));
+          SVN_ERR(svn_sqlite__bind_int64(stmt, slot + 5,
+                                         rep->expanded_size));
+
+          if (ffd->rep_cache_filter)
+            filter_add(ffd->rep_cache_filter, rep->sha1_digest);
         }
+
+      SVN_ERR(svn_sqlite__update(&affected_rows, stmt));
+
+      /* Some rows existed already.  Check them like the single-row
+         INSERT OR FAIL path in svn_fs_fs__set_rep_reference() does. */
+      if (affected_rows < REP_CACHE_BATCH_SIZE)
+        for (k = 0; k < REP_CACHE_BATCH_SIZE; ++k)
+          SVN_ERR(verify_existing_rep(fs,
+                                      APR_ARRAY_IDX(reps, i + k,
+                                                    representation_t *),
+                                      iterpool));
+    }
+
+  /* Write the remainder one-by-one. */
+  for (; i < reps->nelts; ++i)
+    {
+      representation_t *rep = APR_ARRAY_IDX(reps, i, representation_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR_ASSERT(rep->revision == revision);
+      SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, iterpool));
     }
 
+  svn_pool_destroy(iterpool);
+
+  /* The filter contains the new reps already.  Its YOUNGEST is left
+     alone, so that the next lookup also reads the rows of REVISION and
+     any that other processes may have added before. */
+
   return SVN_NO_ERROR;
 }
 
@@ -368,6 +805,9 @@ svn_fs_fs__del_rep_reference(svn_fs_t *fs,
   SVN_ERR(svn_sqlite__bindf(stmt, "r", youngest));
   SVN_ERR(svn_sqlite__step_done(stmt));
 
+  /* New rows may now reuse the rowids of the deleted ones. */
+  drop_filter(fs);
+
   return SVN_NO_ERROR;
 }
 
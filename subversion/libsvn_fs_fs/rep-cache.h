@@ -79,6 +79,16 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                              representation_t *rep,
                              apr_pool_t *pool);
 
+/* Like svn_fs_fs__set_rep_reference() but for all representation_t *
+   in REPS at once.  All of them must belong to REVISION, which has just
+   been committed through FS.  The caller is expected to wrap this call
+   in an SQLite transaction.  Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              svn_revnum_t revision,
+                              apr_pool_t *pool);
+
 /* Delete from the cache all reps corresponding to revisions younger
    than YOUNGEST. */
 svn_error_t *
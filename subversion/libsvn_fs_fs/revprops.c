@@ -28,6 +28,7 @@
 
 #include "fs_fs.h"
 #include "revprops.h"
+#include "temp_serializer.h"
 #include "util.h"
 
 #include "private/svn_subr_private.h"
@@ -47,6 +48,15 @@
 #define ATOMIC_REVPROP_TIMEOUT    "rev-prop-timeout"
 #define ATOMIC_REVPROP_NAMESPACE  "rev-prop-atomics"
 
+/* Names of the atomics that make up the revprop change log (see below).
+ * The %d will be replaced by the slot index. */
+#define ATOMIC_REVPROP_CHANGE_GEN "rev-prop-change-gen-%d"
+#define ATOMIC_REVPROP_CHANGE_REV "rev-prop-change-rev-%d"
+
+/* Number of slots in the revprop change log, i.e. the number of recent
+ * revprop changes after which cached revprops can still be reused. */
+#define REVPROP_CHANGE_LOG_SIZE 64
+
 svn_error_t *
 svn_fs_fs__upgrade_pack_revprops(svn_fs_t *fs,
                                  svn_fs_upgrade_notify_t notify_func,
@@ -172,6 +182,14 @@ svn_fs_fs__upgrade_cleanup_pack_revprops(svn_fs_t *fs,
  * The overhead for the second and following accesses to revprops is
  * almost zero on most systems.
  *
+ * Bumping the generation invalidates the cached revprops of all
+ * revisions, although only one of them got changed.  Therefore, we also
+ * keep a short log of the most recent changes in a ring of named atomics.
+ * For even generation G, slot (G / 2) % REVPROP_CHANGE_LOG_SIZE records
+ * the revision changed when G was reached.  Cache entries remember the
+ * generation that they were read at and remain valid for as long as the
+ * change log shows that their revision has not been changed since.
+ *
  *
  * Tech aspects:
  * -------------
@@ -509,20 +527,119 @@ begin_revprop_change(svn_fs_t *fs, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set *GENERATION_P and *REVISION_P to the atomics of the revprop change
+   log slot for the even GENERATION in FS. */
+static svn_error_t *
+get_revprop_change_slot(svn_named_atomic__t **generation_p,
+                        svn_named_atomic__t **revision_p,
+                        svn_fs_t *fs,
+                        apr_int64_t generation)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  int slot = (int)((generation / 2) % REVPROP_CHANGE_LOG_SIZE);
+
+  SVN_ERR(ensure_revprop_namespace(fs));
+  if (ffd->revprop_change_log == NULL)
+    ffd->revprop_change_log
+      = apr_pcalloc(fs->pool, 2 * REVPROP_CHANGE_LOG_SIZE
+                                * sizeof(*ffd->revprop_change_log));
+
+  if (ffd->revprop_change_log[2 * slot] == NULL)
+    {
+      char name[SVN_NAMED_ATOMIC__MAX_NAME_LENGTH + 1];
+
+      apr_snprintf(name, sizeof(name), ATOMIC_REVPROP_CHANGE_GEN, slot);
+      SVN_ERR(svn_named_atomic__get(&ffd->revprop_change_log[2 * slot],
+                                    ffd->revprop_namespace, name, TRUE));
+      apr_snprintf(name, sizeof(name), ATOMIC_REVPROP_CHANGE_REV, slot);
+      SVN_ERR(svn_named_atomic__get(&ffd->revprop_change_log[2 * slot + 1],
+                                    ffd->revprop_namespace, name, TRUE));
+    }
+
+  *generation_p = ffd->revprop_change_log[2 * slot];
+  *revision_p = ffd->revprop_change_log[2 * slot + 1];
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *UNCHANGED to TRUE, if the revprops of REVISION in FS that were
+   read at revprop generation SINCE are still valid at the CURRENT
+   revprop generation.  Set it to FALSE if they were changed or if we
+   can't tell. */
+static svn_error_t *
+revprops_unchanged(svn_boolean_t *unchanged,
+                   svn_fs_t *fs,
+                   svn_revnum_t revision,
+                   apr_int64_t since,
+                   apr_int64_t current)
+{
+  apr_int64_t generation;
+
+  *unchanged = FALSE;
+
+  /* While a write is under way, we don't know what gets changed.
+   * Also, only the last few changes are being logged. */
+  if (   current % 2
+      || current < since
+      || current - since > 2 * REVPROP_CHANGE_LOG_SIZE)
+    return SVN_NO_ERROR;
+
+  /* Check all changes after SINCE.  If SINCE is odd, a write was in
+   * progress when the data got read.  That one must be checked, too. */
+  for (generation = since + 2 - (since % 2);
+       generation <= current;
+       generation += 2)
+    {
+      svn_named_atomic__t *slot_generation, *slot_revision;
+      apr_int64_t value;
+
+      SVN_ERR(get_revprop_change_slot(&slot_generation, &slot_revision,
+                                      fs, generation));
+
+      /* Has that slot been overwritten or is it being written? */
+      SVN_ERR(svn_named_atomic__read(&value, slot_generation));
+      if (value != generation)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_named_atomic__read(&value, slot_revision));
+      if (value == revision)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_named_atomic__read(&value, slot_generation));
+      if (value != generation)
+        return SVN_NO_ERROR;
+    }
+
+  *unchanged = TRUE;
+  return SVN_NO_ERROR;
+}
+
 /* Set the revprop generation to the next even number to indicate that
-   a) readers shall re-read revprops, and
+   a) readers shall re-read revprops of REVISION, and
    b) the write process has been completed (no recovery required)
    Use the access object in FS to set the shared mem value. */
 static svn_error_t *
-end_revprop_change(svn_fs_t *fs, apr_pool_t *pool)
+end_revprop_change(svn_fs_t *fs,
+                   svn_revnum_t revision,
+                   apr_pool_t *pool)
 {
   apr_int64_t current = 1;
   fs_fs_data_t *ffd = fs->fsap_data;
+  svn_named_atomic__t *slot_generation, *slot_revision;
+
+  /* Log the change before anybody may see the new generation.
+   * Invalidate the slot while we update it. */
+  SVN_ERR(ensure_revprop_generation(fs, pool));
+  SVN_ERR(svn_named_atomic__read(&current, ffd->revprop_generation));
+  SVN_ERR(get_revprop_change_slot(&slot_generation, &slot_revision, fs,
+                                  current + 1));
+  SVN_ERR(svn_named_atomic__write(NULL, -1, slot_generation));
+  SVN_ERR(svn_named_atomic__write(NULL, revision, slot_revision));
+  SVN_ERR(svn_named_atomic__write(NULL, current + 1, slot_generation));
 
   /* set the revprop generation to an even value to indicate
    * that a write has been completed
    */
-  SVN_ERR(ensure_revprop_generation(fs, pool));
   do
     {
       SVN_ERR(svn_named_atomic__add(&current,
@@ -615,11 +732,11 @@ parse_revprop(apr_hash_t **properties,
   if (has_revprop_cache(fs, pool))
     {
       fs_fs_data_t *ffd = fs->fsap_data;
-      pair_cache_key_t key = { 0 };
+      svn_fs_fs__revprops_cache_entry_t entry;
 
-      key.revision = revision;
-      key.second = generation;
-      SVN_ERR(svn_cache__set(ffd->revprop_cache, &key, *properties,
+      entry.properties = *properties;
+      entry.generation = generation;
+      SVN_ERR(svn_cache__set(ffd->revprop_cache, &revision, &entry,
                              scratch_pool));
     }
 
@@ -961,16 +1078,31 @@ svn_fs_fs__get_revision_proplist(apr_hash_t **proplist_p,
   if (has_revprop_cache(fs, pool))
     {
       svn_boolean_t is_cached;
-      pair_cache_key_t key = { 0 };
+      svn_fs_fs__revprops_cache_entry_t *entry;
 
       SVN_ERR(read_revprop_generation(&generation, fs, pool));
 
-      key.revision = rev;
-      key.second = generation;
-      SVN_ERR(svn_cache__get((void **) proplist_p, &is_cached,
-                             ffd->revprop_cache, &key, pool));
+      SVN_ERR(svn_cache__get((void **) &entry, &is_cached,
+                             ffd->revprop_cache, &rev, pool));
+      if (is_cached && entry->generation != generation)
+        {
+          /* Other revisions' revprops may have changed since. */
+          SVN_ERR(revprops_unchanged(&is_cached, fs, rev, entry->generation,
+                                     generation));
+
+          /* Update the entry to save us that check next time. */
+          if (is_cached)
+            {
+              entry->generation = generation;
+              SVN_ERR(svn_cache__set(ffd->revprop_cache, &rev, entry, pool));
+            }
+        }
+
       if (is_cached)
-        return SVN_NO_ERROR;
+        {
+          *proplist_p = entry->properties;
+          return SVN_NO_ERROR;
+        }
     }
 
   /* if REV had not been packed when we began, try reading it from the
@@ -1043,7 +1175,8 @@ write_non_packed_revprop(const char **final_path,
  * file at TMP_PATH to FINAL_PATH and give it the permissions from
  * PERMS_REFERENCE.
  *
- * If indicated in BUMP_GENERATION, increase FS' revprop generation.
+ * If indicated in BUMP_GENERATION, increase FS' revprop generation and
+ * log the change of REVISION.
  * Finally, delete all the temporary files given in FILES_TO_DELETE.
  * The latter may be NULL.
  *
@@ -1051,6 +1184,7 @@ write_non_packed_revprop(const char **final_path,
  */
 static svn_error_t *
 switch_to_new_revprop(svn_fs_t *fs,
+                      svn_revnum_t revision,
                       const char *final_path,
                       const char *tmp_path,
                       const char *perms_reference,
@@ -1068,7 +1202,7 @@ switch_to_new_revprop(svn_fs_t *fs,
 
   /* Indicate that the update (if relevant) has been completed. */
   if (bump_generation)
-    SVN_ERR(end_revprop_change(fs, pool));
+    SVN_ERR(end_revprop_change(fs, revision, pool));
 
   /* Clean up temporary files, if necessary. */
   if (files_to_delete)
@@ -1470,7 +1604,8 @@ svn_fs_fs__set_revision_proplist(svn_fs_t *fs,
   perms_reference = svn_fs_fs__path_rev_absolute(fs, rev, pool);
 
   /* Now, switch to the new revprop data. */
-  SVN_ERR(switch_to_new_revprop(fs, final_path, tmp_path, perms_reference,
+  SVN_ERR(switch_to_new_revprop(fs, rev, final_path, tmp_path,
+                                perms_reference,
                                 files_to_delete, bump_generation, pool));
 
   return SVN_NO_ERROR;
@@ -576,6 +576,71 @@ serialize_svn_string_array(svn_temp_serializer__context_t *context,
   svn_temp_serializer__pop(context);
 }
 
+/* Fill PROPERTIES with the contents of HASH.  Allocate the arrays in
+   POOL. */
+static void
+properties_from_hash(properties_data_t *properties,
+                     apr_hash_t *hash,
+                     apr_pool_t *pool)
+{
+  apr_hash_index_t *hi;
+  apr_size_t i;
+
+  /* create our auxiliary data structure */
+  properties->count = apr_hash_count(hash);
+  properties->keys = apr_palloc(pool, sizeof(const char*) * (properties->count + 1));
+  properties->values = apr_palloc(pool, sizeof(const char*) * properties->count);
+
+  /* populate it with the hash entries */
+  for (hi = apr_hash_first(pool, hash), i=0; hi; hi = apr_hash_next(hi), ++i)
+    {
+      properties->keys[i] = svn__apr_hash_index_key(hi);
+      properties->values[i] = svn__apr_hash_index_val(hi);
+    }
+
+  properties->keys[i] = "";
+}
+
+/* Serialize the arrays in PROPERTIES into CONTEXT.  PROPERTIES must be
+   the current structure in CONTEXT. */
+static void
+serialize_properties_data(svn_temp_serializer__context_t *context,
+                          properties_data_t *properties)
+{
+  serialize_cstring_array(context, &properties->keys, properties->count + 1);
+  serialize_svn_string_array(context, &properties->values, properties->count);
+}
+
+/* Return the de-serialized PROPERTIES as a hash allocated in POOL. */
+static apr_hash_t *
+properties_to_hash(properties_data_t *properties,
+                   apr_pool_t *pool)
+{
+  apr_hash_t *hash = svn_hash__make(pool);
+  size_t i;
+
+  /* de-serialize our auxiliary data structure */
+  svn_temp_deserializer__resolve(properties, (void**)&properties->keys);
+  svn_temp_deserializer__resolve(properties, (void**)&properties->values);
+
+  /* de-serialize each entry and put it into the hash */
+  for (i = 0; i < properties->count; ++i)
+    {
+      apr_size_t len = properties->keys[i+1] - properties->keys[i] - 1;
+      svn_temp_deserializer__resolve(properties->keys,
+                                     (void**)&properties->keys[i]);
+
+      deserialize_svn_string(properties->values,
+                             (svn_string_t **)&properties->values[i]);
+
+      apr_hash_set(hash,
+                   properties->keys[i], len,
+                   properties->values[i]);
+    }
+
+  return hash;
+}
+
 svn_error_t *
 svn_fs_fs__serialize_properties(void **data,
                                 apr_size_t *data_len,
@@ -585,21 +650,9 @@ svn_fs_fs__serialize_properties(void **data,
   apr_hash_t *hash = in;
   properties_data_t properties;
   svn_temp_serializer__context_t *context;
-  apr_hash_index_t *hi;
   svn_stringbuf_t *serialized;
-  apr_size_t i;
 
-  /* create our auxiliary data structure */
-  properties.count = apr_hash_count(hash);
-  properties.keys = apr_palloc(pool, sizeof(const char*) * (properties.count + 1));
-  properties.values = apr_palloc(pool, sizeof(const char*) * properties.count);
-
-  /* populate it with the hash entries */
-  for (hi = apr_hash_first(pool, hash), i=0; hi; hi = apr_hash_next(hi), ++i)
-    {
-      properties.keys[i] = svn__apr_hash_index_key(hi);
-      properties.values[i] = svn__apr_hash_index_val(hi);
-    }
+  properties_from_hash(&properties, hash, pool);
 
   /* serialize it */
   context = svn_temp_serializer__init(&properties,
@@ -607,9 +660,7 @@ svn_fs_fs__serialize_properties(void **data,
                                       properties.count * 100,
                                       pool);
 
-  properties.keys[i] = "";
-  serialize_cstring_array(context, &properties.keys, properties.count + 1);
-  serialize_svn_string_array(context, &properties.values, properties.count);
+  serialize_properties_data(context, &properties);
 
   /* return the serialized result */
   serialized = svn_temp_serializer__get(context);
@@ -626,31 +677,68 @@ svn_fs_fs__deserialize_properties(void **out,
                                   apr_size_t data_len,
                                   apr_pool_t *pool)
 {
-  apr_hash_t *hash = svn_hash__make(pool);
-  properties_data_t *properties = (properties_data_t *)data;
-  size_t i;
+  *out = properties_to_hash((properties_data_t *)data, pool);
 
-  /* de-serialize our auxiliary data structure */
-  svn_temp_deserializer__resolve(properties, (void**)&properties->keys);
-  svn_temp_deserializer__resolve(properties, (void**)&properties->values);
+  return SVN_NO_ERROR;
+}
 
-  /* de-serialize each entry and put it into the hash */
-  for (i = 0; i < properties->count; ++i)
-    {
-      apr_size_t len = properties->keys[i+1] - properties->keys[i] - 1;
-      svn_temp_deserializer__resolve(properties->keys,
-                                     (void**)&properties->keys[i]);
+/* Auxiliary structure representing a svn_fs_fs__revprops_cache_entry_t.
+   PROPERTIES must be the first member such that the serialized arrays
+   can be resolved relative to either structure.
+ */
+typedef struct revprops_data_t
+{
+  /* the revprops */
+  properties_data_t properties;
 
-      deserialize_svn_string(properties->values,
-                             (svn_string_t **)&properties->values[i]);
+  /* generation at which they were read */
+  apr_int64_t generation;
+} revprops_data_t;
 
-      apr_hash_set(hash,
-                   properties->keys[i], len,
-                   properties->values[i]);
-    }
+svn_error_t *
+svn_fs_fs__serialize_revprops(void **data,
+                              apr_size_t *data_len,
+                              void *in,
+                              apr_pool_t *pool)
+{
+  svn_fs_fs__revprops_cache_entry_t *entry = in;
+  revprops_data_t revprops;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
 
-  /* done */
-  *out = hash;
+  properties_from_hash(&revprops.properties, entry->properties, pool);
+  revprops.generation = entry->generation;
+
+  /* serialize it */
+  context = svn_temp_serializer__init(&revprops,
+                                      sizeof(revprops),
+                                      revprops.properties.count * 100,
+                                      pool);
+
+  serialize_properties_data(context, &revprops.properties);
+
+  /* return the serialized result */
+  serialized = svn_temp_serializer__get(context);
+
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__deserialize_revprops(void **out,
+                                void *data,
+                                apr_size_t data_len,
+                                apr_pool_t *pool)
+{
+  revprops_data_t *revprops = (revprops_data_t *)data;
+  svn_fs_fs__revprops_cache_entry_t *entry = apr_palloc(pool,
+                                                        sizeof(*entry));
+
+  entry->properties = properties_to_hash(&revprops->properties, pool);
+  entry->generation = revprops->generation;
+  *out = entry;
 
   return SVN_NO_ERROR;
 }
@@ -155,6 +155,38 @@ svn_fs_fs__deserialize_properties(void **out,
                                   apr_size_t data_len,
                                   apr_pool_t *pool);
 
+/**
+ * Revision properties as stored in the revprop cache.
+ */
+typedef struct svn_fs_fs__revprops_cache_entry_t
+{
+  /* the revprops as an #apr_hash_t of svn_string_t, keyed by const char* */
+  apr_hash_t *properties;
+
+  /* revprop generation at which PROPERTIES were read */
+  apr_int64_t generation;
+} svn_fs_fs__revprops_cache_entry_t;
+
+/**
+ * Implements #svn_cache__serialize_func_t for
+ * #svn_fs_fs__revprops_cache_entry_t.
+ */
+svn_error_t *
+svn_fs_fs__serialize_revprops(void **data,
+                              apr_size_t *data_len,
+                              void *in,
+                              apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__deserialize_func_t for
+ * #svn_fs_fs__revprops_cache_entry_t.
+ */
+svn_error_t *
+svn_fs_fs__deserialize_revprops(void **out,
+                                void *data,
+                                apr_size_t data_len,
+                                apr_pool_t *pool);
+
 /**
  * Implements #svn_cache__serialize_func_t for #svn_fs_id_t
  */
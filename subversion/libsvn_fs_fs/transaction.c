@@ -4009,25 +4009,6 @@ commit_body(void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
-/* Add the representations in REPS_TO_CACHE (an array of representation_t *)
- * to the rep-cache database of FS. */
-static svn_error_t *
-write_reps_to_cache(svn_fs_t *fs,
-                    const apr_array_header_t *reps_to_cache,
-                    apr_pool_t *scratch_pool)
-{
-  int i;
-
-  for (i = 0; i < reps_to_cache->nelts; i++)
-    {
-      representation_t *rep = APR_ARRAY_IDX(reps_to_cache, i, representation_t *);
-
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, scratch_pool));
-    }
-
-  return SVN_NO_ERROR;
-}
-
 svn_error_t *
 svn_fs_fs__commit(svn_revnum_t *new_rev_p,
                   svn_fs_t *fs,
@@ -4072,7 +4053,8 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
              (reader/writer) commits for the duration of the below call.
              Maybe write in batches? */
       SVN_SQLITE__WITH_TXN(
-        write_reps_to_cache(fs, cb.reps_to_cache, pool),
+        svn_fs_fs__set_rep_references(fs, cb.reps_to_cache, *new_rev_p,
+                                      pool),
         ffd->rep_cache_db);
     }
 
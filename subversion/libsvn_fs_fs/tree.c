@@ -3046,6 +3046,20 @@ window_consumer(svn_txdelta_window_t *window, void *baton)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_stream_lazyopen_func_t, opening the base text of the
+   txdelta_baton_t BATON. */
+static svn_error_t *
+lazy_open_source(svn_stream_t **stream,
+                 void *baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  txdelta_baton_t *tb = baton;
+
+  return svn_error_trace(svn_fs_fs__dag_get_contents(stream, tb->node,
+                                                     result_pool));
+}
+
 /* Helper function for fs_apply_textdelta.  BATON is of type
    txdelta_baton_t. */
 static svn_error_t *
@@ -3085,9 +3099,14 @@ apply_textdelta(void *baton, apr_pool_t *pool)
 
   /* Make a readable "source" stream out of the current contents of
      ROOT/PATH; obviously, this must done in the context of a db_txn.
-     The stream is returned in tb->source_stream. */
-  SVN_ERR(svn_fs_fs__dag_get_contents(&(tb->source_stream),
-                                      tb->node, tb->pool));
+     The stream is returned in tb->source_stream.
+
+     Open it only once a window actually refers to the source: deltas
+     that carry the whole text (e.g. replayed additions or fulltext
+     replacements) don't need the base, and locating it means walking
+     its delta chain. */
+  tb->source_stream = svn_stream_lazyopen_create(lazy_open_source, tb,
+                                                 FALSE, tb->pool);
 
   /* Make a writable "target" stream */
   SVN_ERR(svn_fs_fs__dag_get_edit_stream(&(tb->target_stream), tb->node,
@@ -3950,22 +3969,28 @@ assemble_history(svn_fs_t *fs,
 /* mergeinfo queries */
 
 
-/* DIR_DAG is a directory DAG node which has mergeinfo in its
+static svn_error_t *
+get_descendant_mergeinfo(apr_hash_t **mergeinfo,
+                         svn_fs_t *fs,
+                         dag_node_t *dir_dag,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool);
+
+/* DIR_DAG is a directory DAG node in FS which has mergeinfo in its
    descendants.  This function iterates over its children.  For each
-   child with immediate mergeinfo, it adds its mergeinfo to
-   RESULT_CATALOG.  appropriate arguments.  For each child with
-   descendants with mergeinfo, it recurses.  Note that it does *not*
-   call the action on the path for DIR_DAG itself.
-
-   POOL is used for temporary allocations, including the mergeinfo
-   hashes passed to actions; RESULT_POOL is used for the mergeinfo added
-   to RESULT_CATALOG.
+   child with immediate mergeinfo, it adds the unparsed mergeinfo value
+   to RESULT, keyed by the child's path relative to DIR_DAG.  For each
+   child with descendants with mergeinfo, it adds their mergeinfo as
+   returned by get_descendant_mergeinfo().  Note that it does *not* add
+   the mergeinfo of DIR_DAG itself.
+
+   RESULT_POOL is used for the entries added to RESULT; SCRATCH_POOL is
+   used for temporary allocations.
  */
 static svn_error_t *
-crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
-                                  const char *this_path,
+crawl_directory_dag_for_mergeinfo(apr_hash_t *result,
+                                  svn_fs_t *fs,
                                   dag_node_t *dir_dag,
-                                  svn_mergeinfo_catalog_t result_catalog,
                                   apr_pool_t *result_pool,
                                   apr_pool_t *scratch_pool)
 {
@@ -3977,14 +4002,12 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
   for (i = 0; i < entries->nelts; ++i)
     {
       svn_fs_dirent_t *dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
-      const char *kid_path;
       dag_node_t *kid_dag;
       svn_boolean_t has_mergeinfo, go_down;
 
       svn_pool_clear(iterpool);
 
-      kid_path = svn_fspath__join(this_path, dirent->name, iterpool);
-      SVN_ERR(get_dag(&kid_dag, root, kid_path, TRUE, iterpool));
+      SVN_ERR(svn_fs_fs__dag_get_node(&kid_dag, fs, dirent->id, iterpool));
 
       SVN_ERR(svn_fs_fs__dag_has_mergeinfo(&has_mergeinfo, kid_dag));
       SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down, kid_dag));
@@ -3993,9 +4016,7 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
         {
           /* Save this particular node's mergeinfo. */
           apr_hash_t *proplist;
-          svn_mergeinfo_t kid_mergeinfo;
           svn_string_t *mergeinfo_string;
-          svn_error_t *err;
 
           SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, kid_dag, iterpool));
           mergeinfo_string = svn_hash_gets(proplist, SVN_PROP_MERGEINFO);
@@ -4008,39 +4029,78 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
                  idstr->data);
             }
 
-          /* Issue #3896: If a node has syntactically invalid mergeinfo, then
-             treat it as if no mergeinfo is present rather than raising a parse
-             error. */
-          err = svn_mergeinfo_parse(&kid_mergeinfo,
-                                    mergeinfo_string->data,
-                                    result_pool);
-          if (err)
-            {
-              if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
-                svn_error_clear(err);
-              else
-                return svn_error_trace(err);
-              }
-          else
-            {
-              svn_hash_sets(result_catalog, apr_pstrdup(result_pool, kid_path),
-                            kid_mergeinfo);
-            }
+          svn_hash_sets(result, apr_pstrdup(result_pool, dirent->name),
+                        svn_string_dup(mergeinfo_string, result_pool));
         }
 
       if (go_down)
-        SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
-                                                  kid_path,
-                                                  kid_dag,
-                                                  result_catalog,
-                                                  result_pool,
-                                                  iterpool));
+        {
+          apr_hash_t *kid_result;
+          apr_hash_index_t *hi;
+
+          SVN_ERR(get_descendant_mergeinfo(&kid_result, fs, kid_dag,
+                                           iterpool, iterpool));
+          for (hi = apr_hash_first(iterpool, kid_result);
+               hi;
+               hi = apr_hash_next(hi))
+            {
+              const char *relpath = svn_relpath_join(dirent->name,
+                                                     svn__apr_hash_index_key(hi),
+                                                     result_pool);
+              svn_hash_sets(result, relpath,
+                            svn_string_dup(svn__apr_hash_index_val(hi),
+                                           result_pool));
+            }
+        }
     }
 
   svn_pool_destroy(iterpool);
   return SVN_NO_ERROR;
 }
 
+/* Set *MERGEINFO to a hash mapping the paths of all descendants of the
+   committed directory DIR_DAG in FS that have mergeinfo, relative to
+   DIR_DAG, to their unparsed svn_string_t mergeinfo values.  The result
+   only depends on the node revision of DIR_DAG and gets cached under
+   its ID.  Thus, unchanged sub-trees don't have to be crawled again for
+   later revisions.
+
+   Allocate the result in RESULT_POOL; use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+get_descendant_mergeinfo(apr_hash_t **mergeinfo,
+                         svn_fs_t *fs,
+                         dag_node_t *dir_dag,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *cache_key = NULL;
+
+  if (ffd->descendant_mergeinfo_cache)
+    {
+      svn_boolean_t found;
+
+      cache_key = svn_fs_fs__id_unparse(svn_fs_fs__dag_get_id(dir_dag),
+                                        scratch_pool)->data;
+      SVN_ERR(svn_cache__get((void **)mergeinfo, &found,
+                             ffd->descendant_mergeinfo_cache, cache_key,
+                             result_pool));
+      if (found)
+        return SVN_NO_ERROR;
+    }
+
+  *mergeinfo = svn_hash__make(result_pool);
+  SVN_ERR(crawl_directory_dag_for_mergeinfo(*mergeinfo, fs, dir_dag,
+                                            result_pool, scratch_pool));
+
+  if (cache_key)
+    SVN_ERR(svn_cache__set(ffd->descendant_mergeinfo_cache, cache_key,
+                           *mergeinfo, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Return the cache key as a combination of REV_ROOT->REV, the inheritance
    flags INHERIT and ADJUST_INHERITED_MERGEINFO, and the PATH.  The result
    will be allocated in POOL..
@@ -4229,17 +4289,46 @@ add_descendant_mergeinfo(svn_mergeinfo_catalog_t result_catalog,
 {
   dag_node_t *this_dag;
   svn_boolean_t go_down;
+  apr_hash_t *mergeinfo_strings;
+  apr_hash_index_t *hi;
 
   SVN_ERR(get_dag(&this_dag, root, path, TRUE, scratch_pool));
   SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down,
                                                         this_dag));
-  if (go_down)
-    SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
-                                              path,
-                                              this_dag,
-                                              result_catalog,
-                                              result_pool,
-                                              scratch_pool));
+  if (!go_down)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_descendant_mergeinfo(&mergeinfo_strings, root->fs, this_dag,
+                                   scratch_pool, scratch_pool));
+  for (hi = apr_hash_first(scratch_pool, mergeinfo_strings);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const svn_string_t *mergeinfo_string = svn__apr_hash_index_val(hi);
+      svn_mergeinfo_t kid_mergeinfo;
+      svn_error_t *err;
+
+      /* Issue #3896: If a node has syntactically invalid mergeinfo, then
+         treat it as if no mergeinfo is present rather than raising a parse
+         error. */
+      err = svn_mergeinfo_parse(&kid_mergeinfo, mergeinfo_string->data,
+                                result_pool);
+      if (err)
+        {
+          if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
+            svn_error_clear(err);
+          else
+            return svn_error_trace(err);
+        }
+      else
+        {
+          const char *kid_path
+            = svn_fspath__join(path, svn__apr_hash_index_key(hi),
+                               result_pool);
+          svn_hash_sets(result_catalog, kid_path, kid_mergeinfo);
+        }
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -90,6 +90,13 @@ svn_fs_fs__path_revprop_generation(svn_fs_t *fs,
   return svn_dirent_join(fs->path, PATH_REVPROP_GENERATION, pool);
 }
 
+const char *
+svn_fs_fs__path_lock_generation(svn_fs_t *fs,
+                                apr_pool_t *pool)
+{
+  return svn_dirent_join(fs->path, PATH_LOCK_GENERATION, pool);
+}
+
 const char *
 svn_fs_fs__path_rev_packed(svn_fs_t *fs,
                            svn_revnum_t rev,
@@ -137,6 +137,13 @@ const char *
 svn_fs_fs__path_revprop_generation(svn_fs_t *fs,
                                    apr_pool_t *pool);
 
+/* Return the full path of the lock generation file in FS.
+ * Allocate the result in POOL.
+ */
+const char *
+svn_fs_fs__path_lock_generation(svn_fs_t *fs,
+                                apr_pool_t *pool);
+
 /* Return the full path of the revision properties pack shard directory
  * that will contain the packed properties of revision REV in FS.
  * Allocate the result in POOL.
@@ -3028,6 +3028,20 @@ window_consumer(svn_txdelta_window_t *window, void *baton)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_stream_lazyopen_func_t, opening the base text of the
+   txdelta_baton_t BATON. */
+static svn_error_t *
+lazy_open_source(svn_stream_t **stream,
+                 void *baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  txdelta_baton_t *tb = baton;
+
+  return svn_error_trace(svn_fs_x__dag_get_contents(stream, tb->node,
+                                                    result_pool));
+}
+
 /* Helper function for fs_apply_textdelta.  BATON is of type
    txdelta_baton_t. */
 static svn_error_t *
@@ -3067,9 +3081,12 @@ apply_textdelta(void *baton, apr_pool_t *pool)
 
   /* Make a readable "source" stream out of the current contents of
      ROOT/PATH; obviously, this must done in the context of a db_txn.
-     The stream is returned in tb->source_stream. */
-  SVN_ERR(svn_fs_x__dag_get_contents(&(tb->source_stream),
-                                     tb->node, tb->pool));
+     The stream is returned in tb->source_stream.
+
+     Open it only once a window actually refers to the source, which
+     spares us looking up the base representation for fulltext deltas. */
+  tb->source_stream = svn_stream_lazyopen_create(lazy_open_source, tb,
+                                                 FALSE, tb->pool);
 
   /* Make a writable "target" stream */
   SVN_ERR(svn_fs_x__dag_get_edit_stream(&(tb->target_stream), tb->node,
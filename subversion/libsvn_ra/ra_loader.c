@@ -770,6 +770,28 @@ svn_error_t *svn_ra_get_commit_editor3(svn_ra_session_t *session,
                                             lock_tokens, keep_locks, pool);
 }
 
+/* Assert that all elements of PATHS are canonical relpaths.  If
+ * *REVISION is not a valid revision number, set it to SESSION's HEAD
+ * revision such that all paths get processed in the same revision.
+ * Use POOL for temporary allocations. */
+static svn_error_t *
+prepare_many_paths(svn_ra_session_t *session,
+                   const apr_array_header_t *paths,
+                   svn_revnum_t *revision,
+                   apr_pool_t *pool)
+{
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR_ASSERT(svn_relpath_is_canonical(APR_ARRAY_IDX(paths, i,
+                                                          const char *)));
+
+  if (!SVN_IS_VALID_REVNUM(*revision))
+    SVN_ERR(svn_ra_get_latest_revnum(session, revision, pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_get_file(svn_ra_session_t *session,
                              const char *path,
                              svn_revnum_t revision,
@@ -783,6 +805,54 @@ svn_error_t *svn_ra_get_file(svn_ra_session_t *session,
                                    fetched_rev, props, pool);
 }
 
+svn_error_t *svn_ra_get_file_many(svn_ra_session_t *session,
+                                  const apr_array_header_t *paths,
+                                  svn_revnum_t revision,
+                                  const apr_array_header_t *streams,
+                                  svn_revnum_t *fetched_rev,
+                                  apr_hash_t **props,
+                                  apr_pool_t *pool)
+{
+  int i;
+
+  SVN_ERR_ASSERT(streams == NULL || streams->nelts == paths->nelts);
+  SVN_ERR(prepare_many_paths(session, paths, &revision, pool));
+  if (fetched_rev)
+    *fetched_rev = revision;
+
+  if (session->vtable->get_file_many)
+    {
+      svn_error_t *err = session->vtable->get_file_many(session, paths,
+                                                        revision, streams,
+                                                        props, pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  /* Fall back to one request per path. */
+  if (props)
+    *props = apr_hash_make(pool);
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_stream_t *stream = streams
+                           ? APR_ARRAY_IDX(streams, i, svn_stream_t *)
+                           : NULL;
+      apr_hash_t *file_props;
+
+      SVN_ERR(session->vtable->get_file(session, path, revision, stream,
+                                        NULL, props ? &file_props : NULL,
+                                        pool));
+      if (props)
+        svn_hash_sets(*props, path, file_props);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_get_dir2(svn_ra_session_t *session,
                              apr_hash_t **dirents,
                              svn_revnum_t *fetched_rev,
@@ -797,6 +867,58 @@ svn_error_t *svn_ra_get_dir2(svn_ra_session_t *session,
                                   path, revision, dirent_fields, pool);
 }
 
+svn_error_t *svn_ra_get_dir_many(svn_ra_session_t *session,
+                                 apr_hash_t **dirents,
+                                 svn_revnum_t *fetched_rev,
+                                 apr_hash_t **props,
+                                 const apr_array_header_t *paths,
+                                 svn_revnum_t revision,
+                                 apr_uint32_t dirent_fields,
+                                 apr_pool_t *pool)
+{
+  int i;
+
+  SVN_ERR(prepare_many_paths(session, paths, &revision, pool));
+  if (fetched_rev)
+    *fetched_rev = revision;
+
+  if (session->vtable->get_dir_many)
+    {
+      svn_error_t *err = session->vtable->get_dir_many(session, dirents,
+                                                       props, paths,
+                                                       revision,
+                                                       dirent_fields, pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  /* Fall back to one request per path. */
+  if (dirents)
+    *dirents = apr_hash_make(pool);
+  if (props)
+    *props = apr_hash_make(pool);
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      apr_hash_t *dir_dirents, *dir_props;
+
+      SVN_ERR(session->vtable->get_dir(session,
+                                       dirents ? &dir_dirents : NULL,
+                                       NULL,
+                                       props ? &dir_props : NULL,
+                                       path, revision, dirent_fields, pool));
+      if (dirents)
+        svn_hash_sets(*dirents, path, dir_dirents);
+      if (props)
+        svn_hash_sets(*props, path, dir_props);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_get_mergeinfo(svn_ra_session_t *session,
                                   svn_mergeinfo_catalog_t *catalog,
                                   const apr_array_header_t *paths,
@@ -1071,6 +1193,42 @@ svn_error_t *svn_ra_stat(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *svn_ra_stat_many(svn_ra_session_t *session,
+                              const apr_array_header_t *paths,
+                              svn_revnum_t revision,
+                              apr_hash_t **dirents,
+                              apr_pool_t *pool)
+{
+  int i;
+
+  SVN_ERR(prepare_many_paths(session, paths, &revision, pool));
+
+  if (session->vtable->stat_many)
+    {
+      svn_error_t *err = session->vtable->stat_many(session, paths, revision,
+                                                    dirents, pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  /* Fall back to one request per path.  Use svn_ra_stat() here because
+     it knows how to handle servers that don't support 'stat'. */
+  *dirents = apr_hash_make(pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_dirent_t *dirent;
+
+      SVN_ERR(svn_ra_stat(session, path, revision, &dirent, pool));
+      if (dirent)
+        svn_hash_sets(*dirents, path, dirent);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_get_uuid2(svn_ra_session_t *session,
                               const char **uuid,
                               apr_pool_t *pool)
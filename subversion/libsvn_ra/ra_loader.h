@@ -348,6 +348,32 @@ typedef struct svn_ra__vtable_t {
     void *replay_baton,
     apr_pool_t *scratch_pool);
 
+  /* The following functions are optional.  If they are NULL or return
+     SVN_ERR_RA_NOT_IMPLEMENTED, the RA loader will process the paths one
+     by one.  REVISION will always be a valid revision number. */
+
+  /* See svn_ra_stat_many(). */
+  svn_error_t *(*stat_many)(svn_ra_session_t *session,
+                            const apr_array_header_t *paths,
+                            svn_revnum_t revision,
+                            apr_hash_t **dirents,
+                            apr_pool_t *pool);
+  /* See svn_ra_get_file_many(). */
+  svn_error_t *(*get_file_many)(svn_ra_session_t *session,
+                                const apr_array_header_t *paths,
+                                svn_revnum_t revision,
+                                const apr_array_header_t *streams,
+                                apr_hash_t **props,
+                                apr_pool_t *pool);
+  /* See svn_ra_get_dir_many(). */
+  svn_error_t *(*get_dir_many)(svn_ra_session_t *session,
+                               apr_hash_t **dirents,
+                               apr_hash_t **props,
+                               const apr_array_header_t *paths,
+                               svn_revnum_t revision,
+                               apr_uint32_t dirent_fields,
+                               apr_pool_t *pool);
+
 } svn_ra__vtable_t;
 
 /* The RA session object. */
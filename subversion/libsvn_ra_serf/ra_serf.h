@@ -86,6 +86,20 @@ typedef struct svn_ra_serf__connection_t {
 
   svn_ra_serf__session_t *session;
 
+  /* Statistics, used to balance requests over the connections. */
+
+  /* Number of requests queued on this connection that are not done yet */
+  int num_pending_reqs;
+
+  /* Number of requests that received a response on this connection */
+  apr_uint64_t num_completed_reqs;
+
+  /* Smoothed time between queueing a request and completing its response */
+  apr_interval_time_t srtt;
+
+  /* Number of file content bytes fetched over this connection */
+  apr_uint64_t bytes_fetched;
+
 } svn_ra_serf__connection_t;
 
 /** Maximum value we'll allow for the http-max-connections config option.
@@ -140,6 +154,13 @@ struct svn_ra_serf__session_t {
      HTTP/1.0. Thus, we cannot send chunked requests.  */
   svn_boolean_t http10;
 
+  /* Should we offer HTTP/2 when setting up (https) connections? */
+  svn_boolean_t try_http20;
+
+  /* The server agreed to talk HTTP/2, which multiplexes all requests
+     over a single connection.  */
+  svn_boolean_t http20;
+
   /* Should we use Transfer-Encoding: chunked for HTTP/1.1 servers. */
   svn_boolean_t using_chunked_requests;
 
@@ -513,6 +534,9 @@ typedef struct svn_ra_serf__handler_t {
   /* Pool for allocating SLINE.REASON and LOCATION. If this pool is NULL,
      then the requestor does not care about SLINE and LOCATION.  */
   apr_pool_t *handler_pool;
+
+  /* Internal: the time at which the request was (last) queued.  */
+  apr_time_t schedule_time;
 } svn_ra_serf__handler_t;
 
 
@@ -244,6 +244,12 @@ load_config(svn_ra_serf__session_t *session,
                                   SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                   "auto", svn_tristate_unknown));
 
+  /* Should we try to use HTTP/2. */
+  SVN_ERR(svn_config_get_bool(config, &session->try_http20,
+                              SVN_CONFIG_SECTION_GLOBAL,
+                              SVN_CONFIG_OPTION_HTTP_HTTP2,
+                              FALSE));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   SVN_ERR(svn_config_get_int64(config, &log_components,
                                SVN_CONFIG_SECTION_GLOBAL,
@@ -318,6 +324,12 @@ load_config(svn_ra_serf__session_t *session,
                                       SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                       "auto", chunked_requests));
 
+      /* Should we try to use HTTP/2. */
+      SVN_ERR(svn_config_get_bool(config, &session->try_http20,
+                                  server_group,
+                                  SVN_CONFIG_OPTION_HTTP_HTTP2,
+                                  session->try_http20));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
       SVN_ERR(svn_config_get_int64(config, &log_components,
                                    server_group,
@@ -357,6 +369,13 @@ load_config(svn_ra_serf__session_t *session,
   if (session->max_connections < 2)
     session->max_connections = 2;
 
+  /* With two connections all auxiliary requests of an update share one
+     connection and arrive in order, which editors like svnrdump's rely on
+     (see get_best_connection() in update.c).  HTTP/2 would multiplex them
+     with the REPORT response, so don't offer it then. */
+  if (session->max_connections <= 2)
+    session->try_http20 = FALSE;
+
   /* Parse the connection timeout value, if any. */
   session->timeout = apr_time_from_sec(DEFAULT_HTTP_TIMEOUT);
   if (timeout_str)
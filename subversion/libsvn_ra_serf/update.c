@@ -49,6 +49,9 @@
 #include "ra_serf.h"
 #include "../libsvn_ra/ra_loader.h"
 
+/* For connection usage debugging. Reports per connection statistics at
+   the end of each update.  */
+/* #define SVN_DEBUG_RA_SERF_CONNECTIONS */
 
 
 /*
@@ -251,9 +254,20 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
    can make the measurements quite imprecise.
 
    We measure outstanding requests as the sum of NUM_ACTIVE_FETCHES and
-   NUM_ACTIVE_PROPFINDS in the report_context_t structure.  */
-#define REQUEST_COUNT_TO_PAUSE 50
+   NUM_ACTIVE_PROPFINDS in the report_context_t structure, and compare that
+   against its REQUEST_WINDOW.  That window starts at REQUEST_COUNT_TO_RESUME
+   and adapts to the responses we see: when we are mostly fetching small
+   files we are bound by latency rather than bandwidth, so we allow more
+   requests in flight; when fetching large files we allow fewer, to limit
+   the memory used for partially received files.  */
 #define REQUEST_COUNT_TO_RESUME 40
+#define REQUEST_WINDOW_MIN 16
+#define REQUEST_WINDOW_MAX 128
+
+/* Average GET response sizes below which respectively above which we
+   grow respectively shrink the request window. */
+#define SMALL_FETCH_SIZE 16384
+#define LARGE_FETCH_SIZE 262144
 
 #define SPILLBUF_BLOCKSIZE 4096
 #define SPILLBUF_MAXBUFFSIZE 131072
@@ -447,6 +461,14 @@ struct report_context_t {
   /* number of pending PROPFIND requests */
   unsigned int num_active_propfinds;
 
+  /* Number of pending requests at which we pause processing the REPORT
+     response; see REQUEST_COUNT_TO_RESUME */
+  unsigned int request_window;
+
+  /* Total size and number of the completed GET responses */
+  apr_uint64_t fetched_bytes;
+  unsigned int num_fetches_done;
+
   /* Are we done parsing the REPORT response? */
   svn_boolean_t done;
 
@@ -693,39 +715,46 @@ create_file_baton(file_baton_t **new_file,
 #define REQS_PER_CONN 8
 
 /** This function creates a new connection for this serf session, but only
- * if the number of NUM_ACTIVE_REQS > REQS_PER_CONN or if there currently is
- * only one main connection open.
+ * if all the auxiliary connections have at least REQS_PER_CONN requests
+ * pending or if there currently is only one main connection open.
  */
 static svn_error_t *
-open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
+open_connection_if_needed(svn_ra_serf__session_t *sess)
 {
-  /* For each REQS_PER_CONN outstanding requests open a new connection, with
+  int cur = sess->num_conns;
+  apr_status_t status;
+  int i;
+
+  /* HTTP/2 multiplexes all requests over the connection we have */
+  if (sess->http20)
+    return SVN_NO_ERROR;
+
+  /* Open a new connection once the existing ones are all busy, with
    * a minimum of 1 extra connection. */
-  if (sess->num_conns == 1 ||
-      ((num_active_reqs / REQS_PER_CONN) > sess->num_conns))
+  for (i = 1; i < sess->num_conns; i++)
     {
-      int cur = sess->num_conns;
-      apr_status_t status;
-
-      sess->conns[cur] = apr_pcalloc(sess->pool, sizeof(*sess->conns[cur]));
-      sess->conns[cur]->bkt_alloc = serf_bucket_allocator_create(sess->pool,
-                                                                 NULL, NULL);
-      sess->conns[cur]->last_status_code = -1;
-      sess->conns[cur]->session = sess;
-      status = serf_connection_create2(&sess->conns[cur]->conn,
-                                       sess->context,
-                                       sess->session_url,
-                                       svn_ra_serf__conn_setup,
-                                       sess->conns[cur],
-                                       svn_ra_serf__conn_closed,
-                                       sess->conns[cur],
-                                       sess->pool);
-      if (status)
-        return svn_ra_serf__wrap_err(status, NULL);
-
-      sess->num_conns++;
+      if (sess->conns[i]->num_pending_reqs < REQS_PER_CONN)
+        return SVN_NO_ERROR;
     }
 
+  sess->conns[cur] = apr_pcalloc(sess->pool, sizeof(*sess->conns[cur]));
+  sess->conns[cur]->bkt_alloc = serf_bucket_allocator_create(sess->pool,
+                                                             NULL, NULL);
+  sess->conns[cur]->last_status_code = -1;
+  sess->conns[cur]->session = sess;
+  status = serf_connection_create2(&sess->conns[cur]->conn,
+                                   sess->context,
+                                   sess->session_url,
+                                   svn_ra_serf__conn_setup,
+                                   sess->conns[cur],
+                                   svn_ra_serf__conn_closed,
+                                   sess->conns[cur],
+                                   sess->pool);
+  if (status)
+    return svn_ra_serf__wrap_err(status, NULL);
+
+  sess->num_conns++;
+
   return SVN_NO_ERROR;
 }
 
@@ -752,9 +781,16 @@ get_best_connection(report_context_t *ctx)
   if (ctx->report_received && (ctx->sess->max_connections > 2))
     first_conn = 0;
 
-  /* Currently, we just cycle connections.  In the future we could
-     store the number of pending requests on each connection, or
-     perform other heuristics, to achieve better connection usage.
+  /* With HTTP/2 the REPORT response doesn't block other requests on its
+     connection, and we don't open others.  HTTP/2 is never negotiated
+     when max_connections <= 2, so this doesn't undo the ordering above. */
+  if (ctx->sess->http20)
+    first_conn = 0;
+
+  /* Use the connection with the fewest pending requests, preferring the
+     one that has been answering fastest if that is a tie.  Start looking
+     at the connection after the one we used last, to cycle through the
+     connections when they are equally good.
      (As an optimization, if there's only one available auxiliary
      connection to use, don't bother doing all the cur_conn math --
      just return that one connection.)  */
@@ -764,8 +800,29 @@ get_best_connection(report_context_t *ctx)
     }
   else
     {
-      conn = ctx->sess->conns[ctx->sess->cur_conn];
-      ctx->sess->cur_conn++;
+      int i;
+      int best = -1;
+
+      for (i = 0; i < ctx->sess->num_conns - first_conn; i++)
+        {
+          int c = ctx->sess->cur_conn + i;
+          svn_ra_serf__connection_t *candidate;
+
+          if (c >= ctx->sess->num_conns)
+            c -= ctx->sess->num_conns - first_conn;
+
+          candidate = ctx->sess->conns[c];
+          if (best < 0
+              || candidate->num_pending_reqs
+                   < ctx->sess->conns[best]->num_pending_reqs
+              || (candidate->num_pending_reqs
+                    == ctx->sess->conns[best]->num_pending_reqs
+                  && candidate->srtt < ctx->sess->conns[best]->srtt))
+            best = c;
+        }
+
+      conn = ctx->sess->conns[best];
+      ctx->sess->cur_conn = best + 1;
       if (ctx->sess->cur_conn >= ctx->sess->num_conns)
         ctx->sess->cur_conn = first_conn;
     }
@@ -1285,6 +1342,27 @@ file_props_done(serf_request_t *request,
   return svn_error_trace(close_file(file, scratch_pool));
 }
 
+/* Account for a completed GET response of SIZE bytes in CTX, and adapt
+   its request window to the average response size. */
+static void
+adapt_request_window(report_context_t *ctx,
+                     apr_off_t size)
+{
+  apr_uint64_t average;
+
+  ctx->fetched_bytes += size;
+  ctx->num_fetches_done++;
+
+  average = ctx->fetched_bytes / ctx->num_fetches_done;
+
+  if (average < SMALL_FETCH_SIZE
+      && ctx->request_window < REQUEST_WINDOW_MAX)
+    ctx->request_window++;
+  else if (average > LARGE_FETCH_SIZE
+           && ctx->request_window > REQUEST_WINDOW_MIN)
+    ctx->request_window--;
+}
+
 static svn_error_t *
 file_fetch_done(serf_request_t *request,
                 void *baton,
@@ -1303,6 +1381,9 @@ file_fetch_done(serf_request_t *request,
 
   file->parent_dir->ctx->num_active_fetches--;
 
+  handler->conn->bytes_fetched += fetch_ctx->read_size;
+  adapt_request_window(file->parent_dir->ctx, fetch_ctx->read_size);
+
   file->fetch_file = FALSE;
 
   if (file->fetch_props)
@@ -1329,8 +1410,7 @@ fetch_for_file(file_baton_t *file,
 
   /* Open extra connections if we have enough requests to send. */
   if (ctx->sess->num_conns < ctx->sess->max_connections)
-    SVN_ERR(open_connection_if_needed(ctx->sess, ctx->num_active_fetches +
-                                                 ctx->num_active_propfinds));
+    SVN_ERR(open_connection_if_needed(ctx->sess));
 
   /* What connection should we go on? */
   conn = get_best_connection(ctx);
@@ -1557,8 +1637,7 @@ fetch_for_dir(dir_baton_t *dir,
 
   /* Open extra connections if we have enough requests to send. */
   if (ctx->sess->num_conns < ctx->sess->max_connections)
-    SVN_ERR(open_connection_if_needed(ctx->sess, ctx->num_active_fetches +
-                                                 ctx->num_active_propfinds));
+    SVN_ERR(open_connection_if_needed(ctx->sess));
 
   /* What connection should we go on? */
   conn = get_best_connection(ctx);
@@ -2402,7 +2481,7 @@ update_delay_handler(serf_request_t *request,
         }
 
       while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+                 < udb->report->request_window)
         {
           const char *data;
           apr_size_t len;
@@ -2486,7 +2565,7 @@ process_pending(update_delay_baton_t *udb,
   serf_bucket_alloc_t *alloc = NULL;
 
   while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+            < udb->report->request_window)
     {
       const char *data;
       apr_size_t len;
@@ -2558,7 +2637,7 @@ process_editor_report(report_context_t *ctx,
   handler->response_baton = ud;
 
   /* Open the first extra connection. */
-  SVN_ERR(open_connection_if_needed(sess, 0));
+  SVN_ERR(open_connection_if_needed(sess));
 
   sess->cur_conn = 1;
 
@@ -2602,6 +2681,21 @@ process_editor_report(report_context_t *ctx,
 
   svn_pool_clear(iterpool);
 
+#ifdef SVN_DEBUG_RA_SERF_CONNECTIONS
+  {
+    int i;
+
+    SVN_DBG(("request window: %u, fetches: %u, bytes: %" APR_UINT64_T_FMT
+             "\n", ctx->request_window, ctx->num_fetches_done,
+             ctx->fetched_bytes));
+    for (i = 0; i < sess->num_conns; i++)
+      SVN_DBG(("connection %d: requests: %" APR_UINT64_T_FMT
+               ", bytes: %" APR_UINT64_T_FMT ", srtt: %" APR_TIME_T_FMT
+               "us\n", i, sess->conns[i]->num_completed_reqs,
+               sess->conns[i]->bytes_fetched, sess->conns[i]->srtt));
+  }
+#endif
+
   /* If we got a complete report, close the edit.  Otherwise, abort it. */
   if (ctx->done)
     SVN_ERR(ctx->editor->close_edit(ctx->editor_baton, iterpool));
@@ -2756,6 +2850,7 @@ make_update_reporter(svn_ra_session_t *ra_session,
   report->editor = update_editor;
   report->editor_baton = update_baton;
   report->done = FALSE;
+  report->request_window = REQUEST_COUNT_TO_RESUME;
 
   *reporter = &ra_serf_reporter;
   *report_baton = report;
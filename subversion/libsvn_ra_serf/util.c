@@ -474,6 +474,32 @@ load_authorities(svn_ra_serf__connection_t *conn, const char *authorities,
   return SVN_NO_ERROR;
 }
 
+#ifdef SVN_SERF_HAVE_HTTP2
+/* Implements serf_ssl_protocol_result_cb_t, selecting the framing of
+   connection DATA once the server picked PROTOCOL via ALPN. */
+static apr_status_t
+conn_negotiate_protocol(void *data,
+                        const char *protocol)
+{
+  svn_ra_serf__connection_t *conn = data;
+
+  if (strcmp(protocol, "h2") == 0)
+    {
+      serf_connection_set_framing_type(conn->conn,
+                                       SERF_CONNECTION_FRAMING_TYPE_HTTP2);
+      conn->session->http20 = TRUE;
+    }
+  else
+    {
+      /* PROTOCOL is "http/1.1", or "" if the server doesn't do ALPN */
+      serf_connection_set_framing_type(conn->conn,
+                                       SERF_CONNECTION_FRAMING_TYPE_HTTP1);
+    }
+
+  return APR_SUCCESS;
+}
+#endif
+
 static svn_error_t *
 conn_setup(apr_socket_t *sock,
            serf_bucket_t **read_bkt,
@@ -508,6 +534,13 @@ conn_setup(apr_socket_t *sock,
                                             ssl_server_cert_cb,
                                             conn);
 
+#ifdef SVN_SERF_HAVE_HTTP2
+          /* Offer HTTP/2, falling back to HTTP/1.1 */
+          if (conn->session->try_http20)
+            serf_ssl_negotiate_protocol(conn->ssl_context, "h2,http/1.1",
+                                        conn_negotiate_protocol, conn);
+#endif
+
           /* See if the user wants us to trust "default" openssl CAs. */
           if (conn->session->trust_default_ca)
             {
@@ -1177,6 +1210,33 @@ svn_ra_serf__credentials_callback(char **username, char **password,
   return APR_SUCCESS;
 }
 
+/* Mark HANDLER as no longer scheduled on its connection.  If COMPLETED,
+   it received a complete response, so account for that in the statistics
+   of the connection. */
+static void
+unschedule_request(svn_ra_serf__handler_t *handler,
+                   svn_boolean_t completed)
+{
+  svn_ra_serf__connection_t *conn = handler->conn;
+
+  if (!handler->scheduled)
+    return;
+
+  handler->scheduled = FALSE;
+  conn->num_pending_reqs--;
+
+  if (completed)
+    {
+      apr_interval_time_t rtt = apr_time_now() - handler->schedule_time;
+
+      /* Keep a moving average, like TCP's smoothed round trip time */
+      if (conn->num_completed_reqs++ == 0)
+        conn->srtt = rtt;
+      else
+        conn->srtt += (rtt - conn->srtt) / 8;
+    }
+}
+
 /* Wait for HTTP response status and headers, and invoke HANDLER->
    response_handler() to carry out operation-specific processing.
    Afterwards, check for connection close.
@@ -1202,7 +1262,7 @@ handle_response(serf_request_t *request,
   if (!response)
     {
       /* Uh-oh. Our connection died.  */
-      handler->scheduled = FALSE;
+      unschedule_request(handler, FALSE);
 
       if (handler->response_error)
         {
@@ -1427,7 +1487,7 @@ handle_response_cb(serf_request_t *request,
     {
       svn_ra_serf__session_t *sess = handler->session;
       handler->done = TRUE;
-      handler->scheduled = FALSE;
+      unschedule_request(handler, TRUE);
       outer_status = APR_EOF;
 
       /* We use a cached handler->session here to allow handler to free the
@@ -1441,7 +1501,7 @@ handle_response_cb(serf_request_t *request,
     {
       handler->discard_body = TRUE; /* Discard further data */
       handler->done = TRUE; /* Mark as done */
-      handler->scheduled = FALSE;
+      unschedule_request(handler, FALSE);
       outer_status = APR_EAGAIN; /* Exit context loop */
     }
 
@@ -1555,6 +1615,8 @@ svn_ra_serf__request_create(svn_ra_serf__handler_t *handler)
   handler->reading_body = FALSE;
   handler->discard_body = FALSE;
   handler->scheduled = TRUE;
+  handler->schedule_time = apr_time_now();
+  handler->conn->num_pending_reqs++;
 
   /* Keeping track of the returned request object would be nice, but doesn't
      work the way we would expect in ra_serf..
@@ -1875,6 +1937,7 @@ handler_cleanup(void *baton)
   svn_ra_serf__handler_t *handler = baton;
   if (handler->scheduled && handler->conn)
     {
+      unschedule_request(handler, FALSE);
       serf_connection_reset(handler->conn->conn);
     }
 
@@ -1271,22 +1271,31 @@ parse_iproplist(apr_array_header_t **inherited_props,
   return SVN_NO_ERROR;
 }
 
-static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
-                                    svn_revnum_t rev, svn_stream_t *stream,
-                                    svn_revnum_t *fetched_rev,
-                                    apr_hash_t **props,
-                                    apr_pool_t *pool)
+/* Read the response to a "get-file" command for PATH from SESS_BATON's
+ * connection.  Push the file contents into STREAM if that is not NULL;
+ * the contents must have been requested in that case.  Set *FETCHED_REV
+ * and *PROPS unless they are NULL.  Use POOL for all allocations.
+ *
+ * If writing to STREAM fails, read the remaining contents nevertheless
+ * such that the connection is ready for the next command response.
+ */
+static svn_error_t *read_get_file_response(
+                        svn_ra_svn__session_baton_t *sess_baton,
+                        const char *path,
+                        svn_stream_t *stream,
+                        svn_revnum_t *fetched_rev,
+                        apr_hash_t **props,
+                        apr_pool_t *pool)
 {
-  svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
   apr_array_header_t *proplist;
   const char *expected_digest;
   svn_checksum_t *expected_checksum = NULL;
   svn_checksum_ctx_t *checksum_ctx;
+  svn_revnum_t rev;
+  svn_error_t *err = SVN_NO_ERROR;
   apr_pool_t *iterpool;
 
-  SVN_ERR(svn_ra_svn__write_cmd_get_file(conn, pool, path, rev,
-                                         (props != NULL), (stream != NULL)));
   SVN_ERR(handle_auth_request(sess_baton, pool));
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "(?c)rl",
                                         &expected_digest,
@@ -1322,16 +1331,22 @@ static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
       if (item->u.string->len == 0)
         break;
 
+      /* After an error, only skip over the remaining contents. */
+      if (err)
+        continue;
+
       if (expected_checksum)
         SVN_ERR(svn_checksum_update(checksum_ctx, item->u.string->data,
                                     item->u.string->len));
 
-      SVN_ERR(svn_stream_write(stream, item->u.string->data,
-                               &item->u.string->len));
+      err = svn_stream_write(stream, item->u.string->data,
+                             &item->u.string->len);
     }
   svn_pool_destroy(iterpool);
 
-  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, ""));
+  SVN_ERR(svn_error_compose_create(err,
+                                   svn_ra_svn__read_cmd_response(conn, pool,
+                                                                 "")));
 
   if (expected_checksum)
     {
@@ -1347,22 +1362,35 @@ static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
   return SVN_NO_ERROR;
 }
 
-static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
-                                   apr_hash_t **dirents,
-                                   svn_revnum_t *fetched_rev,
-                                   apr_hash_t **props,
-                                   const char *path,
-                                   svn_revnum_t rev,
-                                   apr_uint32_t dirent_fields,
-                                   apr_pool_t *pool)
+static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
+                                    svn_revnum_t rev, svn_stream_t *stream,
+                                    svn_revnum_t *fetched_rev,
+                                    apr_hash_t **props,
+                                    apr_pool_t *pool)
 {
   svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
-  apr_array_header_t *proplist, *dirlist;
-  int i;
 
+  SVN_ERR(svn_ra_svn__write_cmd_get_file(conn, pool, path, rev,
+                                         (props != NULL), (stream != NULL)));
+  return svn_error_trace(read_get_file_response(sess_baton, path, stream,
+                                                fetched_rev, props, pool));
+}
+
+/* Send a "get-dir" command for PATH in REV over CONN, requesting the
+ * properties if WANT_PROPS is set and the DIRENT_FIELDS of the directory
+ * entries if WANT_DIRENTS is set.  Use POOL for temporary allocations.
+ */
+static svn_error_t *write_get_dir(svn_ra_svn_conn_t *conn,
+                                  const char *path,
+                                  svn_revnum_t rev,
+                                  svn_boolean_t want_props,
+                                  svn_boolean_t want_dirents,
+                                  apr_uint32_t dirent_fields,
+                                  apr_pool_t *pool)
+{
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w(c(?r)bb(!", "get-dir", path,
-                                  rev, (props != NULL), (dirents != NULL)));
+                                  rev, want_props, want_dirents));
   if (dirent_fields & SVN_DIRENT_KIND)
     SVN_ERR(svn_ra_svn__write_word(conn, pool, SVN_RA_SVN_DIRENT_KIND));
   if (dirent_fields & SVN_DIRENT_SIZE)
@@ -1381,6 +1409,26 @@ static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
      to see "true" if it is omitted. */
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)b)", FALSE));
 
+  return SVN_NO_ERROR;
+}
+
+/* Read the response to a "get-dir" command from SESS_BATON's connection.
+ * Set *FETCHED_REV, *PROPS and *DIRENTS unless they are NULL; the latter
+ * two must have been requested in that case.  Use POOL for all
+ * allocations.
+ */
+static svn_error_t *read_get_dir_response(
+                        svn_ra_svn__session_baton_t *sess_baton,
+                        apr_hash_t **dirents,
+                        svn_revnum_t *fetched_rev,
+                        apr_hash_t **props,
+                        apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_array_header_t *proplist, *dirlist;
+  svn_revnum_t rev;
+  int i;
+
   SVN_ERR(handle_auth_request(sess_baton, pool));
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "rll", &rev, &proplist,
                                         &dirlist));
@@ -1443,6 +1491,23 @@ static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
+                                   apr_hash_t **dirents,
+                                   svn_revnum_t *fetched_rev,
+                                   apr_hash_t **props,
+                                   const char *path,
+                                   svn_revnum_t rev,
+                                   apr_uint32_t dirent_fields,
+                                   apr_pool_t *pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+
+  SVN_ERR(write_get_dir(sess_baton->conn, path, rev, (props != NULL),
+                        (dirents != NULL), dirent_fields, pool));
+  return svn_error_trace(read_get_dir_response(sess_baton, dirents,
+                                               fetched_rev, props, pool));
+}
+
 /* Converts a apr_uint64_t with values TRUE, FALSE or
    SVN_RA_SVN_UNSPECIFIED_NUMBER as provided by svn_ra_svn__parse_tuple
    to a svn_tristate_t */
@@ -1914,16 +1979,17 @@ static svn_error_t *handle_unsupported_cmd(svn_error_t *err,
 }
 
 
-static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
-                                const char *path, svn_revnum_t rev,
-                                svn_dirent_t **dirent, apr_pool_t *pool)
+/* Read the response to a "stat" command from SESS_BATON's connection
+ * and set *DIRENT accordingly.  Use POOL for all allocations.
+ */
+static svn_error_t *read_stat_response(svn_ra_svn__session_baton_t *sess_baton,
+                                       svn_dirent_t **dirent,
+                                       apr_pool_t *pool)
 {
-  svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
   apr_array_header_t *list = NULL;
   svn_dirent_t *the_dirent;
 
-  SVN_ERR(svn_ra_svn__write_cmd_stat(conn, pool, path, rev));
   SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess_baton, pool),
                                  N_("'stat' not implemented")));
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "(?l)", &list));
@@ -1957,6 +2023,346 @@ static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
+                                const char *path, svn_revnum_t rev,
+                                svn_dirent_t **dirent, apr_pool_t *pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+
+  SVN_ERR(svn_ra_svn__write_cmd_stat(sess_baton->conn, pool, path, rev));
+  return svn_error_trace(read_stat_response(sess_baton, dirent, pool));
+}
+
+/* The maximum number of commands and the maximum number of bytes that
+ * run_pipelined() sends ahead of their responses.  All of that must fit
+ * into the socket buffers even while the server is busy sending responses
+ * and does not read from the connection.  Otherwise, both sides might
+ * block on writing.  A single command is always sent, however large. */
+#define MAX_PIPELINED_COMMANDS 32
+#define MAX_PIPELINED_BYTES 8192
+
+/* Callback type used by run_pipelined().  Send the command for, or read
+ * the response to, the IDX-th element of the batch described by BATON
+ * over SESS_BATON's connection.  Use SCRATCH_POOL for temporaries. */
+typedef svn_error_t *(*pipeline_func_t)(svn_ra_svn__session_baton_t *sess_baton,
+                                        void *baton,
+                                        int idx,
+                                        apr_pool_t *scratch_pool);
+
+/* Return TRUE, if ERR indicates that the connection is broken or out of
+ * sync, i.e. we cannot expect to read any further command responses. */
+static svn_boolean_t is_connection_error(svn_error_t *err)
+{
+  return svn_error_find_cause(err, SVN_ERR_RA_SVN_CONNECTION_CLOSED)
+      || svn_error_find_cause(err, SVN_ERR_RA_SVN_IO_ERROR)
+      || svn_error_find_cause(err, SVN_ERR_RA_SVN_MALFORMED_DATA);
+}
+
+/* Execute COUNT independent commands on SESS_BATON's connection, sending
+ * them with WRITE_FUNC and reading their responses with READ_FUNC, both
+ * being called with BATON.  Don't wait for a response before sending
+ * the next command, i.e. keep up to MAX_PIPELINED_COMMANDS and up to
+ * about MAX_PIPELINED_BYTES in flight.
+ *
+ * Pipelined commands will not trigger an authentication exchange.  If the
+ * server rejected one of them because it would have needed one, send it
+ * again without pipelining once all others have been processed.
+ *
+ * If any command fails, process the remaining responses that are in
+ * flight and return the error.  Return SVN_ERR_RA_NOT_IMPLEMENTED if the
+ * server does not support pipelining.  Use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *run_pipelined(svn_ra_svn__session_baton_t *sess_baton,
+                                  int count,
+                                  pipeline_func_t write_func,
+                                  pipeline_func_t read_func,
+                                  void *baton,
+                                  apr_pool_t *scratch_pool)
+{
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_array_header_t *retries = apr_array_make(scratch_pool, 0, sizeof(int));
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int sent = 0;
+  int received = 0;
+  int i;
+
+  /* Sizes of the commands in flight, indexed by their number modulo
+     MAX_PIPELINED_COMMANDS, and their sum. */
+  apr_off_t command_size[MAX_PIPELINED_COMMANDS];
+  apr_off_t bytes_in_flight = 0;
+
+  if (! svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_PIPELINED_READS))
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support pipelined commands"));
+
+  while (received < sent || (!err && sent < count))
+    {
+      svn_error_t *read_err;
+
+      svn_pool_clear(iterpool);
+
+      /* Keep the pipeline filled, unless we are only draining it. */
+      while (   !err && sent < count
+             && sent - received < MAX_PIPELINED_COMMANDS
+             && (sent == received || bytes_in_flight < MAX_PIPELINED_BYTES))
+        {
+          /* Everything written so far, whether flushed or still
+             buffered. */
+          apr_off_t start = sess_baton->bytes_written + conn->write_pos;
+          apr_off_t size;
+
+          SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "w!",
+                                          "pipelined"));
+          SVN_ERR(write_func(sess_baton, baton, sent, iterpool));
+          SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "!"));
+
+          size = sess_baton->bytes_written + conn->write_pos - start;
+          command_size[sent % MAX_PIPELINED_COMMANDS] = size;
+          bytes_in_flight += size;
+          ++sent;
+        }
+
+      /* Reading will flush the commands written above. */
+      read_err = read_func(sess_baton, baton, received, iterpool);
+      if (read_err)
+        {
+          if (is_connection_error(read_err))
+            return svn_error_compose_create(err, read_err);
+
+          if (svn_error_find_cause(read_err, SVN_ERR_RA_SVN_AUTH_REQUIRED))
+            {
+              APR_ARRAY_PUSH(retries, int) = received;
+              svn_error_clear(read_err);
+            }
+          else
+            {
+              err = svn_error_compose_create(err, read_err);
+            }
+        }
+
+      bytes_in_flight -= command_size[received % MAX_PIPELINED_COMMANDS];
+      ++received;
+    }
+
+  SVN_ERR(err);
+
+  /* Give the server a chance to request authentication. */
+  for (i = 0; i < retries->nelts; ++i)
+    {
+      int idx = APR_ARRAY_IDX(retries, i, int);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(write_func(sess_baton, baton, idx, iterpool));
+      SVN_ERR(read_func(sess_baton, baton, idx, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton type used with run_pipelined() by the *_many functions below.
+ * Fields that are not used by the respective function will be NULL. */
+typedef struct many_baton_t
+{
+  /* Paths to process (const char *) and the revision to use. */
+  const apr_array_header_t *paths;
+  svn_revnum_t revision;
+
+  /* Contents streams per path (svn_stream_t *) for get_file_many. */
+  const apr_array_header_t *streams;
+
+  /* Directory entries to request for get_dir_many. */
+  apr_uint32_t dirent_fields;
+
+  /* Results, mapping the path to the dirent, directory entries and
+   * properties, respectively.  The latter two are NULL if not wanted. */
+  apr_hash_t *dirents;
+  apr_hash_t *props;
+
+  /* Pool to allocate the results in. */
+  apr_pool_t *pool;
+} many_baton_t;
+
+/* Implements pipeline_func_t, sending a "stat" command. */
+static svn_error_t *write_stat_many(svn_ra_svn__session_baton_t *sess_baton,
+                                    void *baton,
+                                    int idx,
+                                    apr_pool_t *scratch_pool)
+{
+  many_baton_t *b = baton;
+
+  return svn_error_trace(svn_ra_svn__write_cmd_stat(sess_baton->conn,
+                           scratch_pool,
+                           APR_ARRAY_IDX(b->paths, idx, const char *),
+                           b->revision));
+}
+
+/* Implements pipeline_func_t, reading a "stat" response. */
+static svn_error_t *read_stat_many(svn_ra_svn__session_baton_t *sess_baton,
+                                   void *baton,
+                                   int idx,
+                                   apr_pool_t *scratch_pool)
+{
+  many_baton_t *b = baton;
+  svn_dirent_t *dirent;
+
+  SVN_ERR(read_stat_response(sess_baton, &dirent, b->pool));
+  if (dirent)
+    svn_hash_sets(b->dirents, APR_ARRAY_IDX(b->paths, idx, const char *),
+                  dirent);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *ra_svn_stat_many(svn_ra_session_t *session,
+                                     const apr_array_header_t *paths,
+                                     svn_revnum_t rev,
+                                     apr_hash_t **dirents,
+                                     apr_pool_t *pool)
+{
+  many_baton_t b = { 0 };
+
+  b.paths = paths;
+  b.revision = rev;
+  b.dirents = svn_hash__make(pool);
+  b.pool = pool;
+
+  SVN_ERR(run_pipelined(session->priv, paths->nelts, write_stat_many,
+                        read_stat_many, &b, pool));
+
+  *dirents = b.dirents;
+  return SVN_NO_ERROR;
+}
+
+/* Return the contents stream for the IDX-th path in B. */
+static svn_stream_t *many_stream(many_baton_t *b,
+                                 int idx)
+{
+  return b->streams ? APR_ARRAY_IDX(b->streams, idx, svn_stream_t *) : NULL;
+}
+
+/* Implements pipeline_func_t, sending a "get-file" command. */
+static svn_error_t *write_get_file_many(
+                        svn_ra_svn__session_baton_t *sess_baton,
+                        void *baton,
+                        int idx,
+                        apr_pool_t *scratch_pool)
+{
+  many_baton_t *b = baton;
+
+  return svn_error_trace(svn_ra_svn__write_cmd_get_file(sess_baton->conn,
+                           scratch_pool,
+                           APR_ARRAY_IDX(b->paths, idx, const char *),
+                           b->revision, (b->props != NULL),
+                           (many_stream(b, idx) != NULL)));
+}
+
+/* Implements pipeline_func_t, reading a "get-file" response. */
+static svn_error_t *read_get_file_many(svn_ra_svn__session_baton_t *sess_baton,
+                                       void *baton,
+                                       int idx,
+                                       apr_pool_t *scratch_pool)
+{
+  many_baton_t *b = baton;
+  const char *path = APR_ARRAY_IDX(b->paths, idx, const char *);
+  apr_hash_t *props;
+
+  SVN_ERR(read_get_file_response(sess_baton, path, many_stream(b, idx), NULL,
+                                 b->props ? &props : NULL, b->pool));
+  if (b->props)
+    svn_hash_sets(b->props, path, props);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *ra_svn_get_file_many(svn_ra_session_t *session,
+                                         const apr_array_header_t *paths,
+                                         svn_revnum_t rev,
+                                         const apr_array_header_t *streams,
+                                         apr_hash_t **props,
+                                         apr_pool_t *pool)
+{
+  many_baton_t b = { 0 };
+
+  b.paths = paths;
+  b.revision = rev;
+  b.streams = streams;
+  b.props = props ? svn_hash__make(pool) : NULL;
+  b.pool = pool;
+
+  SVN_ERR(run_pipelined(session->priv, paths->nelts, write_get_file_many,
+                        read_get_file_many, &b, pool));
+
+  if (props)
+    *props = b.props;
+  return SVN_NO_ERROR;
+}
+
+/* Implements pipeline_func_t, sending a "get-dir" command. */
+static svn_error_t *write_get_dir_many(svn_ra_svn__session_baton_t *sess_baton,
+                                       void *baton,
+                                       int idx,
+                                       apr_pool_t *scratch_pool)
+{
+  many_baton_t *b = baton;
+
+  return svn_error_trace(write_get_dir(sess_baton->conn,
+                                       APR_ARRAY_IDX(b->paths, idx,
+                                                     const char *),
+                                       b->revision, (b->props != NULL),
+                                       (b->dirents != NULL),
+                                       b->dirent_fields, scratch_pool));
+}
+
+/* Implements pipeline_func_t, reading a "get-dir" response. */
+static svn_error_t *read_get_dir_many(svn_ra_svn__session_baton_t *sess_baton,
+                                      void *baton,
+                                      int idx,
+                                      apr_pool_t *scratch_pool)
+{
+  many_baton_t *b = baton;
+  const char *path = APR_ARRAY_IDX(b->paths, idx, const char *);
+  apr_hash_t *dirents, *props;
+
+  SVN_ERR(read_get_dir_response(sess_baton, b->dirents ? &dirents : NULL,
+                                NULL, b->props ? &props : NULL, b->pool));
+  if (b->dirents)
+    svn_hash_sets(b->dirents, path, dirents);
+  if (b->props)
+    svn_hash_sets(b->props, path, props);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *ra_svn_get_dir_many(svn_ra_session_t *session,
+                                        apr_hash_t **dirents,
+                                        apr_hash_t **props,
+                                        const apr_array_header_t *paths,
+                                        svn_revnum_t rev,
+                                        apr_uint32_t dirent_fields,
+                                        apr_pool_t *pool)
+{
+  many_baton_t b = { 0 };
+
+  b.paths = paths;
+  b.revision = rev;
+  b.dirent_fields = dirent_fields;
+  b.dirents = dirents ? svn_hash__make(pool) : NULL;
+  b.props = props ? svn_hash__make(pool) : NULL;
+  b.pool = pool;
+
+  SVN_ERR(run_pipelined(session->priv, paths->nelts, write_get_dir_many,
+                        read_get_dir_many, &b, pool));
+
+  if (dirents)
+    *dirents = b.dirents;
+  if (props)
+    *props = b.props;
+  return SVN_NO_ERROR;
+}
+
 
 static svn_error_t *ra_svn_get_locations(svn_ra_session_t *session,
                                          apr_hash_t **locations,
@@ -2923,7 +3329,12 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   ra_svn_replay_range,
   ra_svn_get_deleted_rev,
   ra_svn_register_editor_shim_callbacks,
-  ra_svn_get_inherited_props
+  ra_svn_get_inherited_props,
+  NULL /* get_commit_ev2 */,
+  NULL /* replay_range_ev2 */,
+  ra_svn_stat_many,
+  ra_svn_get_file_many,
+  ra_svn_get_dir_many
 };
 
 svn_error_t *
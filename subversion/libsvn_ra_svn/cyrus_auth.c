@@ -709,6 +709,14 @@ static svn_error_t *
 sasl_data_available_cb(void *baton, svn_boolean_t *data_available)
 {
   sasl_baton_t *sasl_baton = baton;
+
+  /* Data already decoded but not read yet will not show on the socket. */
+  if (sasl_baton->read_buf && sasl_baton->read_len > 0)
+    {
+      *data_available = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   return svn_error_trace(svn_ra_svn__stream_data_available(sasl_baton->stream,
                                                          data_available));
 }
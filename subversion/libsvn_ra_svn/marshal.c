@@ -206,23 +206,47 @@ svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
 
 /* --- WRITE BUFFER MANAGEMENT --- */
 
-/* Write data to socket or output file as appropriate. */
+/* Write the LEN1 bytes at DATA1 followed by the LEN2 bytes at DATA2 to
+ * socket or output file as appropriate.  As long as there is data left
+ * in both, send them together with a single vectored write.  This allows
+ * us to send large data blocks without copying them into the write buffer
+ * first.  DATA2 may be NULL if LEN2 is 0.
+ */
 static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
-                                    const char *data, apr_size_t len)
+                                    const char *data1, apr_size_t len1,
+                                    const char *data2, apr_size_t len2)
 {
-  const char *end = data + len;
+  apr_size_t len = len1 + len2;
   apr_size_t count;
   apr_pool_t *subpool = NULL;
   svn_ra_svn__session_baton_t *session = conn->session;
 
-  while (data < end)
+  while (len1 + len2 > 0)
     {
-      count = end - data;
-
       if (session && session->callbacks && session->callbacks->cancel_func)
         SVN_ERR((session->callbacks->cancel_func)(session->callbacks_baton));
 
-      SVN_ERR(svn_ra_svn__stream_write(conn->stream, data, &count));
+      if (len1 > 0 && len2 > 0)
+        {
+          struct iovec vec[2];
+
+          vec[0].iov_base = (void *)data1;
+          vec[0].iov_len = len1;
+          vec[1].iov_base = (void *)data2;
+          vec[1].iov_len = len2;
+          SVN_ERR(svn_ra_svn__stream_writev(conn->stream, vec, 2, &count));
+        }
+      else if (len1 > 0)
+        {
+          count = len1;
+          SVN_ERR(svn_ra_svn__stream_write(conn->stream, data1, &count));
+        }
+      else
+        {
+          count = len2;
+          SVN_ERR(svn_ra_svn__stream_write(conn->stream, data2, &count));
+        }
+
       if (count == 0)
         {
           if (!subpool)
@@ -231,7 +255,22 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
             svn_pool_clear(subpool);
           SVN_ERR(conn->block_handler(conn, subpool, conn->block_baton));
         }
-      data += count;
+
+      if (count < len1)
+        {
+          data1 += count;
+          len1 -= count;
+        }
+      else if (count > len1)
+        {
+          data2 += count - len1;
+          len2 -= count - len1;
+          len1 = 0;
+        }
+      else
+        {
+          len1 = 0;
+        }
 
       if (session)
         {
@@ -260,20 +299,24 @@ static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 
   /* Clear conn->write_pos first in case the block handler does a read. */
   conn->write_pos = 0;
-  SVN_ERR(writebuf_output(conn, pool, conn->write_buf, write_pos));
+  SVN_ERR(writebuf_output(conn, pool, conn->write_buf, write_pos, NULL, 0));
   return SVN_NO_ERROR;
 }
 
 static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                    const char *data, apr_size_t len)
 {
-  /* data >= 8k is sent immediately */
+  /* data >= 8k is sent immediately, together with any buffered data but
+     without copying it into the buffer */
   if (len >= sizeof(conn->write_buf) / 2)
     {
-      if (conn->write_pos > 0)
-        SVN_ERR(writebuf_flush(conn, pool));
+      apr_size_t write_pos = conn->write_pos;
 
-      return writebuf_output(conn, pool, data, len);
+      /* Clear conn->write_pos first in case the block handler does a
+         read. */
+      conn->write_pos = 0;
+      return writebuf_output(conn, pool, conn->write_buf, write_pos,
+                             data, len);
     }
 
   /* ensure room for the data to add */
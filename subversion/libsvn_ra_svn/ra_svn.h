@@ -192,6 +192,16 @@ svn_ra_svn__stream_t *svn_ra_svn__stream_create(svn_stream_t *in_stream,
 svn_error_t *svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
                                       const char *data, apr_size_t *len);
 
+/* Write the contents of the NVEC buffers in VEC to STREAM, returning
+ * the total number of bytes written in *LEN.  For socket streams, this
+ * is done in a single system call without copying the data.  Other
+ * streams may write only a part of the data.
+ */
+svn_error_t *svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                                       const struct iovec *vec,
+                                       int nvec,
+                                       apr_size_t *len);
+
 /* Read *LEN bytes from STREAM into DATA, returning the number of bytes
  * read in *LEN.
  */
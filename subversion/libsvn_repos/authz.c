@@ -35,7 +35,9 @@
 #include "svn_config.h"
 #include "svn_ctype.h"
 #include "private/svn_fspath.h"
+#include "private/svn_mutex.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_subr_private.h"
 #include "repos.h"
 
 
@@ -54,19 +56,6 @@ struct authz_lookup_baton {
   svn_repos_authz_access_t allow;
   /* Explicitly denied rights. */
   svn_repos_authz_access_t deny;
-
-  /* The rights required by the caller of the lookup. */
-  svn_repos_authz_access_t required_access;
-
-  /* The following are used exclusively in recursive lookups. */
-
-  /* The path in the repository (an fspath) to authorize. */
-  const char *repos_path;
-  /* repos_path prefixed by the repository name and a colon. */
-  const char *qualified_repos_path;
-
-  /* Whether, at the end of a recursive lookup, access is granted. */
-  svn_boolean_t access;
 };
 
 /* Information for the config enumeration functions called during the
@@ -77,11 +66,65 @@ struct authz_validate_baton {
                            enumerator, if any. */
 };
 
-/* Currently this structure is just a wrapper around a svn_config_t.
-   Please update authz_pool if you modify this structure. */
+/* The access rights that the rules of one section grant to or deny
+   a specific user. */
+typedef struct authz_rights_t
+{
+  svn_repos_authz_access_t allow;
+  svn_repos_authz_access_t deny;
+} authz_rights_t;
+
+/* The authz rules compiled for a specific user.  Only sections that
+   contain rules for that user are being kept. */
+typedef struct authz_user_rules_t
+{
+  /* Maps section names (const char *) to authz_rights_t *. */
+  apr_hash_t *sections;
+
+  /* Union of all rights denied by any of the SECTIONS.  If this does not
+     intersect with the required access, no subtree can deny it. */
+  svn_repos_authz_access_t any_deny;
+
+  /* The user these rules have been compiled for.  NULL for anonymous
+     access. */
+  const char *user;
+
+  /* The remaining members are protected by the MUTEX of the svn_authz_t.
+
+     Number of references to these rules, including the one held by the
+     rules cache while they are in it.  The rules get destroyed when this
+     drops to 0. */
+  int ref_count;
+
+  /* Value of the svn_authz_t's USE_COUNTER when these rules were last
+     looked up.  Used to find the least recently used rules. */
+  apr_uint64_t last_use;
+
+  /* Root pool containing these rules.  It has its own allocator, so
+     rules can be compiled without holding the svn_authz_t's MUTEX. */
+  apr_pool_t *pool;
+} authz_user_rules_t;
+
+/* Maximum number of users for which we keep compiled rules in an
+   svn_authz_t.  When more users show up, the least recently used rules
+   get dropped. */
+#define AUTHZ_MAX_COMPILED_USERS 64
+
+/* Authz objects are created by this file and authz_pool.c. */
 struct svn_authz_t
 {
+  /* The authz configuration, including the groups. */
   svn_config_t *cfg;
+
+  /* Compiled rules per user.  Maps user names to authz_user_rules_t *.
+     ANONYMOUS_RULES is the entry for anonymous access.  Both are being
+     filled lazily.  USE_COUNTER gets incremented for every lookup.
+     Access is serialized by MUTEX because authz objects may be shared
+     between threads. */
+  apr_hash_t *user_rules;
+  authz_user_rules_t *anonymous_rules;
+  apr_uint64_t use_counter;
+  svn_mutex__t *mutex;
 };
 
 
@@ -296,180 +339,358 @@ is_applicable_section(const char *path_spec,
 }
 
 
-/* Callback to parse a section and update the authz_baton if the
- * section denies access to the subtree the baton describes.
- */
+
+/*** Compiled rules. ***/
+
+/* Baton type used by authz_compile_section. */
+struct authz_compile_baton {
+  /* The authz configuration. */
+  svn_config_t *config;
+
+  /* The user to compile the rules for.  NULL for anonymous access. */
+  const char *user;
+
+  /* Rules being compiled; allocated in RESULT_POOL. */
+  authz_user_rules_t *rules;
+  apr_pool_t *result_pool;
+};
+
+/* Callback to evaluate the rules of path section SECTION_NAME for the
+   user given in the authz_compile_baton BATON once and to add the
+   outcome to the compiled rules.  Implements the
+   svn_config_section_enumerator2_t interface. */
 static svn_boolean_t
-authz_parse_section(const char *section_name, void *baton, apr_pool_t *pool)
+authz_compile_section(const char *section_name, void *baton,
+                      apr_pool_t *pool)
 {
-  struct authz_lookup_baton *b = baton;
-  svn_boolean_t conclusive;
+  struct authz_compile_baton *cb = baton;
+  struct authz_lookup_baton b = { 0 };
 
-  /* Does the section apply to us? */
-  if (!is_applicable_section(b->qualified_repos_path, section_name)
-      && !is_applicable_section(b->repos_path, section_name))
+  /* Only path sections are ever being looked at by the checks. */
+  if (section_name[0] != '/' && !strstr(section_name, ":/"))
     return TRUE;
 
-  /* Work out what this section grants. */
-  b->allow = b->deny = 0;
-  svn_config_enumerate2(b->config, section_name,
-                        authz_parse_line, b, pool);
+  b.config = cb->config;
+  b.user = cb->user;
+  svn_config_enumerate2(cb->config, section_name, authz_parse_line, &b,
+                        pool);
+
+  /* Sections without rules for this user never determine access. */
+  if (b.allow || b.deny)
+    {
+      authz_rights_t *rights = apr_palloc(cb->result_pool, sizeof(*rights));
+      rights->allow = b.allow;
+      rights->deny = b.deny;
+
+      svn_hash_sets(cb->rules->sections,
+                    apr_pstrdup(cb->result_pool, section_name), rights);
+      cb->rules->any_deny |= b.deny;
+    }
+
+  return TRUE;
+}
+
+/* Compile the rules in CFG for USER into *RULES_P, allocated in a new
+   root pool.  The result has a reference count of 0.  Use SCRATCH_POOL
+   for temporaries. */
+static void
+authz_compile_rules(authz_user_rules_t **rules_p,
+                    svn_config_t *cfg,
+                    const char *user,
+                    apr_pool_t *scratch_pool)
+{
+  apr_pool_t *result_pool
+    = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  struct authz_compile_baton baton;
+
+  baton.config = cfg;
+  baton.user = user;
+  baton.result_pool = result_pool;
+  baton.rules = apr_pcalloc(result_pool, sizeof(*baton.rules));
+  baton.rules->sections = svn_hash__make(result_pool);
+  baton.rules->user = user ? apr_pstrdup(result_pool, user) : NULL;
+  baton.rules->pool = result_pool;
+
+  svn_config_enumerate_sections2(cfg, authz_compile_section, &baton,
+                                 scratch_pool);
+
+  *rules_p = baton.rules;
+}
+
+/* Drop a reference to RULES and destroy them if that was the last one.
+
+   This function must be called while holding the svn_authz_t's MUTEX. */
+static svn_error_t *
+authz_release_rules_internal(authz_user_rules_t *rules)
+{
+  if (--rules->ref_count == 0)
+    svn_pool_destroy(rules->pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *RULES_P to the cached rules for USER in AUTHZ and add a reference
+   to them.  Set it to NULL if they have not been compiled yet.
+
+   This function must be called while holding AUTHZ->MUTEX. */
+static svn_error_t *
+authz_lookup_rules_internal(authz_user_rules_t **rules_p,
+                            svn_authz_t *authz,
+                            const char *user)
+{
+  *rules_p = user ? svn_hash_gets(authz->user_rules, user)
+                  : authz->anonymous_rules;
+  if (*rules_p)
+    {
+      (*rules_p)->ref_count++;
+      (*rules_p)->last_use = ++authz->use_counter;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the newly compiled RULES to the cache in AUTHZ, dropping the least
+   recently used user rules if the cache is full.  If another thread
+   added rules for the same user in the meantime, use those instead.
+   Set *RULES_P to the cached rules and add a reference to them.  Use
+   SCRATCH_POOL for temporaries.
+
+   This function must be called while holding AUTHZ->MUTEX. */
+static svn_error_t *
+authz_add_rules_internal(authz_user_rules_t **rules_p,
+                         svn_authz_t *authz,
+                         authz_user_rules_t *rules,
+                         apr_pool_t *scratch_pool)
+{
+  SVN_ERR(authz_lookup_rules_internal(rules_p, authz, rules->user));
+  if (*rules_p)
+    {
+      svn_pool_destroy(rules->pool);
+      return SVN_NO_ERROR;
+    }
 
-  /* Has the section explicitly determined an access? */
-  conclusive = authz_access_is_determined(b->allow, b->deny,
-                                          b->required_access);
+  if (rules->user)
+    {
+      if (apr_hash_count(authz->user_rules) >= AUTHZ_MAX_COMPILED_USERS)
+        {
+          authz_user_rules_t *oldest = NULL;
+          apr_hash_index_t *hi;
+
+          for (hi = apr_hash_first(scratch_pool, authz->user_rules);
+               hi;
+               hi = apr_hash_next(hi))
+            {
+              authz_user_rules_t *candidate = svn__apr_hash_index_val(hi);
+              if (!oldest || candidate->last_use < oldest->last_use)
+                oldest = candidate;
+            }
+
+          svn_hash_sets(authz->user_rules, oldest->user, NULL);
+          SVN_ERR(authz_release_rules_internal(oldest));
+        }
+
+      svn_hash_sets(authz->user_rules, rules->user, rules);
+    }
+  else
+    {
+      authz->anonymous_rules = rules;
+    }
 
-  /* Is access granted OR inconclusive? */
-  b->access = authz_access_is_granted(b->allow, b->deny,
-                                      b->required_access)
-    || !conclusive;
+  /* One reference for the cache and one for the caller. */
+  rules->ref_count = 2;
+  rules->last_use = ++authz->use_counter;
+  *rules_p = rules;
 
-  /* As long as access isn't conclusively denied, carry on. */
-  return b->access;
+  return SVN_NO_ERROR;
 }
 
+/* Set *RULES_P to the compiled rules for USER in AUTHZ, compiling them
+   if necessary.  The caller must release them with authz_release_rules()
+   when done.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+authz_get_user_rules(authz_user_rules_t **rules_p,
+                     svn_authz_t *authz,
+                     const char *user,
+                     apr_pool_t *scratch_pool)
+{
+  authz_user_rules_t *rules;
 
-/* Validate access to the given user for the given path.  This
- * function checks rules for exactly the given path, and first tries
- * to access a section specific to the given repository before falling
- * back to pan-repository rules.
+  SVN_MUTEX__WITH_LOCK(authz->mutex,
+                       authz_lookup_rules_internal(rules_p, authz, user));
+  if (*rules_p)
+    return SVN_NO_ERROR;
+
+  /* Compiling may take a while.  Don't block other lookups meanwhile. */
+  authz_compile_rules(&rules, authz->cfg, user, scratch_pool);
+
+  SVN_MUTEX__WITH_LOCK(authz->mutex,
+                       authz_add_rules_internal(rules_p, authz, rules,
+                                                scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Drop the reference to RULES in AUTHZ that authz_get_user_rules() gave
+   us. */
+static svn_error_t *
+authz_release_rules(svn_authz_t *authz,
+                    authz_user_rules_t *rules)
+{
+  SVN_MUTEX__WITH_LOCK(authz->mutex, authz_release_rules_internal(rules));
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup function destroying all rules in the rules cache of the
+   svn_authz_t given as DATA.  Nobody may be using them anymore. */
+static apr_status_t
+authz_rules_cache_cleanup(void *data)
+{
+  svn_authz_t *authz = data;
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(NULL, authz->user_rules); hi; hi = apr_hash_next(hi))
+    {
+      authz_user_rules_t *rules = svn__apr_hash_index_val(hi);
+      svn_pool_destroy(rules->pool);
+    }
+
+  if (authz->anonymous_rules)
+    svn_pool_destroy(authz->anonymous_rules->pool);
+
+  return APR_SUCCESS;
+}
+
+/* Validate access to the given user for the given path, using the
+ * user's compiled RULES.  This function checks rules for exactly the
+ * given path, and first tries to access a section specific to the given
+ * repository before falling back to pan-repository rules.
  *
  * Update *access_granted to inform the caller of the outcome of the
  * lookup.  Return a boolean indicating whether the access rights were
  * successfully determined.
  */
 static svn_boolean_t
-authz_get_path_access(svn_config_t *cfg, const char *repos_name,
-                      const char *path, const char *user,
-                      svn_repos_authz_access_t required_access,
-                      svn_boolean_t *access_granted,
-                      apr_pool_t *pool)
+compiled_get_path_access(authz_user_rules_t *rules, const char *repos_name,
+                         const char *path,
+                         svn_repos_authz_access_t required_access,
+                         svn_boolean_t *access_granted,
+                         apr_pool_t *pool)
 {
-  const char *qualified_path;
-  struct authz_lookup_baton baton = { 0 };
-
-  baton.config = cfg;
-  baton.user = user;
+  svn_repos_authz_access_t allow = svn_authz_none;
+  svn_repos_authz_access_t deny = svn_authz_none;
+  const authz_rights_t *rights;
 
   /* Try to locate a repository-specific block first. */
-  qualified_path = apr_pstrcat(pool, repos_name, ":", path, SVN_VA_NULL);
-  svn_config_enumerate2(cfg, qualified_path,
-                        authz_parse_line, &baton, pool);
+  rights = svn_hash_gets(rules->sections,
+                         apr_pstrcat(pool, repos_name, ":", path,
+                                     SVN_VA_NULL));
+  if (rights)
+    {
+      allow |= rights->allow;
+      deny |= rights->deny;
+    }
 
-  *access_granted = authz_access_is_granted(baton.allow, baton.deny,
-                                            required_access);
+  *access_granted = authz_access_is_granted(allow, deny, required_access);
 
   /* If the first test has determined access, stop now. */
-  if (authz_access_is_determined(baton.allow, baton.deny,
-                                 required_access))
+  if (authz_access_is_determined(allow, deny, required_access))
     return TRUE;
 
   /* No repository specific rule, try pan-repository rules. */
-  svn_config_enumerate2(cfg, path, authz_parse_line, &baton, pool);
+  rights = svn_hash_gets(rules->sections, path);
+  if (rights)
+    {
+      allow |= rights->allow;
+      deny |= rights->deny;
+    }
 
-  *access_granted = authz_access_is_granted(baton.allow, baton.deny,
-                                            required_access);
-  return authz_access_is_determined(baton.allow, baton.deny,
-                                    required_access);
+  *access_granted = authz_access_is_granted(allow, deny, required_access);
+  return authz_access_is_determined(allow, deny, required_access);
 }
 
-
 /* Validate access to the given user for the subtree starting at the
- * given path.  This function walks the whole authz file in search of
- * rules applying to paths in the requested subtree which deny the
- * requested access.
- *
- * As soon as one is found, or else when the whole ACL file has been
- * searched, return the updated authorization status.
+ * given path, using the user's compiled RULES.  Return FALSE as soon as
+ * a rule for a path in the subtree denies the requested access.
  */
 static svn_boolean_t
-authz_get_tree_access(svn_config_t *cfg, const char *repos_name,
-                      const char *path, const char *user,
-                      svn_repos_authz_access_t required_access,
-                      apr_pool_t *pool)
+compiled_get_tree_access(authz_user_rules_t *rules, const char *repos_name,
+                         const char *path,
+                         svn_repos_authz_access_t required_access,
+                         apr_pool_t *pool)
 {
-  struct authz_lookup_baton baton = { 0 };
+  const char *qualified_path;
+  apr_hash_index_t *hi;
 
-  baton.config = cfg;
-  baton.user = user;
-  baton.required_access = required_access;
-  baton.repos_path = path;
-  baton.qualified_repos_path = apr_pstrcat(pool, repos_name,
-                                           ":", path, SVN_VA_NULL);
-  /* Default to access granted if no rules say otherwise. */
-  baton.access = TRUE;
-
-  svn_config_enumerate_sections2(cfg, authz_parse_section,
-                                 &baton, pool);
+  /* Without any denials, there is nothing to look for. */
+  if ((rules->any_deny & required_access) == svn_authz_none)
+    return TRUE;
 
-  return baton.access;
-}
+  qualified_path = apr_pstrcat(pool, repos_name, ":", path, SVN_VA_NULL);
+  for (hi = apr_hash_first(pool, rules->sections); hi; hi = apr_hash_next(hi))
+    {
+      const char *section_name = svn__apr_hash_index_key(hi);
+      const authz_rights_t *rights = svn__apr_hash_index_val(hi);
+
+      if (!is_applicable_section(qualified_path, section_name)
+          && !is_applicable_section(path, section_name))
+        continue;
+
+      if (!authz_access_is_granted(rights->allow, rights->deny,
+                                   required_access)
+          && authz_access_is_determined(rights->allow, rights->deny,
+                                        required_access))
+        return FALSE;
+    }
 
+  return TRUE;
+}
 
-/* Callback to parse sections of the configuration file, looking for
-   any kind of granted access.  Implements the
-   svn_config_section_enumerator2_t interface. */
+/* Check if the user of the compiled RULES has the REQUIRED_ACCESS to
+ * any path within the repository REPOS_NAME.  Return TRUE if so.  Use
+ * POOL for temporary allocations. */
 static svn_boolean_t
-authz_get_any_access_parser_cb(const char *section_name, void *baton,
-                               apr_pool_t *pool)
+compiled_get_any_access(authz_user_rules_t *rules, const char *repos_name,
+                        svn_repos_authz_access_t required_access,
+                        apr_pool_t *pool)
 {
-  struct authz_lookup_baton *b = baton;
+  const char *qualified_path = apr_pstrcat(pool, repos_name, ":/",
+                                           SVN_VA_NULL);
+  apr_size_t qualified_len = strlen(qualified_path);
+  apr_hash_index_t *hi;
 
-  /* Does the section apply to the query? */
-  if (section_name[0] == '/'
-      || strncmp(section_name, b->qualified_repos_path,
-                 strlen(b->qualified_repos_path)) == 0)
+  for (hi = apr_hash_first(pool, rules->sections); hi; hi = apr_hash_next(hi))
     {
-      b->allow = b->deny = svn_authz_none;
+      const char *section_name = svn__apr_hash_index_key(hi);
+      const authz_rights_t *rights = svn__apr_hash_index_val(hi);
 
-      svn_config_enumerate2(b->config, section_name,
-                            authz_parse_line, baton, pool);
-      b->access = authz_access_is_granted(b->allow, b->deny,
-                                          b->required_access);
+      if (section_name[0] != '/'
+          && strncmp(section_name, qualified_path, qualified_len) != 0)
+        continue;
 
-      /* Continue as long as we don't find a determined, granted access. */
-      return !(b->access
-               && authz_access_is_determined(b->allow, b->deny,
-                                             b->required_access));
+      if (authz_access_is_granted(rights->allow, rights->deny,
+                                  required_access)
+          && authz_access_is_determined(rights->allow, rights->deny,
+                                        required_access))
+        return TRUE;
     }
 
-  return TRUE;
+  return FALSE;
 }
 
-
-/* Walk through the authz CFG to check if USER has the REQUIRED_ACCESS
- * to any path within the REPOSITORY.  Return TRUE if so.  Use POOL
- * for temporary allocations. */
-static svn_boolean_t
-authz_get_any_access(svn_config_t *cfg, const char *repos_name,
-                     const char *user,
-                     svn_repos_authz_access_t required_access,
-                     apr_pool_t *pool)
+/* Initialize the compiled rules cache in AUTHZ, which is allocated in
+   POOL. */
+static svn_error_t *
+authz_init_rules_cache(svn_authz_t *authz,
+                       apr_pool_t *pool)
 {
-  struct authz_lookup_baton baton = { 0 };
+  authz->user_rules = svn_hash__make(pool);
+  authz->anonymous_rules = NULL;
+  authz->use_counter = 0;
+  apr_pool_cleanup_register(pool, authz, authz_rules_cache_cleanup,
+                            apr_pool_cleanup_null);
 
-  baton.config = cfg;
-  baton.user = user;
-  baton.required_access = required_access;
-  baton.access = FALSE; /* Deny access by default. */
-  baton.repos_path = "/";
-  baton.qualified_repos_path = apr_pstrcat(pool, repos_name,
-                                           ":/", SVN_VA_NULL);
-
-  /* We could have used svn_config_enumerate2 for "repos_name:/".
-   * However, this requires access for root explicitly (which the user
-   * may not always have). So we end up enumerating the sections in
-   * the authz CFG and stop on the first match with some access for
-   * this user. */
-  svn_config_enumerate_sections2(cfg, authz_get_any_access_parser_cb,
-                                 &baton, pool);
-
-  /* If walking the configuration was inconclusive, deny access. */
-  if (!authz_access_is_determined(baton.allow,
-                                  baton.deny, baton.required_access))
-    return FALSE;
-
-  return baton.access;
+  return svn_error_trace(svn_mutex__init(&authz->mutex, TRUE, FALSE, pool));
 }
 
 
@@ -935,7 +1156,7 @@ svn_repos__authz_read(svn_authz_t **authz_p, const char *path,
                       const char *groups_path, svn_boolean_t must_exist,
                       svn_boolean_t accept_urls, apr_pool_t *pool)
 {
-  svn_authz_t *authz = apr_palloc(pool, sizeof(*authz));
+  svn_authz_t *authz = apr_pcalloc(pool, sizeof(*authz));
 
   /* Load the authz file */
   if (accept_urls)
@@ -971,6 +1192,21 @@ svn_repos__authz_read(svn_authz_t **authz_p, const char *path,
 
   /* Make sure there are no errors in the configuration. */
   SVN_ERR(svn_repos__authz_validate(authz, pool));
+  SVN_ERR(authz_init_rules_cache(authz, pool));
+
+  *authz_p = authz;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__authz_create(svn_authz_t **authz_p,
+                        svn_config_t *cfg,
+                        apr_pool_t *pool)
+{
+  svn_authz_t *authz = apr_pcalloc(pool, sizeof(*authz));
+
+  authz->cfg = cfg;
+  SVN_ERR(authz_init_rules_cache(authz, pool));
 
   *authz_p = authz;
   return SVN_NO_ERROR;
@@ -994,7 +1230,7 @@ svn_error_t *
 svn_repos_authz_parse(svn_authz_t **authz_p, svn_stream_t *stream,
                       svn_stream_t *groups_stream, apr_pool_t *pool)
 {
-  svn_authz_t *authz = apr_palloc(pool, sizeof(*authz));
+  svn_authz_t *authz = apr_pcalloc(pool, sizeof(*authz));
 
   /* Parse the authz stream */
   SVN_ERR(svn_config_parse(&authz->cfg, stream, TRUE, TRUE, pool));
@@ -1011,29 +1247,29 @@ svn_repos_authz_parse(svn_authz_t **authz_p, svn_stream_t *stream,
 
   /* Make sure there are no errors in the configuration. */
   SVN_ERR(svn_repos__authz_validate(authz, pool));
+  SVN_ERR(authz_init_rules_cache(authz, pool));
 
   *authz_p = authz;
   return SVN_NO_ERROR;
 }
 
 
-svn_error_t *
-svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
-                             const char *path, const char *user,
-                             svn_repos_authz_access_t required_access,
-                             svn_boolean_t *access_granted,
-                             apr_pool_t *pool)
+/* Implement svn_repos_authz_check_access() on the compiled RULES. */
+static svn_error_t *
+authz_check_access(authz_user_rules_t *rules,
+                   const char *repos_name,
+                   const char *path,
+                   svn_repos_authz_access_t required_access,
+                   svn_boolean_t *access_granted,
+                   apr_pool_t *pool)
 {
   const char *current_path;
 
-  if (!repos_name)
-    repos_name = "";
-
   /* If PATH is NULL, check if the user has *any* access. */
   if (!path)
     {
-      *access_granted = authz_get_any_access(authz->cfg, repos_name,
-                                             user, required_access, pool);
+      *access_granted = compiled_get_any_access(rules, repos_name,
+                                                required_access, pool);
       return SVN_NO_ERROR;
     }
 
@@ -1044,11 +1280,8 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
   path = svn_fspath__canonicalize(path, pool);
   current_path = path;
 
-  while (!authz_get_path_access(authz->cfg, repos_name,
-                                current_path, user,
-                                required_access,
-                                access_granted,
-                                pool))
+  while (!compiled_get_path_access(rules, repos_name, current_path,
+                                   required_access, access_granted, pool))
     {
       /* Stop if the loop hits the repository root with no
          results. */
@@ -1067,8 +1300,29 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
      the entire authz config to see whether any child paths are denied
      to the requested user. */
   if (*access_granted && (required_access & svn_authz_recursive))
-    *access_granted = authz_get_tree_access(authz->cfg, repos_name, path,
-                                            user, required_access, pool);
+    *access_granted = compiled_get_tree_access(rules, repos_name, path,
+                                               required_access, pool);
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
+                             const char *path, const char *user,
+                             svn_repos_authz_access_t required_access,
+                             svn_boolean_t *access_granted,
+                             apr_pool_t *pool)
+{
+  authz_user_rules_t *rules;
+  svn_error_t *err;
+
+  if (!repos_name)
+    repos_name = "";
+
+  SVN_ERR(authz_get_user_rules(&rules, authz, user, pool));
+  err = authz_check_access(rules, repos_name, path, required_access,
+                           access_granted, pool);
+
+  return svn_error_trace(svn_error_compose_create(
+                           err, authz_release_rules(authz, rules)));
+}
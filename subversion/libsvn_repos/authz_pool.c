@@ -39,13 +39,6 @@
 
 #include "repos.h"
 
-/* Currently this structure is just a wrapper around a svn_config_t.
- */
-struct svn_authz_t
-{
-  svn_config_t *cfg;
-};
-
 /* The wrapper object structure that we store in the object pool.  It
  * combines the authz with the underlying config structures and their
  * identifying keys.
@@ -130,8 +123,8 @@ svn_repos__authz_pool_create(svn_repos__authz_pool_t **authz_pool,
   svn_object_pool__t *object_pool;
 
   /* there is no setter as we don't need to update existing authz */
-  SVN_ERR(svn_object_pool__create(&object_pool, getter, NULL, thread_safe,
-                                  pool));
+  SVN_ERR(svn_object_pool__create(&object_pool, getter, NULL, TRUE,
+                                  thread_safe, pool));
 
   result = apr_pcalloc(pool, sizeof(*result));
   result->object_pool = object_pool;
@@ -193,14 +186,11 @@ svn_repos__authz_pool_get(svn_authz_t **authz_p,
       return SVN_NO_ERROR;
     }
 
-  authz_ref->authz = apr_palloc(authz_ref_pool, sizeof(*authz_ref->authz));
-  authz_ref->authz->cfg = authz_ref->authz_cfg;
-
   if (groups_path)
     {
       /* Easy out: we prohibit local groups in the authz file when global
          groups are being used. */
-      if (svn_config_has_section(authz_ref->authz->cfg,
+      if (svn_config_has_section(authz_ref->authz_cfg,
                                  SVN_CONFIG_SECTION_GROUPS))
         return svn_error_createf(SVN_ERR_AUTHZ_INVALID_CONFIG, NULL,
                                  "Error reading authz file '%s' with "
@@ -211,12 +201,14 @@ svn_repos__authz_pool_get(svn_authz_t **authz_p,
 
       /* We simply need to add the [Groups] section to the authz config.
        */
-      svn_config__shallow_replace_section(authz_ref->authz->cfg,
+      svn_config__shallow_replace_section(authz_ref->authz_cfg,
                                           authz_ref->groups_cfg,
                                           SVN_CONFIG_SECTION_GROUPS);
     }
 
   /* Make sure there are no errors in the configuration. */
+  SVN_ERR(svn_repos__authz_create(&authz_ref->authz, authz_ref->authz_cfg,
+                                  authz_ref_pool));
   SVN_ERR(svn_repos__authz_validate(authz_ref->authz, authz_ref_pool));
 
   SVN_ERR(svn_object_pool__insert((void **)authz_p, authz_pool->object_pool,
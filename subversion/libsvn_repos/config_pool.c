@@ -441,7 +441,7 @@ svn_repos__config_pool_create(svn_repos__config_pool_t **config_pool,
   svn_repos__config_pool_t *result;
   svn_object_pool__t *object_pool;
 
-  SVN_ERR(svn_object_pool__create(&object_pool, getter, setter,
+  SVN_ERR(svn_object_pool__create(&object_pool, getter, setter, TRUE,
                                   thread_safe, pool));
 
   /* construct the config pool in our private ROOT_POOL to survive POOL
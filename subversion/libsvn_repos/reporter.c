@@ -36,6 +36,7 @@
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 
@@ -128,6 +129,16 @@ typedef struct report_baton_t
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
 
+  /* Optional check whether whole subtrees are readable, see
+     svn_repos__report_set_authz_subtree_func(). */
+  svn_repos_authz_callback_t authz_subtree_func;
+  void *authz_subtree_baton;
+
+  /* Target path of the directory currently being driven whose whole
+     subtree is known to be readable, or NULL.  Nodes below it need no
+     further authz checks. */
+  const char *readable_subtree;
+
   /* The spill-buffer holding the report. */
   svn_spillbuf_reader_t *reader;
 
@@ -746,6 +757,13 @@ static svn_error_t *
 check_auth(report_baton_t *b, svn_boolean_t *allowed, const char *path,
            apr_pool_t *pool)
 {
+  if (b->readable_subtree
+      && svn_fspath__skip_ancestor(b->readable_subtree, path))
+    {
+      *allowed = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   if (b->authz_read_func)
     return svn_error_trace(b->authz_read_func(allowed, b->t_root, path,
                                               b->authz_read_baton, pool));
@@ -753,6 +771,33 @@ check_auth(report_baton_t *b, svn_boolean_t *allowed, const char *path,
   return SVN_NO_ERROR;
 }
 
+/* If B has a subtree authz check and we are not already within a readable
+   subtree, determine whether all of B->t_root/PATH is readable.  If so,
+   make PATH the readable subtree of B and set *ENTERED to TRUE.  In all
+   other cases, set *ENTERED to FALSE.  PATH must remain valid until the
+   caller resets B->readable_subtree. */
+static svn_error_t *
+enter_readable_subtree(svn_boolean_t *entered, report_baton_t *b,
+                       const char *path, apr_pool_t *pool)
+{
+  svn_boolean_t allowed;
+
+  *entered = FALSE;
+  if (!b->authz_subtree_func || b->readable_subtree)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(b->authz_subtree_func(svn_authz_read | svn_authz_recursive,
+                                &allowed, b->t_root, path,
+                                b->authz_subtree_baton, pool));
+  if (allowed)
+    {
+      b->readable_subtree = path;
+      *entered = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Create a dirent in *ENTRY for the given ROOT and PATH.  We use this to
    replace the source or target dirent when a report pathinfo tells us to
    change paths or revisions. */
@@ -1026,6 +1071,8 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 
   if (t_entry->kind == svn_node_dir)
     {
+      svn_boolean_t readable_subtree;
+
       if (related)
         SVN_ERR(b->editor->open_directory(e_path, dir_baton, s_rev, pool,
                                           &new_baton));
@@ -1034,9 +1081,13 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                                          SVN_INVALID_REVNUM, pool,
                                          &new_baton));
 
+      SVN_ERR(enter_readable_subtree(&readable_subtree, b, t_path, pool));
       SVN_ERR(delta_dirs(b, s_rev, s_path, t_path, new_baton, e_path,
                          info ? info->start_empty : FALSE,
                          wc_depth, requested_depth, pool));
+      if (readable_subtree)
+        b->readable_subtree = NULL;
+
       return svn_error_trace(b->editor->close_directory(new_baton, pool));
     }
   else
@@ -1078,6 +1129,88 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 #define DEPTH_BELOW_HERE(depth) ((depth) == svn_depth_immediates) ? \
                                  svn_depth_empty : (depth)
 
+/* The source, target and editor paths of a directory in delta_dirs().
+   Paths of the directory entries are derived from them using
+   join_entry_paths().  Typically, the source path is the same as the
+   target path and the editor path is a tail of the target path.  The
+   entry paths then share a single string, i.e. we need only one
+   allocation per entry instead of three. */
+typedef struct entry_paths_t
+{
+  /* Source directory path.  May be NULL. */
+  const char *s_path;
+
+  /* Target directory path. */
+  const char *t_path;
+
+  /* Editor directory path. */
+  const char *e_path;
+
+  /* TRUE, if S_PATH and T_PATH are the same. */
+  svn_boolean_t same_source;
+
+  /* If not negative, the editor path of any entry is the tail of its
+     target path that starts at this offset. */
+  apr_ssize_t e_offset;
+} entry_paths_t;
+
+/* Initialize *PATHS for the directory with source path S_PATH, target
+   path T_PATH and editor path E_PATH.  S_PATH may be NULL. */
+static void
+init_entry_paths(entry_paths_t *paths,
+                 const char *s_path,
+                 const char *t_path,
+                 const char *e_path)
+{
+  apr_size_t t_len = strlen(t_path);
+  apr_size_t e_len = strlen(e_path);
+
+  paths->s_path = s_path;
+  paths->t_path = t_path;
+  paths->e_path = e_path;
+  paths->same_source = s_path && strcmp(s_path, t_path) == 0;
+
+  if (e_len == 0)
+    paths->e_offset = t_path[1] == '\0' ? 1 : t_len + 1;
+  else if (t_len > e_len
+           && t_path[t_len - e_len - 1] == '/'
+           && strcmp(t_path + t_len - e_len, e_path) == 0)
+    paths->e_offset = t_len - e_len;
+  else
+    paths->e_offset = -1;
+}
+
+/* Set *T_FULLPATH and *E_FULLPATH to the target and editor paths of the
+   entry NAME in the directory described by PATHS.  If S_FULLPATH is not
+   NULL, set *S_FULLPATH to the entry's source path or to NULL if there is
+   no source directory.  The results may share memory and are allocated
+   in POOL. */
+static void
+join_entry_paths(const char **s_fullpath,
+                 const char **t_fullpath,
+                 const char **e_fullpath,
+                 const entry_paths_t *paths,
+                 const char *name,
+                 apr_pool_t *pool)
+{
+  *t_fullpath = svn_fspath__join(paths->t_path, name, pool);
+
+  if (paths->e_offset >= 0)
+    *e_fullpath = *t_fullpath + paths->e_offset;
+  else
+    *e_fullpath = svn_relpath_join(paths->e_path, name, pool);
+
+  if (s_fullpath == NULL)
+    return;
+
+  if (paths->same_source)
+    *s_fullpath = *t_fullpath;
+  else if (paths->s_path)
+    *s_fullpath = svn_fspath__join(paths->s_path, name, pool);
+  else
+    *s_fullpath = NULL;
+}
+
 /* Emit edits within directory DIR_BATON (with corresponding path
    E_PATH) with the changes from the directory S_REV/S_PATH to the
    directory B->t_rev/T_PATH.  S_PATH may be NULL if the entry does
@@ -1143,6 +1276,7 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
   apr_hash_index_t *hi;
   apr_pool_t *subpool = svn_pool_create(pool);
   apr_array_header_t *t_ordered_entries = NULL;
+  entry_paths_t paths;
   int i;
 
   /* Compare the property lists.  If we're starting empty, pass a NULL
@@ -1170,6 +1304,7 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 
       /* Iterate over the report information for this directory. */
       iterpool = svn_pool_create(subpool);
+      init_entry_paths(&paths, s_path, t_path, e_path);
 
       while (1)
         {
@@ -1200,10 +1335,9 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
               continue;
             }
 
-          e_fullpath = svn_relpath_join(e_path, name, iterpool);
-          t_fullpath = svn_fspath__join(t_path, name, iterpool);
+          join_entry_paths(&s_fullpath, &t_fullpath, &e_fullpath, &paths,
+                           name, iterpool);
           t_entry = svn_hash_gets(t_entries, name);
-          s_fullpath = s_path ? svn_fspath__join(s_path, name, iterpool) : NULL;
           s_entry = s_entries ? svn_hash_gets(s_entries, name) : NULL;
 
           /* The only special cases where we don't process the entry are
@@ -1252,7 +1386,7 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 
               if (svn_hash_gets(t_entries, s_entry->name) == NULL)
                 {
-                  const char *e_fullpath;
+                  const char *t_fullpath, *e_fullpath;
                   svn_revnum_t deleted_rev;
 
                   if (s_entry->kind == svn_node_file
@@ -1265,11 +1399,10 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                     continue;
 
                   /* There is no corresponding target entry, so delete. */
-                  e_fullpath = svn_relpath_join(e_path, s_entry->name, iterpool);
+                  join_entry_paths(NULL, &t_fullpath, &e_fullpath, &paths,
+                                   s_entry->name, iterpool);
                   SVN_ERR(svn_repos_deleted_rev(svn_fs_root_fs(b->t_root),
-                                                svn_fspath__join(t_path,
-                                                                 s_entry->name,
-                                                                 iterpool),
+                                                t_fullpath,
                                                 s_rev, b->t_rev,
                                                 &deleted_rev, iterpool));
 
@@ -1297,7 +1430,6 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
               /* We're making the working copy deeper, pretend the source
                  doesn't exist. */
               s_entry = NULL;
-              s_fullpath = NULL;
             }
           else
             {
@@ -1314,13 +1446,13 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
               /* Look for an entry with the same name in the source dirents. */
               s_entry = s_entries ?
                   svn_hash_gets(s_entries, t_entry->name) : NULL;
-              s_fullpath = s_entry ?
-                  svn_fspath__join(s_path, t_entry->name, iterpool) : NULL;
             }
 
           /* Compose the report, editor, and target paths for this entry. */
-          e_fullpath = svn_relpath_join(e_path, t_entry->name, iterpool);
-          t_fullpath = svn_fspath__join(t_path, t_entry->name, iterpool);
+          join_entry_paths(&s_fullpath, &t_fullpath, &e_fullpath, &paths,
+                           t_entry->name, iterpool);
+          if (s_entry == NULL)
+            s_fullpath = NULL;
 
           SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, t_fullpath,
                                t_entry, dir_baton, e_fullpath, NULL,
@@ -1342,7 +1474,7 @@ drive(report_baton_t *b, svn_revnum_t s_rev, path_info_t *info,
       apr_pool_t *pool)
 {
   const char *t_anchor, *s_fullpath;
-  svn_boolean_t allowed, info_is_set_path;
+  svn_boolean_t allowed, info_is_set_path, readable_subtree;
   svn_fs_root_t *s_root;
   const svn_fs_dirent_t *s_entry, *t_entry;
   void *root_baton;
@@ -1385,7 +1517,9 @@ drive(report_baton_t *b, svn_revnum_t s_rev, path_info_t *info,
   SVN_ERR(b->editor->open_root(b->edit_baton, s_rev, pool, &root_baton));
 
   /* If the anchor is the operand, diff the two directories; otherwise
-     update the operand within the anchor directory. */
+     update the operand within the anchor directory.  Either way, if the
+     whole edit is readable, we won't need any further authz checks. */
+  SVN_ERR(enter_readable_subtree(&readable_subtree, b, t_anchor, pool));
   if (!*b->s_operand)
     SVN_ERR(delta_dirs(b, s_rev, s_fullpath, b->t_path, root_baton,
                        "", info->start_empty, info->depth, b->requested_depth,
@@ -1606,6 +1740,9 @@ svn_repos_begin_report3(void **report_baton,
   b->edit_baton = edit_baton;
   b->authz_read_func = authz_read_func;
   b->authz_read_baton = authz_read_baton;
+  b->authz_subtree_func = NULL;
+  b->authz_subtree_baton = NULL;
+  b->readable_subtree = NULL;
   b->revision_infos = apr_hash_make(pool);
   b->pool = pool;
   b->reader = svn_spillbuf__reader_create(1000 /* blocksize */,
@@ -1617,3 +1754,15 @@ svn_repos_begin_report3(void **report_baton,
   *report_baton = b;
   return SVN_NO_ERROR;
 }
+
+void
+svn_repos__report_set_authz_subtree_func(
+  void *report_baton,
+  svn_repos_authz_callback_t authz_subtree_func,
+  void *authz_subtree_baton)
+{
+  report_baton_t *b = report_baton;
+
+  b->authz_subtree_func = authz_subtree_func;
+  b->authz_subtree_baton = authz_subtree_baton;
+}
@@ -1164,16 +1164,22 @@ svn_repos_hooks_setenv(svn_repos_t *repos,
                        const char *hooks_env_path,
                        apr_pool_t *scratch_pool)
 {
+  if (repos->hooks_env_pool)
+    svn_pool_clear(repos->hooks_env_pool);
+  else
+    repos->hooks_env_pool = svn_pool_create(repos->pool);
+
   if (hooks_env_path == NULL)
     repos->hooks_env_path = svn_dirent_join(repos->conf_path,
                                             SVN_REPOS__CONF_HOOKS_ENV,
-                                            repos->pool);
+                                            repos->hooks_env_pool);
   else if (!svn_dirent_is_absolute(hooks_env_path))
     repos->hooks_env_path = svn_dirent_join(repos->conf_path,
                                             hooks_env_path,
-                                            repos->pool);
+                                            repos->hooks_env_pool);
   else
-    repos->hooks_env_path = apr_pstrdup(repos->pool, hooks_env_path);
+    repos->hooks_env_path = apr_pstrdup(repos->hooks_env_pool,
+                                        hooks_env_path);
 
   return SVN_NO_ERROR;
 }
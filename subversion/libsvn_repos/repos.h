@@ -27,6 +27,7 @@
 #include <apr_hash.h>
 
 #include "svn_fs.h"
+#include "svn_config.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -128,8 +129,11 @@ struct svn_repos_t
   int format;
 
   /* The path to the repository's hooks enviroment file. If NULL, hooks run
-   * in an empty environment. */
+   * in an empty environment.  Allocated in HOOKS_ENV_POOL, which gets
+   * cleared by every svn_repos_hooks_setenv() call such that repository
+   * objects being reused for many sessions don't accumulate memory. */
   const char *hooks_env_path;
+  apr_pool_t *hooks_env_pool;
 
   /* The FS backend in use within this repository. */
   const char *fs_type;
@@ -382,6 +386,14 @@ svn_repos__authz_read(svn_authz_t **authz_p,
                       svn_boolean_t accept_urls,
                       apr_pool_t *pool);
 
+/* Set *AUTHZ_P to a new authz object for the already validated
+   configuration CFG, allocated in POOL.  CFG must remain unchanged for
+   the lifetime of *AUTHZ_P. */
+svn_error_t *
+svn_repos__authz_create(svn_authz_t **authz_p,
+                        svn_config_t *cfg,
+                        apr_pool_t *pool);
+
 /* Walk the configuration in AUTHZ looking for any errors. */
 svn_error_t *
 svn_repos__authz_validate(svn_authz_t *authz,
@@ -0,0 +1,230 @@
+/*
+ * repos_pool.c :  pool of repository objects
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+#include "svn_dirent_uri.h"
+#include "svn_error.h"
+#include "svn_fs.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_repos.h"
+
+#include "private/svn_object_pool.h"
+#include "private/svn_repos_private.h"
+#include "private/svn_string_private.h"
+
+#include "repos.h"
+
+/* Root data structure simply adding the FS configuration to the basic
+ * object pool.
+ */
+struct svn_repos__repos_pool_t
+{
+  /* svn_repos_t object storage */
+  svn_object_pool__t *object_pool;
+
+  /* FS configuration to use when opening repositories */
+  apr_hash_t *fs_config;
+};
+
+/* Files in the repository's "db" directory whose contents an svn_fs_t
+ * reads only once, when being opened.  Not all of them exist for every
+ * FS backend.
+ */
+static const char *const fs_state_files[] =
+  {
+    "uuid",       /* may be changed by "svnadmin setuuid" */
+    "fsfs.conf",
+    "fsx.conf",
+    NULL
+  };
+
+/* Append the last modification time and size of the file at PATH to
+ * KEY_STR, allocated in POOL.  Append zeros if the file does not exist.
+ */
+static svn_error_t *
+append_file_state(const char **key_str,
+                  const char *path,
+                  apr_pool_t *pool)
+{
+  apr_finfo_t finfo;
+  svn_error_t *err = svn_io_stat(&finfo, path, APR_FINFO_MTIME | APR_FINFO_SIZE,
+                                 pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      finfo.mtime = 0;
+      finfo.size = 0;
+    }
+  else
+    {
+      SVN_ERR(err);
+    }
+
+  *key_str = apr_psprintf(pool, "%s%" APR_TIME_T_FMT "/%" APR_OFF_T_FMT ":",
+                          *key_str, finfo.mtime, finfo.size);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the object pool key for the repository at PATH, allocated in
+ * POOL.  The key also contains the last modification time of the
+ * repository's format file such that repositories that got replaced
+ * on disk (e.g. by "svnadmin create" or "svnadmin hotcopy") will not
+ * be confused with the old instances.  Likewise, it contains the state
+ * of the fs_state_files, so changing e.g. the UUID or the FS
+ * configuration will not go unnoticed by the pooled instances.
+ */
+static svn_error_t *
+construct_key(svn_membuf_t **key,
+              const char *path,
+              apr_pool_t *pool)
+{
+  apr_time_t mtime;
+  const char *key_str;
+  const char *db_path = svn_dirent_join(path, SVN_REPOS__DB_DIR, pool);
+  apr_size_t len;
+  int i;
+
+  SVN_ERR(svn_io_file_affected_time(&mtime,
+                                    svn_dirent_join(path, SVN_REPOS__FORMAT,
+                                                    pool),
+                                    pool));
+  key_str = apr_psprintf(pool, "%" APR_TIME_T_FMT ":", mtime);
+  for (i = 0; fs_state_files[i]; ++i)
+    SVN_ERR(append_file_state(&key_str,
+                              svn_dirent_join(db_path, fs_state_files[i],
+                                              pool),
+                              pool));
+
+  key_str = apr_pstrcat(pool, key_str, path, SVN_VA_NULL);
+  len = strlen(key_str);
+
+  *key = apr_pcalloc(pool, sizeof(**key));
+  svn_membuf__create(*key, len, pool);
+  memcpy((*key)->data, key_str, len);
+  (*key)->size = len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_fs_warning_callback_t.  No-one may use the FS while it is
+ * unused in the pool; this just makes sure we don't call back into some
+ * previous user's (stale) baton.
+ */
+static void
+ignore_warning(void *baton,
+               svn_error_t *err)
+{
+}
+
+/* Cleanup function resetting the per-user state of the svn_repos_t given
+ * by BATON before it gets returned to the pool.
+ */
+static apr_status_t
+reset_repos(void *baton)
+{
+  svn_repos_t *repos = baton;
+
+  svn_error_clear(svn_fs_set_access(repos->fs, NULL));
+  svn_fs_set_warning_func(repos->fs, ignore_warning, NULL);
+  repos->client_capabilities = NULL;
+  repos->hooks_env_path = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* API implementation */
+
+svn_error_t *
+svn_repos__repos_pool_create(svn_repos__repos_pool_t **repos_pool,
+                             apr_hash_t *fs_config,
+                             svn_boolean_t thread_safe,
+                             apr_pool_t *pool)
+{
+  svn_repos__repos_pool_t *result;
+  svn_object_pool__t *object_pool;
+
+  /* repository objects must not be shared, hence use exclusive mode */
+  SVN_ERR(svn_object_pool__create(&object_pool, NULL, NULL, FALSE,
+                                  thread_safe, pool));
+
+  result = apr_pcalloc(pool, sizeof(*result));
+  result->object_pool = object_pool;
+  result->fs_config = fs_config;
+
+  *repos_pool = result;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__repos_pool_get(svn_repos_t **repos_p,
+                          svn_repos__repos_pool_t *repos_pool,
+                          const char *path,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_membuf_t *key;
+  apr_pool_t *repos_object_pool;
+  svn_repos_t *repos;
+  svn_error_t *err;
+
+  /* If we can't identify the repository, don't pool it.  svn_repos_open3
+     will provide a more meaningful error if PATH is not a repository. */
+  err = construct_key(&key, path, scratch_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      return svn_error_trace(svn_repos_open3(repos_p, path,
+                                             repos_pool->fs_config,
+                                             result_pool, scratch_pool));
+    }
+
+  SVN_ERR(svn_object_pool__lookup((void **)repos_p, repos_pool->object_pool,
+                                  key, NULL, result_pool));
+
+  if (*repos_p == NULL)
+    {
+      repos_object_pool
+        = svn_object_pool__new_wrapper_pool(repos_pool->object_pool);
+
+      err = svn_repos_open3(&repos, path, repos_pool->fs_config,
+                            repos_object_pool, scratch_pool);
+      if (err)
+        {
+          svn_pool_destroy(repos_object_pool);
+          return svn_error_trace(err);
+        }
+
+      SVN_ERR(svn_object_pool__insert((void **)repos_p,
+                                      repos_pool->object_pool, key, repos,
+                                      NULL, repos_object_pool, result_pool));
+    }
+
+  /* This will run before the reference gets released. */
+  apr_pool_cleanup_register(result_pool, *repos_p, reset_repos,
+                            apr_pool_cleanup_null);
+
+  return SVN_NO_ERROR;
+}
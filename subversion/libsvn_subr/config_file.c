@@ -940,6 +940,12 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              HTTP operation."                   NL
         "###   http-chunked-requests      Whether to use chunked transfer"   NL
         "###                              encoding for HTTP requests body."  NL
+        "###   http-http2                 Whether to offer HTTP/2 to https"  NL
+        "###                              servers, to send all requests of"  NL
+        "###                              an operation over one connection." NL
+        "###                              Ignored unless serf was built with"NL
+        "###                              HTTP/2 support, and when"          NL
+        "###                              http-max-connections is 2 or less." NL
         "###   neon-debug-mask            Debug mask for Neon HTTP library"  NL
         "###   ssl-authority-files        List of files, each of a trusted CA"
                                                                              NL
@@ -1343,6 +1349,18 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### returning an error.  The default is 10000, i.e. 10 seconds."    NL
         "### Longer values may be useful when exclusive locking is enabled." NL
         "# busy-timeout = 10000"                                             NL
+        "### Set to true to store newly added pristine (BASE) texts"         NL
+        "### compressed.  This roughly halves the size of the pristine store"NL
+        "### of text-heavy working copies at the cost of some CPU time."     NL
+        "### Working copies containing compressed pristines can't be used"   NL
+        "### by Subversion clients older than 1.9."                          NL
+        "# compress-pristines = false"                                       NL
+        "### Set to the path of a directory to share pristine texts with"    NL
+        "### other working copies using the same directory.  Texts are"      NL
+        "### shared as hard links, so the directory must be on the same"     NL
+        "### filesystem as the working copies, and checkouts reuse texts"    NL
+        "### other working copies already fetched when the server allows."   NL
+        "# shared-pristine-store ="                                          NL
         ;
 
       err = svn_io_file_open(&f, path,
@@ -70,6 +70,11 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_dep_compat.h"
 
+#ifdef HAVE_LINUX_FS_H
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
 #define SVN_SLEEP_ENV_VAR "SVN_I_LOVE_CORRUPTED_WORKING_COPIES_SO_DISABLE_SLEEP_FOR_TIMESTAMPS"
 
 /*
@@ -714,6 +719,52 @@ svn_io_read_link(svn_string_t **dest,
 }
 
 
+svn_error_t *
+svn_io__create_hardlink(const char *existing_abspath,
+                        const char *new_abspath,
+                        apr_pool_t *scratch_pool)
+{
+  apr_status_t status;
+#ifdef WIN32
+  const WCHAR *w_existing;
+  const WCHAR *w_new;
+
+  SVN_ERR(svn_io__utf8_to_unicode_longpath(&w_existing, existing_abspath,
+                                           scratch_pool));
+  SVN_ERR(svn_io__utf8_to_unicode_longpath(&w_new, new_abspath,
+                                           scratch_pool));
+
+  if (CreateHardLinkW(w_new, w_existing, NULL))
+    return SVN_NO_ERROR;
+
+  status = apr_get_os_error();
+#elif !defined(__OS2__)
+  const char *existing_apr;
+  const char *new_apr;
+  int rv;
+
+  SVN_ERR(cstring_from_utf8(&existing_apr, existing_abspath, scratch_pool));
+  SVN_ERR(cstring_from_utf8(&new_apr, new_abspath, scratch_pool));
+
+  do {
+    rv = link(existing_apr, new_apr);
+  } while (rv == -1 && APR_STATUS_IS_EINTR(apr_get_os_error()));
+
+  if (rv == 0)
+    return SVN_NO_ERROR;
+
+  status = apr_get_os_error();
+#else
+  status = APR_ENOTIMPL;
+#endif
+
+  return svn_error_wrap_apr(status, _("Can't create hard link '%s' to '%s'"),
+                            svn_dirent_local_style(new_abspath, scratch_pool),
+                            svn_dirent_local_style(existing_abspath,
+                                                   scratch_pool));
+}
+
+
 svn_error_t *
 svn_io_copy_link(const char *src,
                  const char *dst,
@@ -830,6 +881,147 @@ copy_contents(apr_file_t *from_file,
   /* NOTREACHED */
 }
 
+/* Try to make TO_FILE share FROM_FILE's data blocks using the FICLONE
+ * ioctl, which is supported by copy-on-write filesystems like btrfs and
+ * XFS.  On success, set *CLONED to TRUE.  If the filesystem (or platform)
+ * doesn't support cloning, set *CLONED to FALSE and return APR_SUCCESS.
+ */
+static apr_status_t
+clone_contents(svn_boolean_t *cloned,
+               apr_file_t *from_file,
+               apr_file_t *to_file)
+{
+#ifdef FICLONE
+  apr_os_file_t from_fd, to_fd;
+
+  apr_os_file_get(&from_fd, from_file);
+  apr_os_file_get(&to_fd, to_file);
+
+  if (ioctl(to_fd, FICLONE, from_fd) == 0)
+    {
+      *cloned = TRUE;
+      return APR_SUCCESS;
+    }
+
+  /* Not a cloning filesystem, or source and target live on
+     different filesystems.  Anything else is a real error. */
+  if (errno != EOPNOTSUPP && errno != ENOTTY && errno != EXDEV
+      && errno != EINVAL && errno != ENOSYS && errno != EPERM)
+    return apr_get_os_error();
+#endif
+
+  *cloned = FALSE;
+  return APR_SUCCESS;
+}
+
+/* Transfer the contents of FROM_FILE to TO_FILE inside the kernel using
+ * copy_file_range(), which some filesystems implement by sharing extents.
+ * Set *COPIED to TRUE if that succeeded.  If the kernel can't do that for
+ * this pair of files, set *COPIED to FALSE and return APR_SUCCESS.
+ *
+ * Both files are expected to be positioned at their start; the OS file
+ * positions will have been advanced on return.  Use CANCEL_FUNC and
+ * CANCEL_BATON between chunks.
+ */
+static svn_error_t *
+kernel_copy_contents(svn_boolean_t *copied,
+                     apr_file_t *from_file,
+                     apr_file_t *to_file,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton)
+{
+#ifdef HAVE_COPY_FILE_RANGE
+  apr_os_file_t from_fd, to_fd;
+  svn_boolean_t first = TRUE;
+
+  apr_os_file_get(&from_fd, from_file);
+  apr_os_file_get(&to_fd, to_file);
+
+  while (TRUE)
+    {
+      /* Large enough to make the per-call overhead irrelevant, small
+         enough to allow cancellation during multi-GB copies. */
+      ssize_t done = copy_file_range(from_fd, NULL, to_fd, NULL,
+                                     64 * SVN__STREAM_CHUNK_SIZE, 0);
+      if (done < 0)
+        {
+          /* Unsupported kernel, filesystem or file pairing.  As long as
+             nothing has been written, the caller may still copy. */
+          if (first && (errno == ENOSYS || errno == EXDEV
+                        || errno == EOPNOTSUPP || errno == EINVAL))
+            break;
+
+          return svn_error_wrap_apr(apr_get_os_error(), NULL);
+        }
+
+      if (done == 0)
+        {
+          *copied = TRUE;
+          return SVN_NO_ERROR;
+        }
+
+      first = FALSE;
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+    }
+#endif
+
+  *copied = FALSE;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_io__copy_file_contents(svn_filesize_t *shared_bytes,
+                           apr_file_t *from_file,
+                           apr_file_t *to_file,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool)
+{
+  svn_boolean_t done;
+  apr_status_t status;
+
+  *shared_bytes = 0;
+
+  status = clone_contents(&done, from_file, to_file);
+  if (status)
+    {
+      const char *fname;
+
+      SVN_ERR(svn_io_file_name_get(&fname, from_file, scratch_pool));
+      return svn_error_wrap_apr(status, _("Can't clone '%s'"),
+                                svn_dirent_local_style(fname, scratch_pool));
+    }
+
+  if (done)
+    {
+      apr_finfo_t finfo;
+
+      SVN_ERR(svn_io_file_info_get(&finfo, APR_FINFO_SIZE, from_file,
+                                   scratch_pool));
+      *shared_bytes = finfo.size;
+
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(kernel_copy_contents(&done, from_file, to_file,
+                               cancel_func, cancel_baton));
+  if (done)
+    return SVN_NO_ERROR;
+
+  status = copy_contents(from_file, to_file, scratch_pool);
+  if (status)
+    {
+      const char *fname;
+
+      SVN_ERR(svn_io_file_name_get(&fname, from_file, scratch_pool));
+      return svn_error_wrap_apr(status, _("Can't copy '%s'"),
+                                svn_dirent_local_style(fname, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_io_copy_file(const char *src,
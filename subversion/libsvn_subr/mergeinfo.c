@@ -32,8 +32,10 @@
 #include "svn_error_codes.h"
 #include "svn_string.h"
 #include "svn_mergeinfo.h"
+#include "private/svn_atomic.h"
 #include "private/svn_fspath.h"
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
@@ -633,13 +635,17 @@ svn_rangelist__combine_adjacent_ranges(svn_rangelist_t *rangelist,
                                        apr_pool_t *scratch_pool)
 {
   int i;
+  int last = 0;
+  svn_merge_range_t **ranges = (svn_merge_range_t **)rangelist->elts;
   svn_merge_range_t *range, *lastrange;
 
-  lastrange = APR_ARRAY_IDX(rangelist, 0, svn_merge_range_t *);
+  lastrange = ranges[0];
 
+  /* Compact RANGELIST in place, i.e. LAST is the index of the last range
+     kept so far.  This is a single pass even if many ranges combine. */
   for (i = 1; i < rangelist->nelts; i++)
     {
-      range = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+      range = ranges[i];
       if (lastrange->start <= range->end
           && range->start <= lastrange->end)
         {
@@ -666,13 +672,16 @@ svn_rangelist__combine_adjacent_ranges(svn_rangelist_t *rangelist,
           if (lastrange->inheritable == range->inheritable)
             {
               lastrange->end = MAX(range->end, lastrange->end);
-              svn_sort__array_delete(rangelist, i, 1);
-              i--;
+              continue;
             }
         }
-      lastrange = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+
+      ranges[++last] = range;
+      lastrange = range;
     }
 
+  svn_sort__array_delete(rangelist, last + 1, rangelist->nelts - last - 1);
+
   return SVN_NO_ERROR;
 }
 
@@ -763,15 +772,18 @@ parse_top(const char **input, const char *end, svn_mergeinfo_t hash,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_mergeinfo_parse(svn_mergeinfo_t *mergeinfo,
-                    const char *input,
-                    apr_pool_t *pool)
+/* Parse the LEN bytes of mergeinfo in INPUT into *MERGEINFO, allocated
+   in POOL.  This is svn_mergeinfo_parse() without caching. */
+static svn_error_t *
+parse_mergeinfo(svn_mergeinfo_t *mergeinfo,
+                const char *input,
+                apr_size_t len,
+                apr_pool_t *pool)
 {
   svn_error_t *err;
 
   *mergeinfo = svn_hash__make(pool);
-  err = parse_top(&input, input + strlen(input), *mergeinfo, pool);
+  err = parse_top(&input, input + len, *mergeinfo, pool);
 
   /* Always return SVN_ERR_MERGEINFO_PARSE_ERROR as the topmost error. */
   if (err && err->apr_err != SVN_ERR_MERGEINFO_PARSE_ERROR)
@@ -781,167 +793,234 @@ svn_mergeinfo_parse(svn_mergeinfo_t *mergeinfo,
   return err;
 }
 
-/* Cleanup after svn_rangelist_merge2 when it modifies the ending range of
-   a single rangelist element in-place.
+/* Mergeinfo strings shorter than this are cheap enough to parse and will
+   not be cached. */
+#define MERGEINFO_CACHE_MIN_SIZE 256
 
-   If *RANGE_INDEX is not a valid element in RANGELIST do nothing.  Otherwise
-   ensure that RANGELIST[*RANGE_INDEX]->END does not adjoin or overlap any
-   subsequent ranges in RANGELIST.
+/* Once the cache contents exceed this total size in memory, we drop all
+   of them and start over. */
+#define MERGEINFO_CACHE_MAX_SIZE (16 * 1024 * 1024)
 
-   If overlap is found, then remove, modify, and/or add elements to RANGELIST
-   as per the invariants for rangelists documented in svn_mergeinfo.h.  If
-   RANGELIST[*RANGE_INDEX]->END adjoins a subsequent element then combine the
-   elements if their inheritability permits -- The inheritance of intersecting
-   and adjoining ranges is handled as per svn_mergeinfo_merge2.  Upon return
-   set *RANGE_INDEX to the index of the youngest element modified, added, or
-   adjoined to RANGELIST[*RANGE_INDEX].
+/* Process-wide cache of parsed mergeinfo.  Clients tend to parse the
+   same large mergeinfo strings over and over again. */
+typedef struct mergeinfo_cache_t
+{
+  /* Serializes access to all other members. */
+  svn_mutex__t *mutex;
 
-   Note: Adjoining rangelist elements are those where the end rev of the older
-   element is equal to the start rev of the younger element.
+  /* Pool for the cache contents, i.e. HASH and its entries. */
+  apr_pool_t *pool;
 
-   Any new elements inserted into RANGELIST are allocated in  RESULT_POOL.*/
-static void
-adjust_remaining_ranges(svn_rangelist_t *rangelist,
-                        int *range_index,
-                        apr_pool_t *result_pool)
+  /* Maps the mergeinfo strings to their parsed svn_mergeinfo_t. */
+  apr_hash_t *hash;
+
+  /* Estimated memory used by all entries in HASH, i.e. the mergeinfo
+     strings plus their parsed forms.  See mergeinfo_cache_entry_size(). */
+  apr_size_t size;
+
+  /* Statistics, see svn_mergeinfo__get_parse_cache_stats(). */
+  apr_uint64_t hits;
+  apr_uint64_t misses;
+} mergeinfo_cache_t;
+
+static volatile svn_atomic_t mergeinfo_cache_init_state = 0;
+static mergeinfo_cache_t mergeinfo_cache = { 0 };
+
+/* Initialize the global mergeinfo_cache.
+   Implements the init_func interface of svn_atomic__init_once(). */
+static svn_error_t *
+init_mergeinfo_cache(void *baton, apr_pool_t *scratch_pool)
 {
-  int i;
-  int starting_index;
-  int elements_to_delete = 0;
-  svn_merge_range_t *modified_range;
+  apr_pool_t *pool = svn_pool_create(NULL);
 
-  if (*range_index >= rangelist->nelts)
-    return;
+  SVN_ERR(svn_mutex__init(&mergeinfo_cache.mutex, TRUE, FALSE, pool));
+  mergeinfo_cache.pool = svn_pool_create(pool);
+  mergeinfo_cache.hash = apr_hash_make(mergeinfo_cache.pool);
+  mergeinfo_cache.size = 0;
+  mergeinfo_cache.hits = 0;
+  mergeinfo_cache.misses = 0;
 
-  starting_index = *range_index + 1;
-  modified_range = APR_ARRAY_IDX(rangelist, *range_index, svn_merge_range_t *);
+  return SVN_NO_ERROR;
+}
+
+/* Set *MERGEINFO to a copy of the cached mergeinfo for the LEN bytes in
+   INPUT, allocated in RESULT_POOL.  Set it to NULL if no such entry has
+   been cached.  Update the hit statistics. */
+static svn_error_t *
+mergeinfo_cache_get(svn_mergeinfo_t *mergeinfo,
+                    const char *input,
+                    apr_size_t len,
+                    apr_pool_t *result_pool)
+{
+  svn_mergeinfo_t cached = apr_hash_get(mergeinfo_cache.hash, input, len);
 
-  for (i = *range_index + 1; i < rangelist->nelts; i++)
+  if (cached)
     {
-      svn_merge_range_t *next_range = APR_ARRAY_IDX(rangelist, i,
-                                                    svn_merge_range_t *);
+      *mergeinfo = svn_mergeinfo_dup(cached, result_pool);
+      mergeinfo_cache.hits++;
+    }
+  else
+    {
+      *mergeinfo = NULL;
+      mergeinfo_cache.misses++;
+    }
 
-      /* If MODIFIED_RANGE doesn't adjoin or overlap the next range in
-         RANGELIST then we are finished. */
-      if (modified_range->end < next_range->start)
-        break;
+  return SVN_NO_ERROR;
+}
 
-      /* Does MODIFIED_RANGE adjoin NEXT_RANGE? */
-      if (modified_range->end == next_range->start)
-        {
-          if (modified_range->inheritable == next_range->inheritable)
-            {
-              /* Combine adjoining ranges with the same inheritability. */
-              modified_range->end = next_range->end;
-              elements_to_delete++;
-            }
-          else
-            {
-              /* Cannot join because inheritance differs. */
-              (*range_index)++;
-            }
-          break;
-        }
+/* Return an estimate of the memory that a cache entry for the LEN bytes
+   of mergeinfo text parsed into MERGEINFO uses.  The parsed form usually
+   takes several times the size of the text, so count it as allocated by
+   svn_mergeinfo_dup(). */
+static apr_size_t
+mergeinfo_cache_entry_size(svn_mergeinfo_t mergeinfo,
+                           apr_size_t len)
+{
+  /* The copy of the text, its entry in the cache's hash and the parsed
+     mergeinfo hash with its initial buckets. */
+  apr_size_t size = len + 1 + 5 * sizeof(void *) + 32 * sizeof(void *);
+  apr_hash_index_t *hi;
 
-      /* Alright, we know MODIFIED_RANGE overlaps NEXT_RANGE, but how? */
-      if (modified_range->end > next_range->end)
-        {
-          /* NEXT_RANGE is a proper subset of MODIFIED_RANGE and the two
-             don't share the same end range. */
-          if (modified_range->inheritable
-              || (modified_range->inheritable == next_range->inheritable))
-            {
-              /* MODIFIED_RANGE absorbs NEXT_RANGE. */
-              elements_to_delete++;
-            }
-          else
-            {
-              /* NEXT_RANGE is a proper subset MODIFIED_RANGE but
-                 MODIFIED_RANGE is non-inheritable and NEXT_RANGE is
-                 inheritable.  This means MODIFIED_RANGE is truncated,
-                 NEXT_RANGE remains, and the portion of MODIFIED_RANGE
-                 younger than NEXT_RANGE is added as a separate range:
-                  ______________________________________________
-                 |                                              |
-                 M                 MODIFIED_RANGE               N
-                 |                 (!inheritable)               |
-                 |______________________________________________|
-                                  |              |
-                                  O  NEXT_RANGE  P
-                                  | (inheritable)|
-                                  |______________|
-                                         |
-                                         V
-                  _______________________________________________
-                 |                |              |               |
-                 M MODIFIED_RANGE O  NEXT_RANGE  P   NEW_RANGE   N
-                 | (!inheritable) | (inheritable)| (!inheritable)|
-                 |________________|______________|_______________|
-              */
-              svn_merge_range_t *new_modified_range =
-                apr_palloc(result_pool, sizeof(*new_modified_range));
-              new_modified_range->start = next_range->end;
-              new_modified_range->end = modified_range->end;
-              new_modified_range->inheritable = FALSE;
-              modified_range->end = next_range->start;
-              (*range_index)+=2;
-              svn_sort__array_insert(rangelist, &new_modified_range,
-                                     *range_index);
-              /* Recurse with the new range. */
-              adjust_remaining_ranges(rangelist, range_index, result_pool);
-              break;
-            }
-        }
-      else if (modified_range->end == next_range->end)
-        {
-          /* NEXT_RANGE is a proper subset MODIFIED_RANGE and share
-             the same end range. */
-          if (modified_range->inheritable
-              || (modified_range->inheritable == next_range->inheritable))
-            {
-              /* MODIFIED_RANGE absorbs NEXT_RANGE. */
-              elements_to_delete++;
-            }
-          else
-            {
-              /* The intersection between MODIFIED_RANGE and NEXT_RANGE is
-                 absorbed by the latter. */
-              modified_range->end = next_range->start;
-              (*range_index)++;
-            }
-          break;
-        }
-      else
+  for (hi = apr_hash_first(NULL, mergeinfo); hi; hi = apr_hash_next(hi))
+    {
+      const char *path = svn__apr_hash_index_key(hi);
+      svn_rangelist_t *rangelist = svn__apr_hash_index_val(hi);
+
+      size += strlen(path) + 1 + 5 * sizeof(void *)
+            + sizeof(*rangelist)
+            + rangelist->nalloc * sizeof(svn_merge_range_t *)
+            + rangelist->nelts * sizeof(svn_merge_range_t);
+    }
+
+  return size;
+}
+
+/* Add a copy of MERGEINFO as the parsed form of the LEN bytes in INPUT
+   to the cache. */
+static svn_error_t *
+mergeinfo_cache_set(const char *input,
+                    apr_size_t len,
+                    svn_mergeinfo_t mergeinfo)
+{
+  apr_size_t entry_size;
+
+  if (apr_hash_get(mergeinfo_cache.hash, input, len) != NULL)
+    return SVN_NO_ERROR;
+
+  entry_size = mergeinfo_cache_entry_size(mergeinfo, len);
+  if (entry_size > MERGEINFO_CACHE_MAX_SIZE)
+    return SVN_NO_ERROR;
+
+  if (mergeinfo_cache.size + entry_size > MERGEINFO_CACHE_MAX_SIZE)
+    {
+      svn_pool_clear(mergeinfo_cache.pool);
+      mergeinfo_cache.hash = apr_hash_make(mergeinfo_cache.pool);
+      mergeinfo_cache.size = 0;
+    }
+
+  apr_hash_set(mergeinfo_cache.hash,
+               apr_pstrmemdup(mergeinfo_cache.pool, input, len), len,
+               svn_mergeinfo_dup(mergeinfo, mergeinfo_cache.pool));
+  mergeinfo_cache.size += entry_size;
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy the mergeinfo_cache statistics to *HITS and *MISSES. */
+static svn_error_t *
+mergeinfo_cache_get_stats(apr_uint64_t *hits,
+                          apr_uint64_t *misses)
+{
+  *hits = mergeinfo_cache.hits;
+  *misses = mergeinfo_cache.misses;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_mergeinfo_parse(svn_mergeinfo_t *mergeinfo,
+                    const char *input,
+                    apr_pool_t *pool)
+{
+  apr_size_t len = strlen(input);
+
+  if (len < MERGEINFO_CACHE_MIN_SIZE)
+    return svn_error_trace(parse_mergeinfo(mergeinfo, input, len, pool));
+
+  SVN_ERR(svn_atomic__init_once(&mergeinfo_cache_init_state,
+                                init_mergeinfo_cache, NULL, pool));
+
+  SVN_MUTEX__WITH_LOCK(mergeinfo_cache.mutex,
+                       mergeinfo_cache_get(mergeinfo, input, len, pool));
+  if (*mergeinfo)
+    return SVN_NO_ERROR;
+
+  /* Don't block other threads while parsing. */
+  SVN_ERR(parse_mergeinfo(mergeinfo, input, len, pool));
+  SVN_MUTEX__WITH_LOCK(mergeinfo_cache.mutex,
+                       mergeinfo_cache_set(input, len, *mergeinfo));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_mergeinfo__get_parse_cache_stats(apr_uint64_t *hits,
+                                     apr_uint64_t *misses)
+{
+  *hits = 0;
+  *misses = 0;
+
+  if (svn_atomic_read(&mergeinfo_cache_init_state) == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_atomic__init_once(&mergeinfo_cache_init_state,
+                                init_mergeinfo_cache, NULL, NULL));
+  SVN_MUTEX__WITH_LOCK(mergeinfo_cache.mutex,
+                       mergeinfo_cache_get_stats(hits, misses));
+
+  return SVN_NO_ERROR;
+}
+
+/* Append the range START-END with inheritability INHERITABLE to the first
+   *COUNT elements of RANGELIST and increment *COUNT accordingly.  If the
+   last of these elements adjoins the new range and has the same
+   inheritability, extend it instead.  Elements of RANGELIST beyond *COUNT
+   get overwritten; only if there are none left, allocate a new range in
+   RESULT_POOL. */
+static void
+append_merged_range(svn_rangelist_t *rangelist,
+                    int *count,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    svn_boolean_t inheritable,
+                    apr_pool_t *result_pool)
+{
+  svn_merge_range_t *range;
+
+  if (*count > 0)
+    {
+      range = APR_ARRAY_IDX(rangelist, *count - 1, svn_merge_range_t *);
+      if (range->end == start && range->inheritable == inheritable)
         {
-          /* NEXT_RANGE and MODIFIED_RANGE intersect but NEXT_RANGE is not
-             a proper subset of MODIFIED_RANGE, nor do the two share the
-             same end revision, i.e. they overlap. */
-          if (modified_range->inheritable == next_range->inheritable)
-            {
-              /* Combine overlapping ranges with the same inheritability. */
-              modified_range->end = next_range->end;
-              elements_to_delete++;
-            }
-          else if (modified_range->inheritable)
-            {
-              /* MODIFIED_RANGE absorbs the portion of NEXT_RANGE it overlaps
-                 and NEXT_RANGE is truncated. */
-              next_range->start = modified_range->end;
-              (*range_index)++;
-            }
-          else
-            {
-              /* NEXT_RANGE absorbs the portion of MODIFIED_RANGE it overlaps
-                 and MODIFIED_RANGE is truncated. */
-              modified_range->end = next_range->start;
-              (*range_index)++;
-            }
-          break;
+          range->end = end;
+          return;
         }
     }
 
-  if (elements_to_delete)
-    svn_sort__array_delete(rangelist, starting_index, elements_to_delete);
+  if (*count < rangelist->nelts)
+    {
+      range = APR_ARRAY_IDX(rangelist, *count, svn_merge_range_t *);
+    }
+  else
+    {
+      range = apr_palloc(result_pool, sizeof(*range));
+      APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = range;
+    }
+
+  range->start = start;
+  range->end = end;
+  range->inheritable = inheritable;
+  ++*count;
 }
 
 svn_error_t *
@@ -950,234 +1029,81 @@ svn_rangelist_merge2(svn_rangelist_t *rangelist,
                      apr_pool_t *result_pool,
                      apr_pool_t *scratch_pool)
 {
+  svn_merge_range_t *ranges;
+  int range_count = rangelist->nelts;
+  int count = 0;
   int i = 0;
   int j = 0;
+  svn_revnum_t pos = SVN_INVALID_REVNUM;
 
-  /* We may modify CHANGES, so make a copy in SCRATCH_POOL. */
-  changes = svn_rangelist_dup(changes, scratch_pool);
+  if (changes->nelts == 0)
+    return SVN_NO_ERROR;
 
-  while (i < rangelist->nelts && j < changes->nelts)
+  /* We overwrite the elements of RANGELIST with the result as we go, so
+     we need a copy of the original ranges.  A flat array will do. */
+  ranges = apr_palloc(scratch_pool, (range_count + 1) * sizeof(*ranges));
+  for (i = 0; i < range_count; i++)
+    ranges[i] = *APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+
+  /* Sweep over both lists in a single pass.  Everything up to POS has
+     been written to the result already.  In each iteration, we append
+     the next segment covered by the current range, the current change
+     or both.  A revision covered by both is inheritable in the result
+     if it is inheritable in either of them. */
+  i = 0;
+  while (i < range_count || j < changes->nelts)
     {
-      svn_merge_range_t *range =
-        APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
-      svn_merge_range_t *change =
-        APR_ARRAY_IDX(changes, j, svn_merge_range_t *);
-      int res = svn_sort_compare_ranges(&range, &change);
-
-      if (res == 0)
+      const svn_merge_range_t *range = i < range_count ? &ranges[i] : NULL;
+      const svn_merge_range_t *change
+        = j < changes->nelts
+        ? APR_ARRAY_IDX(changes, j, svn_merge_range_t *)
+        : NULL;
+      svn_revnum_t range_start, change_start, start, end;
+      svn_boolean_t in_range, in_change;
+
+      /* Skip ranges that have been processed completely. */
+      if (range && range->end <= pos)
         {
-          /* Only when merging two non-inheritable ranges is the result also
-             non-inheritable.  In all other cases ensure an inheritable
-             result. */
-          if (range->inheritable || change->inheritable)
-            range->inheritable = TRUE;
           i++;
-          j++;
-        }
-      else if (res < 0) /* CHANGE is younger than RANGE */
-        {
-          if (range->end < change->start)
-            {
-              /* RANGE is older than CHANGE and the two do not
-                 adjoin or overlap */
-              i++;
-            }
-          else if (range->end == change->start)
-            {
-              /* RANGE and CHANGE adjoin */
-              if (range->inheritable == change->inheritable)
-                {
-                  /* RANGE and CHANGE have the same inheritability so
-                     RANGE expands to absord CHANGE. */
-                  range->end = change->end;
-                  adjust_remaining_ranges(rangelist, &i, result_pool);
-                  j++;
-                }
-              else
-                {
-                  /* RANGE and CHANGE adjoin, but have different
-                     inheritability.  Since RANGE is older, just
-                     move on to the next RANGE. */
-                  i++;
-                }
-            }
-          else
-            {
-              /* RANGE and CHANGE overlap, but how? */
-              if ((range->inheritable == change->inheritable)
-                  || range->inheritable)
-                {
-                  /* If CHANGE is a proper subset of RANGE, it absorbs RANGE
-                      with no adjustment otherwise only the intersection is
-                      absorbed and CHANGE is truncated. */
-                  if (range->end >= change->end)
-                    j++;
-                  else
-                    change->start = range->end;
-                }
-              else
-                {
-                  /* RANGE is non-inheritable and CHANGE is inheritable. */
-                  if (range->start < change->start)
-                    {
-                      /* CHANGE absorbs intersection with RANGE and RANGE
-                         is truncated. */
-                      svn_merge_range_t *range_copy =
-                        svn_merge_range_dup(range, result_pool);
-                      range_copy->end = change->start;
-                      range->start = change->start;
-                      svn_sort__array_insert(rangelist, &range_copy, i++);
-                    }
-                  else
-                    {
-                      /* CHANGE and RANGE share the same start rev, but
-                         RANGE is considered older because its end rev
-                         is older. */
-                      range->inheritable = TRUE;
-                      change->start = range->end;
-                    }
-                }
-            }
+          continue;
         }
-      else /* res > 0, CHANGE is older than RANGE */
+      if (change && change->end <= pos)
         {
-          if (change->end < range->start)
-            {
-              /* CHANGE is older than RANGE and the two do not
-                 adjoin or overlap, so insert a copy of CHANGE
-                 into RANGELIST. */
-              svn_merge_range_t *change_copy =
-                svn_merge_range_dup(change, result_pool);
-              svn_sort__array_insert(rangelist, &change_copy, i++);
-              j++;
-            }
-          else if (change->end == range->start)
-            {
-              /* RANGE and CHANGE adjoin */
-              if (range->inheritable == change->inheritable)
-                {
-                  /* RANGE and CHANGE have the same inheritability so we
-                     can simply combine the two in place. */
-                  range->start = change->start;
-                  j++;
-                }
-              else
-                {
-                  /* RANGE and CHANGE have different inheritability so insert
-                     a copy of CHANGE into RANGELIST. */
-                  svn_merge_range_t *change_copy =
-                    svn_merge_range_dup(change, result_pool);
-                  svn_sort__array_insert(rangelist, &change_copy, i);
-                  j++;
-                }
-            }
-          else
-            {
-              /* RANGE and CHANGE overlap. */
-              if (range->inheritable == change->inheritable)
-                {
-                  /* RANGE and CHANGE have the same inheritability so we
-                     can simply combine the two in place... */
-                  range->start = change->start;
-                  if (range->end < change->end)
-                    {
-                      /* ...but if RANGE is expanded ensure that we don't
-                         violate any rangelist invariants. */
-                      range->end = change->end;
-                      adjust_remaining_ranges(rangelist, &i, result_pool);
-                    }
-                  j++;
-                }
-              else if (range->inheritable)
-                {
-                  if (change->start < range->start)
-                    {
-                      /* RANGE is inheritable so absorbs any part of CHANGE
-                         it overlaps.  CHANGE is truncated and the remainder
-                         inserted into RANGELIST. */
-                      svn_merge_range_t *change_copy =
-                        svn_merge_range_dup(change, result_pool);
-                      change_copy->end = range->start;
-                      change->start = range->start;
-                      svn_sort__array_insert(rangelist, &change_copy, i++);
-                    }
-                  else
-                    {
-                      /* CHANGE and RANGE share the same start rev, but
-                         CHANGE is considered older because CHANGE->END is
-                         older than RANGE->END. */
-                      j++;
-                    }
-                }
-              else
-                {
-                  /* RANGE is non-inheritable and CHANGE is inheritable. */
-                  if (change->start < range->start)
-                    {
-                      if (change->end == range->end)
-                        {
-                          /* RANGE is a proper subset of CHANGE and share the
-                             same end revision, so set RANGE equal to CHANGE. */
-                          range->start = change->start;
-                          range->inheritable = TRUE;
-                          j++;
-                        }
-                      else if (change->end > range->end)
-                        {
-                          /* RANGE is a proper subset of CHANGE and CHANGE has
-                             a younger end revision, so set RANGE equal to its
-                             intersection with CHANGE and truncate CHANGE. */
-                          range->start = change->start;
-                          range->inheritable = TRUE;
-                          change->start = range->end;
-                        }
-                      else
-                        {
-                          /* CHANGE and RANGE overlap. Set RANGE equal to its
-                             intersection with CHANGE and take the remainder
-                             of RANGE and insert it into RANGELIST. */
-                          svn_merge_range_t *range_copy =
-                            svn_merge_range_dup(range, result_pool);
-                          range_copy->start = change->end;
-                          range->start = change->start;
-                          range->end = change->end;
-                          range->inheritable = TRUE;
-                          svn_sort__array_insert(rangelist, &range_copy, ++i);
-                          j++;
-                        }
-                    }
-                  else
-                    {
-                      /* CHANGE and RANGE share the same start rev, but
-                         CHANGE is considered older because its end rev
-                         is older.
-
-                         Insert the intersection of RANGE and CHANGE into
-                         RANGELIST and then set RANGE to the non-intersecting
-                         portion of RANGE. */
-                      svn_merge_range_t *range_copy =
-                        svn_merge_range_dup(range, result_pool);
-                      range_copy->end = change->end;
-                      range_copy->inheritable = TRUE;
-                      range->start = change->end;
-                      svn_sort__array_insert(rangelist, &range_copy, i++);
-                      j++;
-                    }
-                }
-            }
+          j++;
+          continue;
         }
-    }
 
-  /* Copy any remaining elements in CHANGES into RANGELIST. */
-  for (; j < (changes)->nelts; j++)
-    {
-      svn_merge_range_t *change =
-        APR_ARRAY_IDX(changes, j, svn_merge_range_t *);
-      svn_merge_range_t *change_copy = svn_merge_range_dup(change,
-                                                           result_pool);
-      svn_sort__array_insert(rangelist, &change_copy, rangelist->nelts);
+      /* The segment starts at the first unprocessed revision of either. */
+      range_start = range ? MAX(range->start, pos) : SVN_INVALID_REVNUM;
+      change_start = change ? MAX(change->start, pos) : SVN_INVALID_REVNUM;
+      if (change && (!range || change_start < range_start))
+        start = change_start;
+      else
+        start = range_start;
+
+      in_range = range && range_start == start;
+      in_change = change && change_start == start;
+
+      /* It ends where either input ends or the other one begins. */
+      end = in_range ? range->end : change->end;
+      if (in_change)
+        end = MIN(end, change->end);
+      if (range && !in_range)
+        end = MIN(end, range_start);
+      if (change && !in_change)
+        end = MIN(end, change_start);
+
+      append_merged_range(rangelist, &count, start, end,
+                          (in_range && range->inheritable)
+                          || (in_change && change->inheritable),
+                          result_pool);
+      pos = end;
     }
 
+  /* Remove any left-over elements. */
+  if (count < rangelist->nelts)
+    svn_sort__array_delete(rangelist, count, rangelist->nelts - count);
+
   return SVN_NO_ERROR;
 }
 
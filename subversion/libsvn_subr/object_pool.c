@@ -37,6 +37,11 @@
 
 
 
+/* In exclusive mode, keep at most this many unused instances per key.
+ * Further instances get destroyed upon release.
+ */
+#define MAX_UNUSED_OBJECTS_PER_KEY 8
+
 /* A reference counting wrapper around the user-provided object.
  */
 typedef struct object_ref_t
@@ -57,6 +62,9 @@ typedef struct object_ref_t
 
   /* Number of references to this data struct */
   volatile svn_atomic_t ref_count;
+
+  /* In exclusive mode, the next unused instance for the same KEY. */
+  struct object_ref_t *next;
 } object_ref_t;
 
 
@@ -85,6 +93,10 @@ struct svn_object_pool__t
 
   /* the root pool owning this structure */
   apr_pool_t *pool;
+
+  /* if not set, objects will be handed out to at most one user at a time
+     (exclusive mode) */
+  svn_boolean_t share_objects;
   
   /* extractor and updater for the user object wrappers */
   svn_object_pool__getter_t getter;
@@ -123,9 +135,26 @@ remove_unused_objects(svn_object_pool__t *object_pool)
     {
       object_ref_t *object_ref = svn__apr_hash_index_val(hi);
 
+      /* in exclusive mode, all objects in the hash are unused */
+      if (!object_pool->share_objects)
+        {
+          apr_hash_set(object_pool->objects, object_ref->key.data,
+                       object_ref->key.size, NULL);
+          while (object_ref)
+            {
+              object_ref_t *next = object_ref->next;
+
+              svn_atomic_dec(&object_pool->object_count);
+              svn_atomic_dec(&object_pool->unused_count);
+              svn_pool_destroy(object_ref->pool);
+
+              object_ref = next;
+            }
+        }
+
       /* note that we won't hand out new references while access
          to the hash is serialized */
-      if (svn_atomic_read(&object_ref->ref_count) == 0)
+      else if (svn_atomic_read(&object_ref->ref_count) == 0)
         {
           apr_hash_set(object_pool->objects, object_ref->key.data,
                        object_ref->key.size, NULL);
@@ -139,6 +168,95 @@ remove_unused_objects(svn_object_pool__t *object_pool)
   svn_pool_destroy(subpool);
 }
 
+/* Make OBJECT_REF the first entry in the chain of unused objects for its
+ * key in OBJECT_REF->OBJECT_POOL.
+ *
+ * Requires external serialization on OBJECT_REF->OBJECT_POOL.
+ */
+static void
+push_unused_object(object_ref_t *object_ref)
+{
+  svn_object_pool__t *object_pool = object_ref->object_pool;
+
+  /* The hash key memory belongs to the first chain entry.  Hence, we must
+     re-insert the chain with the new head's key. */
+  object_ref->next = apr_hash_get(object_pool->objects, object_ref->key.data,
+                                  object_ref->key.size);
+  apr_hash_set(object_pool->objects, object_ref->key.data,
+               object_ref->key.size, NULL);
+  apr_hash_set(object_pool->objects, object_ref->key.data,
+               object_ref->key.size, object_ref);
+}
+
+/* Remove OBJECT_REF, the first entry in the chain of unused objects for
+ * its key, from that chain in OBJECT_REF->OBJECT_POOL.
+ *
+ * Requires external serialization on OBJECT_REF->OBJECT_POOL.
+ */
+static void
+pop_unused_object(object_ref_t *object_ref)
+{
+  svn_object_pool__t *object_pool = object_ref->object_pool;
+  object_ref_t *next = object_ref->next;
+
+  apr_hash_set(object_pool->objects, object_ref->key.data,
+               object_ref->key.size, NULL);
+  if (next)
+    apr_hash_set(object_pool->objects, next->key.data, next->key.size,
+                 next);
+
+  object_ref->next = NULL;
+}
+
+/* Return the number of unused objects in OBJECT_POOL for KEY, i.e. the
+ * length of its chain.  Exclusive mode only.
+ *
+ * Requires external serialization on OBJECT_POOL.
+ */
+static int
+count_unused_objects(svn_object_pool__t *object_pool,
+                     const svn_membuf_t *key)
+{
+  object_ref_t *object_ref = apr_hash_get(object_pool->objects, key->data,
+                                          key->size);
+  int count = 0;
+
+  for (; object_ref; object_ref = object_ref->next)
+    ++count;
+
+  return count;
+}
+
+/* Return OBJECT_REF to the chain of unused objects in exclusive mode.
+ * If there are enough unused instances for its key already, destroy it
+ * instead.
+ */
+static svn_error_t *
+release_exclusive_object(object_ref_t *object_ref)
+{
+  svn_object_pool__t *object_pool = object_ref->object_pool;
+
+  /* Update the counters while still holding the lock.  Otherwise,
+     remove_unused_objects() might destroy OBJECT_REF before we are done
+     with it. */
+  SVN_ERR(svn_mutex__lock(object_pool->mutex));
+  svn_atomic_dec(&object_ref->ref_count);
+  if (   count_unused_objects(object_pool, &object_ref->key)
+      >= MAX_UNUSED_OBJECTS_PER_KEY)
+    {
+      svn_atomic_dec(&object_pool->object_count);
+      svn_pool_destroy(object_ref->pool);
+    }
+  else
+    {
+      push_unused_object(object_ref);
+      svn_atomic_inc(&object_pool->unused_count);
+    }
+
+  return svn_error_trace(svn_mutex__unlock(object_pool->mutex,
+                                           SVN_NO_ERROR));
+}
+
 /* Cleanup function called when an object_ref_t gets released.
  */
 static apr_status_t
@@ -147,6 +265,14 @@ object_ref_cleanup(void *baton)
   object_ref_t *object = baton;
   svn_object_pool__t *object_pool = object->object_pool;
 
+  /* In exclusive mode, make the object available to the next user.
+     Should that fail, the object simply remains unavailable. */
+  if (!object_pool->share_objects)
+    {
+      svn_error_clear(release_exclusive_object(object));
+      return APR_SUCCESS;
+    }
+
   /* If we released the last reference to object, there is one more
      unused entry.
 
@@ -197,6 +323,11 @@ lookup(void **object,
 
   if (object_ref)
     {
+      /* in exclusive mode, nobody else may get this object until it has
+         been released again */
+      if (!object_pool->share_objects)
+        pop_unused_object(object_ref);
+
       *object = object_pool->getter(object_ref->wrapper, baton, result_pool);
       add_object_ref(object_ref, result_pool);
     }
@@ -221,8 +352,12 @@ insert(void **object,
        apr_pool_t *wrapper_pool,
        apr_pool_t *result_pool)
 {
+  /* in exclusive mode, every object is a new instance and will only be
+     added to OBJECTS once it gets released */
   object_ref_t *object_ref
-    = apr_hash_get(object_pool->objects, key->data, key->size);
+    = object_pool->share_objects
+    ? apr_hash_get(object_pool->objects, key->data, key->size)
+    : NULL;
   if (object_ref)
     {
       /* entry already exists (e.g. race condition) */
@@ -270,8 +405,9 @@ insert(void **object,
       object_ref->key.size = key->size;
       memcpy(object_ref->key.data, key->data, key->size);
 
-      apr_hash_set(object_pool->objects, object_ref->key.data,
-                   object_ref->key.size, object_ref);
+      if (object_pool->share_objects)
+        apr_hash_set(object_pool->objects, object_ref->key.data,
+                     object_ref->key.size, object_ref);
       svn_atomic_inc(&object_pool->object_count);
 
       /* the new entry is *not* in use yet.
@@ -284,9 +420,10 @@ insert(void **object,
   *object = object_pool->getter(object_ref->wrapper, baton, result_pool);
   add_object_ref(object_ref, result_pool);
 
-  /* limit memory usage */
+  /* limit memory usage.  Compare instance counts with each other because
+     in exclusive mode, there may be many instances per hash entry. */
   if (svn_atomic_read(&object_pool->unused_count) * 2
-      > apr_hash_count(object_pool->objects) + 2)
+      > svn_atomic_read(&object_pool->object_count) + 2)
     remove_unused_objects(object_pool);
 
   return SVN_NO_ERROR;
@@ -320,6 +457,7 @@ svn_error_t *
 svn_object_pool__create(svn_object_pool__t **object_pool,
                         svn_object_pool__getter_t getter,
                         svn_object_pool__setter_t setter,
+                        svn_boolean_t share_objects,
                         svn_boolean_t thread_safe,
                         apr_pool_t *pool)
 {
@@ -333,6 +471,7 @@ svn_object_pool__create(svn_object_pool__t **object_pool,
 
   result->pool = pool;
   result->objects = svn_hash__make(result->pool);
+  result->share_objects = share_objects;
   result->getter = getter ? getter : default_getter;
   result->setter = setter ? setter : default_setter;
 
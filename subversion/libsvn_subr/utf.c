@@ -563,6 +563,27 @@ convert_to_stringbuf(xlate_handle_node_t *node,
 }
 
 
+/* Return TRUE if converting the LEN bytes at DATA with NODE would not
+   change them, i.e. if DATA is plain 7-bit ASCII and NODE converts
+   between the native encoding and UTF-8.  Both are supersets of ASCII,
+   so we can simply copy the data and don't need to go through iconv.
+   This is the case for most paths, log messages and XML tags. */
+static svn_boolean_t
+is_ascii_conversion(const xlate_handle_node_t *node,
+                    const char *data,
+                    apr_size_t len)
+{
+#if APR_CHARSET_EBCDIC
+  return FALSE;
+#else
+  if (node->frompage != SVN_APR_LOCALE_CHARSET
+      && node->topage != SVN_APR_LOCALE_CHARSET)
+    return FALSE;
+
+  return svn_utf__is_ascii(data, len);
+#endif
+}
+
 /* Return APR_EINVAL if the first LEN bytes of DATA contain anything
    other than seven-bit, non-control (except for whitespace) ASCII
    characters, finding the error pool from POOL.  Otherwise, return
@@ -683,7 +704,12 @@ svn_utf_stringbuf_to_utf8(svn_stringbuf_t **dest,
 
   SVN_ERR(get_ntou_xlate_handle_node(&node, pool));
 
-  if (node->handle)
+  if (node->handle && is_ascii_conversion(node, src->data, src->len))
+    {
+      err = SVN_NO_ERROR;
+      *dest = svn_stringbuf_dup(src, pool);
+    }
+  else if (node->handle)
     {
       err = convert_to_stringbuf(node, src->data, src->len, dest, pool);
       if (! err)
@@ -715,7 +741,12 @@ svn_utf_string_to_utf8(const svn_string_t **dest,
 
   SVN_ERR(get_ntou_xlate_handle_node(&node, pool));
 
-  if (node->handle)
+  if (node->handle && is_ascii_conversion(node, src->data, src->len))
+    {
+      err = SVN_NO_ERROR;
+      *dest = svn_string_dup(src, pool);
+    }
+  else if (node->handle)
     {
       err = convert_to_stringbuf(node, src->data, src->len, &destbuf, pool);
       if (! err)
@@ -748,16 +779,20 @@ convert_cstring(const char **dest,
                 xlate_handle_node_t *node,
                 apr_pool_t *pool)
 {
-  if (node->handle)
+  apr_size_t len = strlen(src);
+
+  if (node->handle && is_ascii_conversion(node, src, len))
+    {
+      *dest = apr_pstrmemdup(pool, src, len);
+    }
+  else if (node->handle)
     {
       svn_stringbuf_t *destbuf;
-      SVN_ERR(convert_to_stringbuf(node, src, strlen(src),
-                                   &destbuf, pool));
+      SVN_ERR(convert_to_stringbuf(node, src, len, &destbuf, pool));
       *dest = destbuf->data;
     }
   else
     {
-      apr_size_t len = strlen(src);
       SVN_ERR(check_non_ascii(src, len, pool));
       *dest = apr_pstrmemdup(pool, src, len);
     }
@@ -829,7 +864,12 @@ svn_utf_stringbuf_from_utf8(svn_stringbuf_t **dest,
 
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
 
-  if (node->handle)
+  if (node->handle && is_ascii_conversion(node, src->data, src->len))
+    {
+      err = SVN_NO_ERROR;
+      *dest = svn_stringbuf_dup(src, pool);
+    }
+  else if (node->handle)
     {
       err = check_utf8(src->data, src->len, pool);
       if (! err)
@@ -861,7 +901,12 @@ svn_utf_string_from_utf8(const svn_string_t **dest,
 
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
 
-  if (node->handle)
+  if (node->handle && is_ascii_conversion(node, src->data, src->len))
+    {
+      err = SVN_NO_ERROR;
+      *dest = svn_string_dup(src, pool);
+    }
+  else if (node->handle)
     {
       err = check_utf8(src->data, src->len, pool);
       if (! err)
@@ -992,7 +1037,12 @@ svn_utf_cstring_from_utf8_string(const char **dest,
 
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
 
-  if (node->handle)
+  if (node->handle && is_ascii_conversion(node, src->data, src->len))
+    {
+      err = SVN_NO_ERROR;
+      *dest = apr_pstrmemdup(pool, src->data, src->len);
+    }
+  else if (node->handle)
     {
       err = check_utf8(src->data, src->len, pool);
       if (! err)
@@ -277,6 +277,18 @@ first_non_fsm_start_char(const char *data, apr_size_t max_len)
 
 #endif
 
+  /* Scan long runs four machine words at a time.  Combining the words
+   * before testing them keeps the loop branch-free for pure ASCII input
+   * and allows the compiler to use vector registers. */
+  for (; max_len > 4 * sizeof(apr_uintptr_t)
+       ; data += 4 * sizeof(apr_uintptr_t),
+         max_len -= 4 * sizeof(apr_uintptr_t))
+    {
+      const apr_uintptr_t *chunk = (const apr_uintptr_t *)data;
+      if ((chunk[0] | chunk[1] | chunk[2] | chunk[3]) & SVN__BIT_7_SET)
+        break;
+    }
+
   /* Scan the input one machine word at a time. */
   for (; max_len > sizeof(apr_uintptr_t)
        ; data += sizeof(apr_uintptr_t), max_len -= sizeof(apr_uintptr_t))
@@ -337,21 +349,34 @@ first_non_fsm_start_char_cstring(const char *data)
   return data;
 }
 
+/* In the functions below, the FSM only processes the multi-byte chars.
+ * Whenever it returns to FSM_START, we skip the following ASCII run with
+ * the chunky scanners above.  This keeps mostly-ASCII text with a few
+ * non-ASCII chars, e.g. log messages and paths, on the fast path. */
+
 const char *
 svn_utf__last_valid(const char *data, apr_size_t len)
 {
-  const char *start = first_non_fsm_start_char(data, len);
+  const char *start = data;
   const char *end = data + len;
   int state = FSM_START;
 
-  data = start;
   while (data < end)
     {
-      unsigned char octet = *data++;
-      int category = octet_category[octet];
-      state = machine[state][category];
-      if (state == FSM_START)
-        start = data;
+      data = first_non_fsm_start_char(data, end - data);
+      start = data;
+
+      while (data < end)
+        {
+          unsigned char octet = *data++;
+          int category = octet_category[octet];
+          state = machine[state][category];
+          if (state == FSM_START)
+            {
+              start = data;
+              break;
+            }
+        }
     }
   return start;
 }
@@ -364,13 +389,18 @@ svn_utf__cstring_is_valid(const char *data)
   if (!data)
     return FALSE;
 
-  data = first_non_fsm_start_char_cstring(data);
-
   while (*data)
     {
-      unsigned char octet = *data++;
-      int category = octet_category[octet];
-      state = machine[state][category];
+      data = first_non_fsm_start_char_cstring(data);
+
+      while (*data)
+        {
+          unsigned char octet = *data++;
+          int category = octet_category[octet];
+          state = machine[state][category];
+          if (state == FSM_START)
+            break;
+        }
     }
   return state == FSM_START;
 }
@@ -384,17 +414,28 @@ svn_utf__is_valid(const char *data, apr_size_t len)
   if (!data)
     return FALSE;
 
-  data = first_non_fsm_start_char(data, len);
-
   while (data < end)
     {
-      unsigned char octet = *data++;
-      int category = octet_category[octet];
-      state = machine[state][category];
+      data = first_non_fsm_start_char(data, end - data);
+
+      while (data < end)
+        {
+          unsigned char octet = *data++;
+          int category = octet_category[octet];
+          state = machine[state][category];
+          if (state == FSM_START)
+            break;
+        }
     }
   return state == FSM_START;
 }
 
+svn_boolean_t
+svn_utf__is_ascii(const char *data, apr_size_t len)
+{
+  return first_non_fsm_start_char(data, len) == data + len;
+}
+
 const char *
 svn_utf__last_valid2(const char *data, apr_size_t len)
 {
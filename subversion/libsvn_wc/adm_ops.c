@@ -1164,6 +1164,13 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
       *contents = svn_stream_lazyopen_create(get_pristine_lazyopen_func,
                                              gpl_baton, FALSE, result_pool);
     }
+  else
+    {
+      /* Maybe another working copy already has it? */
+      SVN_ERR(svn_wc__db_pristine_read_shared(contents, wc_ctx->db,
+                                              checksum,
+                                              result_pool, scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -496,31 +496,38 @@ svn_wc__diff_base_working_diff(svn_wc__db_t *db,
   if (skip)
     return SVN_NO_ERROR;
 
-  SVN_ERR(svn_wc__db_pristine_get_path(&pristine_file,
+  /* Compare the texts through streams first: a compressed pristine is
+     only materialized as a file when the processor gets to see it. */
+  if (files_same)
+    {
+      /* Already known to be unchanged */
+    }
+  else if (diff_pristine)
+    files_same = (working_checksum
+                  && svn_checksum_match(checksum, working_checksum));
+  else
+    {
+      svn_stream_t *pristine_stream;
+      svn_stream_t *local_stream;
+
+      SVN_ERR(svn_wc__db_pristine_read(&pristine_stream, NULL,
                                        db, local_abspath, checksum,
                                        scratch_pool, scratch_pool));
 
-  if (diff_pristine)
-    SVN_ERR(svn_wc__db_pristine_get_path(&local_file,
-                                         db, local_abspath,
-                                         working_checksum,
+      if (had_props || props_mod)
+        SVN_ERR(svn_wc__internal_translated_stream(&local_stream, db,
+                                                   local_abspath,
+                                                   local_abspath,
+                                                   SVN_WC_TRANSLATE_TO_NF,
+                                                   scratch_pool,
+                                                   scratch_pool));
+      else
+        SVN_ERR(svn_stream_open_readonly(&local_stream, local_abspath,
                                          scratch_pool, scratch_pool));
-  else if (! (had_props || props_mod))
-    local_file = local_abspath;
-  else if (files_same)
-    local_file = pristine_file;
-  else
-    SVN_ERR(svn_wc__internal_translated_file(
-                            &local_file, local_abspath,
-                            db, local_abspath,
-                            SVN_WC_TRANSLATE_TO_NF
-                                | SVN_WC_TRANSLATE_USE_GLOBAL_TMP,
-                            cancel_func, cancel_baton,
-                            scratch_pool, scratch_pool));
-
-  if (! files_same)
-    SVN_ERR(svn_io_files_contents_same_p(&files_same, local_file,
-                                         pristine_file, scratch_pool));
+
+      SVN_ERR(svn_stream_contents_same2(&files_same, pristine_stream,
+                                        local_stream, scratch_pool));
+    }
 
   if (had_props)
     SVN_ERR(svn_wc__db_base_get_props(&base_props, db, local_abspath,
@@ -541,6 +548,38 @@ svn_wc__diff_base_working_diff(svn_wc__db_t *db,
 
   if (prop_changes->nelts || !files_same)
     {
+      if (files_same && !(had_props || props_mod) && !diff_pristine)
+        {
+          /* The untranslated working file is the pristine text */
+          pristine_file = local_abspath;
+          local_file = local_abspath;
+        }
+      else
+        {
+          SVN_ERR(svn_wc__db_pristine_get_path(&pristine_file,
+                                               db, local_abspath, checksum,
+                                               scratch_pool, scratch_pool));
+
+          if (files_same)
+            local_file = pristine_file;
+          else if (diff_pristine)
+            SVN_ERR(svn_wc__db_pristine_get_path(&local_file,
+                                                 db, local_abspath,
+                                                 working_checksum,
+                                                 scratch_pool,
+                                                 scratch_pool));
+          else if (! (had_props || props_mod))
+            local_file = local_abspath;
+          else
+            SVN_ERR(svn_wc__internal_translated_file(
+                                    &local_file, local_abspath,
+                                    db, local_abspath,
+                                    SVN_WC_TRANSLATE_TO_NF
+                                        | SVN_WC_TRANSLATE_USE_GLOBAL_TMP,
+                                    cancel_func, cancel_baton,
+                                    scratch_pool, scratch_pool));
+        }
+
       SVN_ERR(processor->file_changed(relpath,
                                       left_src,
                                       right_src,
@@ -1006,7 +1045,9 @@ svn_wc__diff_local_only_file(svn_wc__db_t *db,
   else
     right_props = svn_prop_hash_dup(pristine_props, scratch_pool);
 
-  if (checksum)
+  /* The pristine text is only reported for copies and for pristine
+     diffs; don't materialize it otherwise. */
+  if (checksum && (copyfrom_src || diff_pristine))
     SVN_ERR(svn_wc__db_pristine_get_path(&pristine_file, db, local_abspath,
                                          checksum, scratch_pool, scratch_pool));
   else
@@ -2061,16 +2102,6 @@ close_file(void *file_baton,
 
     /* includes entry props */
     repos_props = svn_prop__patch(prop_base, fb->propchanges, scratch_pool);
-
-    repos_file = fb->temp_file_path;
-    if (! repos_file)
-      {
-        assert(fb->base_checksum);
-        SVN_ERR(svn_wc__db_pristine_get_path(&repos_file,
-                                             eb->db, eb->anchor_abspath,
-                                             fb->base_checksum,
-                                             scratch_pool, scratch_pool));
-      }
   }
 
   if (fb->skip)
@@ -2097,6 +2128,16 @@ close_file(void *file_baton,
       /* pb->local_info contains some information that might allow optimizing
          this a bit */
 
+      repos_file = fb->temp_file_path;
+      if (! repos_file)
+        {
+          assert(fb->base_checksum);
+          SVN_ERR(svn_wc__db_pristine_get_path(&repos_file,
+                                               eb->db, eb->anchor_abspath,
+                                               fb->base_checksum,
+                                               scratch_pool, scratch_pool));
+        }
+
       if (eb->diff_pristine)
         {
           const svn_checksum_t *checksum;
@@ -2106,10 +2147,16 @@ close_file(void *file_baton,
                                                 eb->db, fb->local_abspath,
                                                 scratch_pool, scratch_pool));
           assert(checksum);
-          SVN_ERR(svn_wc__db_pristine_get_path(&localfile,
-                                               eb->db, eb->anchor_abspath,
-                                               checksum,
-                                               scratch_pool, scratch_pool));
+
+          /* Don't materialize the same pristine text twice */
+          if (! fb->temp_file_path
+              && svn_checksum_match(checksum, fb->base_checksum))
+            localfile = repos_file;
+          else
+            SVN_ERR(svn_wc__db_pristine_get_path(&localfile,
+                                                 eb->db, eb->anchor_abspath,
+                                                 checksum,
+                                                 scratch_pool, scratch_pool));
         }
       else
         {
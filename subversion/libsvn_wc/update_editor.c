@@ -3920,12 +3920,17 @@ svn_wc__perform_file_merge(svn_skel_t **work_items,
   const char *new_pristine_abspath;
   enum svn_wc_merge_outcome_t merge_outcome = svn_wc_merge_unchanged;
   svn_skel_t *work_item;
+  svn_skel_t *new_cleanup_item;
+  svn_skel_t *left_cleanup_item = NULL;
 
   *work_items = NULL;
 
-  SVN_ERR(svn_wc__db_pristine_get_path(&new_pristine_abspath,
-                                       db, wri_abspath, new_checksum,
-                                       scratch_pool, scratch_pool));
+  /* The merge queues work items that read these files, so they must stay
+     around until the work queue has run. */
+  SVN_ERR(svn_wc__db_pristine_get_path_for_wq(&new_pristine_abspath,
+                                              &new_cleanup_item,
+                                              db, wri_abspath, new_checksum,
+                                              result_pool, scratch_pool));
 
   /* If we have any file extensions we're supposed to
      preserve in generated conflict file names, then find
@@ -3964,9 +3969,11 @@ svn_wc__perform_file_merge(svn_skel_t **work_items,
       delete_left = TRUE;
     }
   else
-    SVN_ERR(svn_wc__db_pristine_get_path(&merge_left, db, wri_abspath,
-                                         original_checksum,
-                                         result_pool, scratch_pool));
+    SVN_ERR(svn_wc__db_pristine_get_path_for_wq(&merge_left,
+                                                &left_cleanup_item,
+                                                db, wri_abspath,
+                                                original_checksum,
+                                                result_pool, scratch_pool));
 
   /* Merge the changes from the old textbase to the new
      textbase into the file we're updating.
@@ -3998,6 +4005,10 @@ svn_wc__perform_file_merge(svn_skel_t **work_items,
       *work_items = svn_wc__wq_merge(*work_items, work_item, result_pool);
     }
 
+  /* Likewise for decompressed copies of compressed pristines. */
+  *work_items = svn_wc__wq_merge(*work_items, left_cleanup_item, result_pool);
+  *work_items = svn_wc__wq_merge(*work_items, new_cleanup_item, result_pool);
+
   return SVN_NO_ERROR;
 }
 
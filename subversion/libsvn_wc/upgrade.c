@@ -1957,8 +1957,11 @@ svn_wc__upgrade_sdb(int *result_format,
         /* FALLTHROUGH  */
 #endif
       case SVN_WC__VERSION:
+      case SVN_WC__COMPRESSED_PRISTINES:
         /* already upgraded */
-        *result_format = SVN_WC__VERSION;
+        *result_format = (start_format == SVN_WC__COMPRESSED_PRISTINES)
+                           ? SVN_WC__COMPRESSED_PRISTINES
+                           : SVN_WC__VERSION;
 
         SVN_SQLITE__WITH_LOCK(
             svn_wc__db_install_schema_statistics(sdb, scratch_pool),
@@ -2229,7 +2232,8 @@ svn_wc_upgrade(svn_wc_context_t *wc_ctx,
       /* Auto-upgrade worked! */
       SVN_ERR(svn_wc__db_close(db));
 
-      SVN_ERR_ASSERT(result_format == SVN_WC__VERSION);
+      SVN_ERR_ASSERT(result_format == SVN_WC__VERSION
+                     || result_format == SVN_WC__COMPRESSED_PRISTINES);
 
       if (bumped_format && notify_func)
         {
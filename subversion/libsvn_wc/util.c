@@ -574,8 +574,10 @@ svn_wc__fetch_base_func(const char **filename,
       return SVN_NO_ERROR;
     }
 
+  /* A compressed pristine is handed out as a temporary copy, which lives
+     as long as RESULT_POOL. */
   SVN_ERR(svn_wc__db_pristine_get_path(filename, sfb->db, local_abspath,
-                                       checksum, scratch_pool, scratch_pool));
+                                       checksum, result_pool, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -88,12 +88,14 @@ CREATE TABLE PRISTINE (
      pristine texts referenced from this database. */
   checksum  TEXT NOT NULL PRIMARY KEY,
 
-  /* Enumerated values specifying type of compression. The only value
-     supported so far is NULL, meaning that no compression has been applied
-     and the pristine text is stored verbatim in the file. */
+  /* Enumerated values specifying type of compression. NULL means that no
+     compression has been applied and the pristine text is stored verbatim
+     in the file. 1 means the text is stored zlib compressed (in the format
+     of svn_stream_compressed()) in a file with a different extension, so
+     that older clients will not mistake it for the text itself. */
   compression  INTEGER,
 
-  /* The size in bytes of the file in which the pristine text is stored.
+  /* The size in bytes of the pristine text (before any compression).
      Used to verify the pristine file is "proper". */
   size  INTEGER NOT NULL,
 
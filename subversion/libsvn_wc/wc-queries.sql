@@ -829,20 +829,21 @@ SELECT id, work FROM work_queue ORDER BY id LIMIT 1
 DELETE FROM work_queue WHERE id = ?1
 
 -- STMT_INSERT_OR_IGNORE_PRISTINE
-INSERT OR IGNORE INTO pristine (checksum, md5_checksum, size, refcount)
-VALUES (?1, ?2, ?3, 0)
+INSERT OR IGNORE INTO pristine (checksum, md5_checksum, size, refcount,
+                                compression)
+VALUES (?1, ?2, ?3, 0, ?4)
 
 -- STMT_INSERT_PRISTINE
-INSERT INTO pristine (checksum, md5_checksum, size, refcount)
-VALUES (?1, ?2, ?3, 0)
+INSERT INTO pristine (checksum, md5_checksum, size, refcount, compression)
+VALUES (?1, ?2, ?3, 0, ?4)
 
 -- STMT_SELECT_PRISTINE
-SELECT md5_checksum
+SELECT md5_checksum, compression
 FROM pristine
 WHERE checksum = ?1
 
 -- STMT_SELECT_PRISTINE_SIZE
-SELECT size
+SELECT size, compression
 FROM pristine
 WHERE checksum = ?1 LIMIT 1
 
@@ -862,7 +863,7 @@ WHERE checksum = ?1 AND refcount = 0
 
 -- STMT_SELECT_COPY_PRISTINES
 /* For the root itself */
-SELECT n.checksum, md5_checksum, size
+SELECT n.checksum, md5_checksum, size, compression
 FROM nodes_current n
 LEFT JOIN pristine p ON n.checksum = p.checksum
 WHERE wc_id = ?1
@@ -870,7 +871,7 @@ WHERE wc_id = ?1
   AND n.checksum IS NOT NULL
 UNION ALL
 /* And all descendants */
-SELECT n.checksum, md5_checksum, size
+SELECT n.checksum, md5_checksum, size, compression
 FROM nodes n
 LEFT JOIN pristine p ON n.checksum = p.checksum
 WHERE wc_id = ?1
@@ -879,6 +880,10 @@ WHERE wc_id = ?1
       (SELECT MAX(op_depth) FROM nodes WHERE wc_id = ?1 AND local_relpath = ?2)
   AND n.checksum IS NOT NULL
 
+-- STMT_SET_COMPRESSED_PRISTINES_FORMAT
+/* Keep in sync with SVN_WC__COMPRESSED_PRISTINES in wc.h */
+PRAGMA user_version = 32
+
 -- STMT_VACUUM
 VACUUM
 
@@ -158,12 +158,23 @@ extern "C" {
  * Bumped in r1395109.
  *
  * == 1.8.x shipped with format 31
- * 
+ *
+ * Format 32 is format 31 plus PRISTINE rows whose text is stored compressed
+ *   (the 'compression' column is not NULL).  A working copy is only moved to
+ *   this format when the first compressed pristine is stored in it, see
+ *   svn_wc__db_pristine_install(), so clients that cannot read compressed
+ *   texts refuse to operate on it instead of reporting missing pristines.
+ *
  * Please document any further format changes here.
  */
 
 #define SVN_WC__VERSION 31
 
+/* A working copy of this format may store compressed pristine texts.
+   Apart from that it is identical to SVN_WC__VERSION, which is why both
+   formats are accepted. */
+#define SVN_WC__COMPRESSED_PRISTINES 32
+
 
 /* Formats <= this have no concept of "revert text-base/props".  */
 #define SVN_WC__NO_REVERT_FILES 4
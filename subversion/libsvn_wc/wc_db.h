@@ -913,6 +913,10 @@ svn_wc__db_base_get_lock_tokens_recursive(apr_hash_t **lock_tokens,
    ### This is temporary - callers should not be looking at the file
    directly.
 
+   If the pristine text is stored compressed, the path of a decompressed
+   temporary copy is returned, which is removed when RESULT_POOL is
+   cleared.
+
    Allocate the path in RESULT_POOL. */
 svn_error_t *
 svn_wc__db_pristine_get_path(const char **pristine_abspath,
@@ -922,6 +926,24 @@ svn_wc__db_pristine_get_path(const char **pristine_abspath,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool);
 
+/* Like svn_wc__db_pristine_get_path(), but for callers that hand the path
+   to work queue items, which may run after RESULT_POOL is gone.
+
+   If the pristine text is stored compressed, the decompressed copy is not
+   removed with any pool; *CLEANUP_WORK_ITEM is then set to a work item that
+   removes it, which the caller must queue after the work items that use the
+   path.  Otherwise *CLEANUP_WORK_ITEM is set to NULL.
+
+   Allocate the path and the work item in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_get_path_for_wq(const char **pristine_abspath,
+                                    svn_skel_t **cleanup_work_item,
+                                    svn_wc__db_t *db,
+                                    const char *wri_abspath,
+                                    const svn_checksum_t *checksum,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool);
+
 /* Set *PRISTINE_ABSPATH to the path under WCROOT_ABSPATH that will be
    used by the pristine text identified by SHA1_CHECKSUM.  The file
    need not exist.
@@ -933,6 +955,36 @@ svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* Set *CONTENTS to a readable stream on the pristine text identified by
+   SHA1_CHECKSUM in the pristine store of the working copy at
+   WCROOT_ABSPATH, without consulting the database.  Compressed pristines
+   are decompressed while reading.  Return an error if no such pristine
+   file exists.
+ */
+svn_error_t *
+svn_wc__db_pristine_open_future(svn_stream_t **contents,
+                                const char *wcroot_abspath,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
+/* If DB is configured to use a shared pristine store (see the
+   'shared-pristine-store' option in the 'working-copy' config section) and
+   that store holds the pristine text identified by SHA1_CHECKSUM, set
+   *CONTENTS to a readable stream on that text.  Otherwise set *CONTENTS
+   to NULL.  A shared text that doesn't match SHA1_CHECKSUM is treated as
+   not being available.
+
+   This allows obtaining texts that other working copies already fetched
+   without contacting the server.
+ */
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
 
 /* If requested set *CONTENTS to a readable stream that will yield the pristine
    text identified by SHA1_CHECKSUM (must be a SHA-1 checksum) within the WC
@@ -1048,7 +1100,10 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
                            apr_pool_t *scratch_pool);
 
 
-/* Remove all unreferenced pristines in the WC of WRI_ABSPATH in DB. */
+/* Remove all unreferenced pristines in the WC of WRI_ABSPATH in DB.
+
+   If DB uses a shared pristine store, also remove the texts in that
+   store that no working copy links to anymore. */
 svn_error_t *
 svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                             const char *wri_abspath,
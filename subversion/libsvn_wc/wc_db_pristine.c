@@ -35,43 +35,45 @@
 #include "wc_db.h"
 #include "wc-queries.h"
 #include "wc_db_private.h"
+#include "workqueue.h"
 
 #define PRISTINE_STORAGE_EXT ".svn-base"
+#define PRISTINE_COMPRESSED_STORAGE_EXT ".svn-zbase"
 #define PRISTINE_STORAGE_RELPATH "pristine"
 #define PRISTINE_TEMPDIR_RELPATH "tmp"
 
+/* Value of the PRISTINE.compression column for texts stored in the format
+   of svn_stream_compressed().  Uncompressed texts have NULL there. */
+#define PRISTINE_COMPRESSION_ZLIB 1
+
 
 
 /* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
    holding the local absolute path to the file location that is dedicated
-   to hold CHECKSUM's pristine file, relating to the pristine store
-   configured for the working copy indicated by PDH. The returned path
-   does not necessarily currently exist.
+   to hold CHECKSUM's pristine file within the pristine store directory
+   STORE_ABSPATH.  The returned path does not necessarily currently exist.
+
+   COMPRESSED selects the name of the compressed rather than the verbatim
+   storage file.
 
    Any other allocations are made in SCRATCH_POOL. */
 static svn_error_t *
-get_pristine_fname(const char **pristine_abspath,
-                   const char *wcroot_abspath,
-                   const svn_checksum_t *sha1_checksum,
-                   apr_pool_t *result_pool,
-                   apr_pool_t *scratch_pool)
+get_store_fname(const char **pristine_abspath,
+                const char *store_abspath,
+                const svn_checksum_t *sha1_checksum,
+                svn_boolean_t compressed,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
 {
-  const char *base_dir_abspath;
   const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
   char subdir[3];
 
   /* ### code is in transition. make sure we have the proper data.  */
   SVN_ERR_ASSERT(pristine_abspath != NULL);
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(wcroot_abspath));
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(store_abspath));
   SVN_ERR_ASSERT(sha1_checksum != NULL);
   SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
 
-  base_dir_abspath = svn_dirent_join_many(scratch_pool,
-                                          wcroot_abspath,
-                                          svn_wc_get_adm_dir(scratch_pool),
-                                          PRISTINE_STORAGE_RELPATH,
-                                          SVN_VA_NULL);
-
   /* We should have a valid checksum and (thus) a valid digest. */
   SVN_ERR_ASSERT(hexdigest != NULL);
 
@@ -80,30 +82,169 @@ get_pristine_fname(const char **pristine_abspath,
   subdir[1] = hexdigest[1];
   subdir[2] = '\0';
 
-  hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
+  hexdigest = apr_pstrcat(scratch_pool, hexdigest,
+                          compressed ? PRISTINE_COMPRESSED_STORAGE_EXT
+                                     : PRISTINE_STORAGE_EXT,
                           SVN_VA_NULL);
 
-  /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
+  /* The file is located at STORE/XX/XXYYZZ...svn-base
+     (or XXYYZZ...svn-zbase, if compressed) */
   *pristine_abspath = svn_dirent_join_many(result_pool,
-                                           base_dir_abspath,
+                                           store_abspath,
                                            subdir,
                                            hexdigest,
                                            SVN_VA_NULL);
   return SVN_NO_ERROR;
 }
 
+/* Like get_store_fname(), but for the pristine store of the working copy
+   at WCROOT_ABSPATH, i.e. DIR/.svn/pristine. */
+static svn_error_t *
+get_pristine_fname(const char **pristine_abspath,
+                   const char *wcroot_abspath,
+                   const svn_checksum_t *sha1_checksum,
+                   svn_boolean_t compressed,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  const char *base_dir_abspath;
 
-svn_error_t *
-svn_wc__db_pristine_get_path(const char **pristine_abspath,
-                             svn_wc__db_t *db,
-                             const char *wri_abspath,
-                             const svn_checksum_t *sha1_checksum,
-                             apr_pool_t *result_pool,
-                             apr_pool_t *scratch_pool)
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wcroot_abspath));
+
+  base_dir_abspath = svn_dirent_join_many(scratch_pool,
+                                          wcroot_abspath,
+                                          svn_wc_get_adm_dir(scratch_pool),
+                                          PRISTINE_STORAGE_RELPATH,
+                                          SVN_VA_NULL);
+
+  return svn_error_trace(get_store_fname(pristine_abspath, base_dir_abspath,
+                                         sha1_checksum, compressed,
+                                         result_pool, scratch_pool));
+}
+
+/* Return the absolute path to the temporary directory for pristine text
+   files within WCROOT. */
+static char *
+pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  return svn_dirent_join_many(result_pool, wcroot->abspath,
+                              svn_wc_get_adm_dir(scratch_pool),
+                              PRISTINE_TEMPDIR_RELPATH, SVN_VA_NULL);
+}
+
+/* Set *CONTENTS to a readable stream on the pristine storage file
+   PRISTINE_ABSPATH, which decompresses the text if COMPRESSED is TRUE.
+   Allocate the stream in RESULT_POOL. */
+static svn_error_t *
+open_pristine_file(svn_stream_t **contents,
+                   const char *pristine_abspath,
+                   svn_boolean_t compressed,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+
+  /* We don't enable APR_BUFFERED on this file to maximize throughput
+   * e.g. for fulltext comparison.  As we use SVN__STREAM_CHUNK_SIZE buffers
+   * where needed in streams, there is no point in having another layer of
+   * buffers. */
+  SVN_ERR(svn_io_file_open(&file, pristine_abspath, APR_READ,
+                           APR_OS_DEFAULT, result_pool));
+  *contents = svn_stream_from_aprfile2(file, FALSE, result_pool);
+
+  if (compressed)
+    *contents = svn_stream_compressed(*contents, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CONTENTS to a readable stream on the pristine text SHA1_CHECKSUM
+   within the pristine store directory STORE_ABSPATH, whether it is stored
+   verbatim or compressed.  Return an ENOENT error if it is not there.
+   Allocate the stream in RESULT_POOL. */
+static svn_error_t *
+open_store_file(svn_stream_t **contents,
+                const char *store_abspath,
+                const svn_checksum_t *sha1_checksum,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const char *pristine_abspath;
+  svn_error_t *err;
+
+  SVN_ERR(get_store_fname(&pristine_abspath, store_abspath,
+                          sha1_checksum, FALSE,
+                          scratch_pool, scratch_pool));
+  err = open_pristine_file(contents, pristine_abspath, FALSE,
+                           result_pool, scratch_pool);
+
+  /* Not stored verbatim?  Then it should be stored compressed. */
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+
+      SVN_ERR(get_store_fname(&pristine_abspath, store_abspath,
+                              sha1_checksum, TRUE,
+                              scratch_pool, scratch_pool));
+      err = open_pristine_file(contents, pristine_abspath, TRUE,
+                               result_pool, scratch_pool);
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Set *COMPRESSED to whether the pristine text SHA1_CHECKSUM is stored
+   compressed in WCROOT.  Return an error if it is not in the store. */
+static svn_error_t *
+pristine_is_compressed(svn_boolean_t *compressed,
+                       svn_wc__db_wcroot_t *wcroot,
+                       const svn_checksum_t *sha1_checksum,
+                       apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb, STMT_SELECT_PRISTINE));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (!have_row)
+    return svn_error_createf(SVN_ERR_WC_PATH_NOT_FOUND,
+                             svn_sqlite__reset(stmt),
+                             _("Pristine text '%s' not present"),
+                             svn_checksum_to_cstring_display(
+                               sha1_checksum, scratch_pool));
+
+  *compressed = (svn_sqlite__column_int(stmt, 1) == PRISTINE_COMPRESSION_ZLIB);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+
+/* Set *PRISTINE_ABSPATH to the path of a file that holds the pristine text
+   identified by SHA1_CHECKSUM in the working copy of DB, WRI_ABSPATH.
+
+   If the text is stored compressed, a decompressed copy is created in the
+   pristine temp directory with DELETE_WHEN and *IS_COPY is set to TRUE.
+   Otherwise *PRISTINE_ABSPATH is the pristine file itself and *IS_COPY is
+   set to FALSE.
+
+   Allocate *PRISTINE_ABSPATH in RESULT_POOL. */
+static svn_error_t *
+pristine_get_path(const char **pristine_abspath,
+                  svn_boolean_t *is_copy,
+                  svn_wc__db_t *db,
+                  const char *wri_abspath,
+                  const svn_checksum_t *sha1_checksum,
+                  svn_io_file_del_t delete_when,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
   svn_boolean_t present;
+  svn_boolean_t compressed;
 
   SVN_ERR_ASSERT(pristine_abspath != NULL);
   SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
@@ -130,13 +271,84 @@ svn_wc__db_pristine_get_path(const char **pristine_abspath,
                              svn_checksum_to_cstring_display(sha1_checksum,
                                                              scratch_pool));
 
+  SVN_ERR(pristine_is_compressed(&compressed, wcroot, sha1_checksum,
+                                 scratch_pool));
+  *is_copy = compressed;
+
+  if (compressed)
+    {
+      svn_stream_t *contents;
+      svn_stream_t *tmp_stream;
+      const char *pristine_fname;
+
+      /* Callers want a file they can read directly, so provide a
+         decompressed copy.  Stream based readers should use
+         svn_wc__db_pristine_read() instead. */
+      SVN_ERR(get_pristine_fname(&pristine_fname, wcroot->abspath,
+                                 sha1_checksum, TRUE,
+                                 scratch_pool, scratch_pool));
+      SVN_ERR(open_pristine_file(&contents, pristine_fname, TRUE,
+                                 scratch_pool, scratch_pool));
+      SVN_ERR(svn_stream_open_unique(&tmp_stream, pristine_abspath,
+                                     pristine_get_tempdir(wcroot,
+                                                          scratch_pool,
+                                                          scratch_pool),
+                                     delete_when,
+                                     result_pool, scratch_pool));
+
+      return svn_error_trace(svn_stream_copy3(contents, tmp_stream,
+                                              NULL, NULL, scratch_pool));
+    }
+
   SVN_ERR(get_pristine_fname(pristine_abspath, wcroot->abspath,
-                             sha1_checksum,
+                             sha1_checksum, FALSE,
                              result_pool, scratch_pool));
 
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__db_pristine_get_path(const char **pristine_abspath,
+                             svn_wc__db_t *db,
+                             const char *wri_abspath,
+                             const svn_checksum_t *sha1_checksum,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_boolean_t is_copy;
+
+  return svn_error_trace(pristine_get_path(pristine_abspath, &is_copy,
+                                           db, wri_abspath, sha1_checksum,
+                                           svn_io_file_del_on_pool_cleanup,
+                                           result_pool, scratch_pool));
+}
+
+svn_error_t *
+svn_wc__db_pristine_get_path_for_wq(const char **pristine_abspath,
+                                    svn_skel_t **cleanup_work_item,
+                                    svn_wc__db_t *db,
+                                    const char *wri_abspath,
+                                    const svn_checksum_t *sha1_checksum,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool)
+{
+  svn_boolean_t is_copy;
+
+  SVN_ERR(pristine_get_path(pristine_abspath, &is_copy,
+                            db, wri_abspath, sha1_checksum,
+                            svn_io_file_del_none,
+                            result_pool, scratch_pool));
+
+  if (is_copy)
+    SVN_ERR(svn_wc__wq_build_file_remove(cleanup_work_item, db, wri_abspath,
+                                         *pristine_abspath,
+                                         result_pool, scratch_pool));
+  else
+    *cleanup_work_item = NULL;
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
                                     const char *wcroot_abspath,
@@ -145,11 +357,109 @@ svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
                                     apr_pool_t *scratch_pool)
 {
   SVN_ERR(get_pristine_fname(pristine_abspath, wcroot_abspath,
-                             sha1_checksum,
+                             sha1_checksum, FALSE,
                              result_pool, scratch_pool));
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__db_pristine_open_future(svn_stream_t **contents,
+                                const char *wcroot_abspath,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  const char *store_abspath;
+
+  store_abspath = svn_dirent_join_many(scratch_pool,
+                                       wcroot_abspath,
+                                       svn_wc_get_adm_dir(scratch_pool),
+                                       PRISTINE_STORAGE_RELPATH,
+                                       SVN_VA_NULL);
+
+  return svn_error_trace(open_store_file(contents, store_abspath,
+                                         sha1_checksum,
+                                         result_pool, scratch_pool));
+}
+
+/* Read CONTENTS to its end and close it.  Set *VALID to whether the
+ * text read matches SHA1_CHECKSUM. */
+static svn_error_t *
+verify_pristine_stream(svn_boolean_t *valid,
+                       svn_stream_t *contents,
+                       const svn_checksum_t *sha1_checksum,
+                       apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *actual_checksum;
+  svn_error_t *err;
+
+  contents = svn_stream_checksummed2(contents, &actual_checksum, NULL,
+                                     svn_checksum_sha1, TRUE, scratch_pool);
+
+  /* A text that can't be decompressed is just as unusable. */
+  err = svn_stream_close(contents);
+  if (err && (err->apr_err == SVN_ERR_STREAM_MALFORMED_DATA
+              || err->apr_err == SVN_ERR_STREAM_UNRECOGNIZED_DATA))
+    {
+      svn_error_clear(err);
+      *valid = FALSE;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  *valid = svn_checksum_match(actual_checksum, sha1_checksum);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  svn_stream_t *verify_stream;
+  svn_boolean_t valid;
+  svn_error_t *err;
+
+  *contents = NULL;
+
+  if (!db->shared_pristine_abspath
+      || sha1_checksum->kind != svn_checksum_sha1)
+    return SVN_NO_ERROR;
+
+  err = open_store_file(&verify_stream, db->shared_pristine_abspath,
+                        sha1_checksum, scratch_pool, scratch_pool);
+
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* Any working copy sharing the store may have put this text there, so
+     don't hand it out without checking it.  A damaged text is treated as
+     not being available. */
+  SVN_ERR(verify_pristine_stream(&valid, verify_stream, sha1_checksum,
+                                 scratch_pool));
+  if (!valid)
+    return SVN_NO_ERROR;
+
+  err = open_store_file(contents, db->shared_pristine_abspath, sha1_checksum,
+                        result_pool, scratch_pool);
+
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *contents = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
 /* Set *CONTENTS to a readable stream from which the pristine text
  * identified by SHA1_CHECKSUM and PRISTINE_ABSPATH can be read from the
  * pristine store of WCROOT.  If SIZE is not null, set *SIZE to the size
@@ -170,12 +480,12 @@ pristine_read_txn(svn_stream_t **contents,
                   svn_filesize_t *size,
                   svn_wc__db_wcroot_t *wcroot,
                   const svn_checksum_t *sha1_checksum,
-                  const char *pristine_abspath,
                   apr_pool_t *result_pool,
                   apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  svn_boolean_t compressed;
 
   /* Check that this pristine text is present in the store.  (The presence
    * of the file is not sufficient.) */
@@ -187,6 +497,8 @@ pristine_read_txn(svn_stream_t **contents,
   if (size)
     *size = svn_sqlite__column_int64(stmt, 0);
 
+  compressed = (svn_sqlite__column_int(stmt, 1) == PRISTINE_COMPRESSION_ZLIB);
+
   SVN_ERR(svn_sqlite__reset(stmt));
   if (! have_row)
     {
@@ -198,17 +510,16 @@ pristine_read_txn(svn_stream_t **contents,
 
   /* Open the file as a readable stream.  It will remain readable even when
    * deleted from disk; APR guarantees that on Windows as well as Unix.
-   *
-   * We also don't enable APR_BUFFERED on this file to maximize throughput
-   * e.g. for fulltext comparison.  As we use SVN__STREAM_CHUNK_SIZE buffers
-   * where needed in streams, there is no point in having another layer of
-   * buffers. */
+   * Compressed texts are decompressed on the fly while reading. */
   if (contents)
     {
-      apr_file_t *file;
-      SVN_ERR(svn_io_file_open(&file, pristine_abspath, APR_READ,
-                               APR_OS_DEFAULT, result_pool));
-      *contents = svn_stream_from_aprfile2(file, FALSE, result_pool);
+      const char *pristine_abspath;
+
+      SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                 sha1_checksum, compressed,
+                                 scratch_pool, scratch_pool));
+      SVN_ERR(open_pristine_file(contents, pristine_abspath, compressed,
+                                 result_pool, scratch_pool));
     }
 
   return SVN_NO_ERROR;
@@ -225,7 +536,6 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
-  const char *pristine_abspath;
 
   SVN_ERR_ASSERT(contents != NULL);
   SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
@@ -244,12 +554,9 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
-  SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                             sha1_checksum,
-                             scratch_pool, scratch_pool));
   SVN_WC__DB_WITH_TXN(
     pristine_read_txn(contents, size,
-                      wcroot, sha1_checksum, pristine_abspath,
+                      wcroot, sha1_checksum,
                       result_pool, scratch_pool),
     wcroot);
 
@@ -257,22 +564,140 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
 }
 
 
-/* Return the absolute path to the temporary directory for pristine text
-   files within WCROOT. */
-static char *
-pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
-                     apr_pool_t *result_pool,
+/* Make sure the working copy at WCROOT is marked as possibly containing
+ * compressed pristine texts, so that clients that don't know about them
+ * refuse to use it instead of treating the texts as missing.  The format
+ * is only bumped when the first compressed text is stored.
+ */
+static svn_error_t *
+ensure_compressed_pristines_format(svn_wc__db_wcroot_t *wcroot,
+                                   apr_pool_t *scratch_pool)
+{
+  if (wcroot->format >= SVN_WC__COMPRESSED_PRISTINES)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__exec_statements(wcroot->sdb,
+                                      STMT_SET_COMPRESSED_PRISTINES_FORMAT));
+  wcroot->format = SVN_WC__COMPRESSED_PRISTINES;
+
+  return SVN_NO_ERROR;
+}
+
+/* Try to make PRISTINE_ABSPATH a hard link to SHARED_ABSPATH in the shared
+ * pristine store, replacing any orphaned file at PRISTINE_ABSPATH.  Set
+ * *LINKED to TRUE if that worked.  Sharing is an optimization only, so
+ * failures are not reported as errors.
+ */
+static svn_error_t *
+link_from_shared_store(svn_boolean_t *linked,
+                       const char *shared_abspath,
+                       const char *pristine_abspath,
+                       apr_pool_t *scratch_pool)
+{
+  svn_node_kind_t kind;
+  svn_error_t *err;
+
+  *linked = FALSE;
+
+  SVN_ERR(svn_io_check_path(shared_abspath, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  err = svn_io__create_hardlink(shared_abspath, pristine_abspath,
+                                scratch_pool);
+
+  if (err && APR_STATUS_IS_EEXIST(err->apr_err))
+    {
+      /* An orphaned pristine file; it doesn't matter if we replace it. */
+      svn_error_clear(err);
+      err = svn_io_remove_file2(pristine_abspath, TRUE, scratch_pool);
+      if (!err)
+        err = svn_io__create_hardlink(shared_abspath, pristine_abspath,
+                                      scratch_pool);
+    }
+  else if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      /* Maybe the directory doesn't exist yet? */
+      svn_error_clear(err);
+      err = svn_io_make_dir_recursively(svn_dirent_dirname(pristine_abspath,
+                                                           scratch_pool),
+                                        scratch_pool);
+      if (!err)
+        err = svn_io__create_hardlink(shared_abspath, pristine_abspath,
+                                      scratch_pool);
+    }
+
+  if (err)
+    svn_error_clear(err);
+  else
+    *linked = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *VALID to TRUE if the pristine file PRISTINE_ABSPATH, stored
+ * COMPRESSED or not, holds the text with checksum SHA1_CHECKSUM.  Used to
+ * check texts adopted from the shared pristine store, which other
+ * processes may have written.
+ */
+static svn_error_t *
+verify_pristine_file(svn_boolean_t *valid,
+                     const char *pristine_abspath,
+                     const svn_checksum_t *sha1_checksum,
+                     svn_boolean_t compressed,
                      apr_pool_t *scratch_pool)
 {
-  return svn_dirent_join_many(result_pool, wcroot->abspath,
-                              svn_wc_get_adm_dir(scratch_pool),
-                              PRISTINE_TEMPDIR_RELPATH, SVN_VA_NULL);
+  svn_stream_t *contents;
+
+  SVN_ERR(open_pristine_file(&contents, pristine_abspath, compressed,
+                             scratch_pool, scratch_pool));
+
+  return svn_error_trace(verify_pristine_stream(valid, contents,
+                                                sha1_checksum,
+                                                scratch_pool));
+}
+
+/* Try to add the installed pristine file PRISTINE_ABSPATH to the shared
+ * pristine store as SHARED_ABSPATH, for use by other working copies.
+ * Failures (e.g. the store being on another filesystem, or another
+ * process adding the same text concurrently) are silently ignored.
+ */
+static void
+link_to_shared_store(const char *pristine_abspath,
+                     const char *shared_abspath,
+                     apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  err = svn_io__create_hardlink(pristine_abspath, shared_abspath,
+                                scratch_pool);
+
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      err = svn_io_make_dir_recursively(svn_dirent_dirname(shared_abspath,
+                                                           scratch_pool),
+                                        scratch_pool);
+      if (!err)
+        err = svn_io__create_hardlink(pristine_abspath, shared_abspath,
+                                      scratch_pool);
+    }
+
+  svn_error_clear(err);
 }
 
 /* Install the pristine text described by BATON into the pristine store of
  * SDB.  If it is already stored then just delete the new file
  * BATON->tempfile_abspath.
  *
+ * SIZE is the size of the text and COMPRESSED tells whether INSTALL_STREAM
+ * holds it in compressed form.
+ *
+ * If SHARED_STORE_ABSPATH is not NULL, the pristine file is a hard link to
+ * the file in that shared pristine store, reusing it if another working
+ * copy already provided it.  The number of links to the file serves as
+ * the reference count of the text in the shared store.
+ *
  * This function expects to be executed inside a SQLite txn that has already
  * acquired a 'RESERVED' lock.
  *
@@ -288,63 +713,102 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
                      const svn_checksum_t *sha1_checksum,
                      /* The pristine text's MD-5 checksum. */
                      const svn_checksum_t *md5_checksum,
+                     svn_filesize_t size,
+                     svn_boolean_t compressed,
+                     const char *shared_store_abspath,
                      apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  const char *shared_abspath = NULL;
+  svn_boolean_t linked = FALSE;
 
   /* If this pristine text is already present in the store, just keep it:
    * delete the new one and return. */
-  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SELECT_PRISTINE));
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SELECT_PRISTINE_SIZE));
   SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
   SVN_ERR(svn_sqlite__step(&have_row, stmt));
-  SVN_ERR(svn_sqlite__reset(stmt));
 
   if (have_row)
     {
 #ifdef SVN_DEBUG
-      /* Consistency checks.  Verify both files exist and match.
+      /* Consistency checks.  Verify both texts match.
        * ### We could check much more. */
       {
-        apr_finfo_t finfo1, finfo2;
-
-        SVN_ERR(svn_stream__install_get_info(&finfo1, install_stream, APR_FINFO_SIZE,
-                                             scratch_pool));
+        svn_filesize_t existing_size = svn_sqlite__column_int64(stmt, 0);
 
-        SVN_ERR(svn_io_stat(&finfo2, pristine_abspath, APR_FINFO_SIZE,
-                            scratch_pool));
-        if (finfo1.size != finfo2.size)
+        if (size != existing_size)
           {
             return svn_error_createf(
-              SVN_ERR_WC_CORRUPT_TEXT_BASE, NULL,
+              SVN_ERR_WC_CORRUPT_TEXT_BASE, svn_sqlite__reset(stmt),
               _("New pristine text '%s' has different size: %ld versus %ld"),
               svn_checksum_to_cstring_display(sha1_checksum, scratch_pool),
-              (long int)finfo1.size, (long int)finfo2.size);
+              (long int)size, (long int)existing_size);
           }
       }
 #endif
+      SVN_ERR(svn_sqlite__reset(stmt));
 
       /* Remove the temp file: it's already there */
       SVN_ERR(svn_stream__install_delete(install_stream, scratch_pool));
       return SVN_NO_ERROR;
     }
+  SVN_ERR(svn_sqlite__reset(stmt));
 
-  /* Move the file to its target location.  (If it is already there, it is
-   * an orphan file and it doesn't matter if we overwrite it.) */
-  {
-    apr_finfo_t finfo;
-    SVN_ERR(svn_stream__install_get_info(&finfo, install_stream, APR_FINFO_SIZE,
-                                         scratch_pool));
-    SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
-                                        TRUE, scratch_pool));
-
-    SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
-                                      STMT_INSERT_PRISTINE));
-    SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
-    SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
-    SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
-    SVN_ERR(svn_sqlite__insert(NULL, stmt));
-  }
+  if (shared_store_abspath)
+    {
+      SVN_ERR(get_store_fname(&shared_abspath, shared_store_abspath,
+                              sha1_checksum, compressed,
+                              scratch_pool, scratch_pool));
+      SVN_ERR(link_from_shared_store(&linked, shared_abspath,
+                                     pristine_abspath, scratch_pool));
+
+      /* Don't trust the shared store blindly: any process with write
+       * access to it can put arbitrary data under that name.  If the text
+       * doesn't match, drop our link and the shared file, which will then
+       * be replaced by our own copy. */
+      if (linked)
+        {
+          svn_boolean_t valid;
+
+          SVN_ERR(verify_pristine_file(&valid, pristine_abspath,
+                                       sha1_checksum, compressed,
+                                       scratch_pool));
+          if (!valid)
+            {
+              SVN_ERR(svn_io_remove_file2(pristine_abspath, FALSE,
+                                          scratch_pool));
+              SVN_ERR(svn_io_remove_file2(shared_abspath, TRUE,
+                                          scratch_pool));
+              linked = FALSE;
+            }
+        }
+    }
+
+  if (linked)
+    {
+      /* The shared store already provided the text */
+      SVN_ERR(svn_stream__install_delete(install_stream, scratch_pool));
+    }
+  else
+    {
+      /* Move the file to its target location.  (If it is already there, it
+       * is an orphan file and it doesn't matter if we overwrite it.) */
+      SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
+                                         TRUE, scratch_pool));
+
+      if (shared_abspath)
+        link_to_shared_store(pristine_abspath, shared_abspath, scratch_pool);
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                    STMT_INSERT_PRISTINE));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, 3, size));
+  if (compressed)
+    SVN_ERR(svn_sqlite__bind_int(stmt, 4, PRISTINE_COMPRESSION_ZLIB));
+  SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
   return SVN_NO_ERROR;
 }
@@ -353,8 +817,44 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+
+  /* Is the text written to INNER_STREAM compressed? */
+  svn_boolean_t compressed;
+
+  /* The compressing stream wrapping INNER_STREAM, if COMPRESSED */
+  svn_stream_t *compressing_stream;
+
+  /* The shared pristine store to use, or NULL */
+  const char *shared_store_abspath;
+
+  /* Size of the (uncompressed) text written so far */
+  svn_filesize_t size;
 };
 
+/* Implements svn_write_fn_t for svn_wc__db_pristine_prepare_install(),
+   counting the bytes that are passed on to the compressing stream. */
+static svn_error_t *
+install_count_write(void *baton,
+                    const char *data,
+                    apr_size_t *len)
+{
+  svn_wc__db_install_data_t *install_data = baton;
+
+  install_data->size += *len;
+
+  return svn_error_trace(svn_stream_write(install_data->compressing_stream,
+                                          data, len));
+}
+
+/* Implements svn_close_fn_t for svn_wc__db_pristine_prepare_install() */
+static svn_error_t *
+install_count_close(void *baton)
+{
+  svn_wc__db_install_data_t *install_data = baton;
+
+  return svn_error_trace(svn_stream_close(install_data->compressing_stream));
+}
+
 svn_error_t *
 svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
                                     svn_wc__db_install_data_t **install_data,
@@ -379,6 +879,8 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   *install_data = apr_pcalloc(result_pool, sizeof(**install_data));
   (*install_data)->wcroot = wcroot;
+  (*install_data)->compressed = db->compress_pristines;
+  (*install_data)->shared_store_abspath = db->shared_pristine_abspath;
 
   SVN_ERR(svn_stream__create_for_install(stream,
                                          temp_dir_abspath,
@@ -386,6 +888,18 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   (*install_data)->inner_stream = *stream;
 
+  if ((*install_data)->compressed)
+    {
+      /* Compress on the way into the store, but keep track of the size
+         of the text itself. */
+      (*install_data)->compressing_stream
+        = svn_stream_compressed(*stream, result_pool);
+
+      *stream = svn_stream_create(*install_data, result_pool);
+      svn_stream_set_write(*stream, install_count_write);
+      svn_stream_set_close(*stream, install_count_close);
+    }
+
   if (md5_checksum)
     *stream = svn_stream_checksummed2(*stream, NULL, md5_checksum,
                                       svn_checksum_md5, FALSE, result_pool);
@@ -404,6 +918,7 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
 {
   svn_wc__db_wcroot_t *wcroot = install_data->wcroot;
   const char *pristine_abspath;
+  svn_filesize_t size;
 
   SVN_ERR_ASSERT(sha1_checksum != NULL);
   SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
@@ -411,15 +926,31 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
   SVN_ERR_ASSERT(md5_checksum->kind == svn_checksum_md5);
 
   SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                             sha1_checksum,
+                             sha1_checksum, install_data->compressed,
                              scratch_pool, scratch_pool));
 
+  if (install_data->compressed)
+    size = install_data->size;
+  else
+    {
+      apr_finfo_t finfo;
+
+      SVN_ERR(svn_stream__install_get_info(&finfo, install_data->inner_stream,
+                                           APR_FINFO_SIZE, scratch_pool));
+      size = finfo.size;
+    }
+
+  if (install_data->compressed)
+    SVN_ERR(ensure_compressed_pristines_format(wcroot, scratch_pool));
+
   /* Ensure the SQL txn has at least a 'RESERVED' lock before we start looking
    * at the disk, to ensure no concurrent pristine install/delete txn. */
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
     pristine_install_txn(wcroot->sdb,
                          install_data->inner_stream, pristine_abspath,
                          sha1_checksum, md5_checksum,
+                         size, install_data->compressed,
+                         install_data->shared_store_abspath,
                          scratch_pool),
     wcroot->sdb);
 
@@ -512,13 +1043,16 @@ svn_wc__db_pristine_get_sha1(const svn_checksum_t **sha1_checksum,
 }
 
 /* Handle the moving of a pristine from SRC_WCROOT to DST_WCROOT. The existing
-   pristine in SRC_WCROOT is described by CHECKSUM, MD5_CHECKSUM and SIZE */
+   pristine in SRC_WCROOT is described by CHECKSUM, MD5_CHECKSUM, SIZE and
+   COMPRESSED.  The storage file is copied as is, so a compressed pristine
+   stays compressed. */
 static svn_error_t *
 maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
                             svn_wc__db_wcroot_t *dst_wcroot,
                             const svn_checksum_t *checksum,
                             const svn_checksum_t *md5_checksum,
                             apr_int64_t size,
+                            svn_boolean_t compressed,
                             svn_cancel_func_t cancel_func,
                             void *cancel_baton,
                             apr_pool_t *scratch_pool)
@@ -537,12 +1071,17 @@ maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
   SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, checksum, scratch_pool));
   SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
   SVN_ERR(svn_sqlite__bind_int64(stmt, 3, size));
+  if (compressed)
+    SVN_ERR(svn_sqlite__bind_int(stmt, 4, PRISTINE_COMPRESSION_ZLIB));
 
   SVN_ERR(svn_sqlite__update(&affected_rows, stmt));
 
   if (affected_rows == 0)
     return SVN_NO_ERROR;
 
+  if (compressed)
+    SVN_ERR(ensure_compressed_pristines_format(dst_wcroot, scratch_pool));
+
   SVN_ERR(svn_stream_open_unique(&dst_stream, &tmp_abspath,
                                  pristine_get_tempdir(dst_wcroot,
                                                       scratch_pool,
@@ -551,7 +1090,7 @@ maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
                                  scratch_pool, scratch_pool));
 
   SVN_ERR(get_pristine_fname(&src_abspath, src_wcroot->abspath, checksum,
-                             scratch_pool, scratch_pool));
+                             compressed, scratch_pool, scratch_pool));
 
   SVN_ERR(svn_stream_open_readonly(&src_stream, src_abspath,
                                    scratch_pool, scratch_pool));
@@ -562,7 +1101,7 @@ maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
                            scratch_pool));
 
   SVN_ERR(get_pristine_fname(&pristine_abspath, dst_wcroot->abspath, checksum,
-                             scratch_pool, scratch_pool));
+                             compressed, scratch_pool, scratch_pool));
 
   /* Move the file to its target location.  (If it is already there, it is
    * an orphan file and it doesn't matter if we overwrite it.) */
@@ -619,6 +1158,7 @@ pristine_transfer_txn(svn_wc__db_wcroot_t *src_wcroot,
       const svn_checksum_t *checksum;
       const svn_checksum_t *md5_checksum;
       apr_int64_t size;
+      svn_boolean_t compressed;
       svn_error_t *err;
 
       svn_pool_clear(iterpool);
@@ -626,9 +1166,12 @@ pristine_transfer_txn(svn_wc__db_wcroot_t *src_wcroot,
       SVN_ERR(svn_sqlite__column_checksum(&checksum, stmt, 0, iterpool));
       SVN_ERR(svn_sqlite__column_checksum(&md5_checksum, stmt, 1, iterpool));
       size = svn_sqlite__column_int64(stmt, 2);
+      compressed = (svn_sqlite__column_int(stmt, 3)
+                    == PRISTINE_COMPRESSION_ZLIB);
 
       err = maybe_transfer_one_pristine(src_wcroot, dst_wcroot,
                                         checksum, md5_checksum, size,
+                                        compressed,
                                         cancel_func, cancel_baton,
                                         iterpool);
 
@@ -719,9 +1262,48 @@ remove_file(const char *file_abspath,
   return SVN_NO_ERROR;
 }
 
-/* If the pristine text referenced by SHA1_CHECKSUM in WCROOT/SDB, whose path
- * within the pristine store is PRISTINE_ABSPATH, has a reference count of
- * zero, delete it (both the database row and the disk file).
+/* Remove the pristine text SHA1_CHECKSUM (stored COMPRESSED or not) from
+ * the shared pristine store SHARED_STORE_ABSPATH, if the store's own link
+ * is the last one to it.
+ *
+ * Another process may link to the file between our check and the removal;
+ * that is harmless, as its working copy keeps its own link to the data.
+ */
+static svn_error_t *
+remove_unlinked_shared_file(const char *shared_store_abspath,
+                            const svn_checksum_t *sha1_checksum,
+                            svn_boolean_t compressed,
+                            apr_pool_t *scratch_pool)
+{
+  const char *shared_abspath;
+  apr_finfo_t finfo;
+  svn_error_t *err;
+
+  SVN_ERR(get_store_fname(&shared_abspath, shared_store_abspath,
+                          sha1_checksum, compressed,
+                          scratch_pool, scratch_pool));
+
+  err = svn_io_stat(&finfo, shared_abspath, APR_FINFO_NLINK, scratch_pool);
+  if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  if (finfo.nlink == 1)
+    SVN_ERR(svn_io_remove_file2(shared_abspath, TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* If the pristine text referenced by SHA1_CHECKSUM in WCROOT/SDB has a
+ * reference count of zero, delete it (both the database row and the disk
+ * file).
+ *
+ * If SHARED_STORE_ABSPATH is not NULL, also delete the text from that
+ * shared pristine store if no other working copy links to it anymore.
  *
  * This function expects to be executed inside a SQLite txn that has already
  * acquired a 'RESERVED' lock.
@@ -730,11 +1312,28 @@ static svn_error_t *
 pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
                                     svn_wc__db_wcroot_t *wcroot,
                                     const svn_checksum_t *sha1_checksum,
-                                    const char *pristine_abspath,
+                                    const char *shared_store_abspath,
                                     apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
   int affected_rows;
+  svn_boolean_t compressed;
+  const char *pristine_abspath;
+
+  /* Find out which file to delete, should we delete the row. */
+  {
+    svn_boolean_t have_row;
+
+    SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SELECT_PRISTINE));
+    SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+    SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    compressed = have_row && (svn_sqlite__column_int(stmt, 1)
+                              == PRISTINE_COMPRESSION_ZLIB);
+    SVN_ERR(svn_sqlite__reset(stmt));
+
+    if (!have_row)
+      return SVN_NO_ERROR;
+  }
 
   /* Remove the DB row, if refcount is 0. */
   SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
@@ -754,8 +1353,16 @@ pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
       svn_boolean_t ignore_enoent = TRUE;
 #endif
 
+      SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                 sha1_checksum, compressed,
+                                 scratch_pool, scratch_pool));
       SVN_ERR(remove_file(pristine_abspath, wcroot, ignore_enoent,
                           scratch_pool));
+
+      if (shared_store_abspath)
+        SVN_ERR(remove_unlinked_shared_file(shared_store_abspath,
+                                            sha1_checksum, compressed,
+                                            scratch_pool));
     }
 
   return SVN_NO_ERROR;
@@ -769,18 +1376,15 @@ pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
 static svn_error_t *
 pristine_remove_if_unreferenced(svn_wc__db_wcroot_t *wcroot,
                                 const svn_checksum_t *sha1_checksum,
+                                const char *shared_store_abspath,
                                 apr_pool_t *scratch_pool)
 {
-  const char *pristine_abspath;
-
-  SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                             sha1_checksum, scratch_pool, scratch_pool));
-
   /* Ensure the SQL txn has at least a 'RESERVED' lock before we start looking
    * at the disk, to ensure no concurrent pristine install/delete txn. */
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
     pristine_remove_if_unreferenced_txn(
-      wcroot->sdb, wcroot, sha1_checksum, pristine_abspath, scratch_pool),
+      wcroot->sdb, wcroot, sha1_checksum, shared_store_abspath,
+      scratch_pool),
     wcroot->sdb);
 
   return SVN_NO_ERROR;
@@ -824,7 +1428,9 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
   }
 
   /* If not referenced, remove the PRISTINE table row and the file. */
-  SVN_ERR(pristine_remove_if_unreferenced(wcroot, sha1_checksum, scratch_pool));
+  SVN_ERR(pristine_remove_if_unreferenced(wcroot, sha1_checksum,
+                                          db->shared_pristine_abspath,
+                                          scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -833,7 +1439,8 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
 /* Remove all unreferenced pristines in the WC DB in WCROOT.
  *
  * Look for pristine texts whose 'refcount' in the DB is zero, and remove
- * them from the 'pristine' table and from disk.
+ * them from the 'pristine' table and from disk (and from the shared
+ * pristine store SHARED_STORE_ABSPATH, if not NULL and no longer used).
  *
  * TODO: At least check that any zero refcount is really correct, before
  *       using it.  See dev@ email thread "Pristine text missing - cleanup
@@ -863,6 +1470,7 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
  */
 static svn_error_t *
 pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
+                        const char *shared_store_abspath,
                         apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
@@ -883,6 +1491,7 @@ pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
       SVN_ERR(svn_sqlite__column_checksum(&sha1_checksum, stmt, 0,
                                           scratch_pool));
       err = pristine_remove_if_unreferenced(wcroot, sha1_checksum,
+                                            shared_store_abspath,
                                             scratch_pool);
     }
 
@@ -890,6 +1499,96 @@ pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
       svn_error_compose_create(err, svn_sqlite__reset(stmt)));
 }
 
+/* Return TRUE if NAME ends with SUFFIX. */
+static svn_boolean_t
+has_suffix(const char *name, const char *suffix)
+{
+  apr_size_t name_len = strlen(name);
+  apr_size_t suffix_len = strlen(suffix);
+
+  return name_len > suffix_len
+         && strcmp(name + name_len - suffix_len, suffix) == 0;
+}
+
+/* Remove all pristine files from the shared pristine store
+ * SHARED_STORE_ABSPATH that no working copy links to anymore.
+ *
+ * Working copies remove their links to the shared store when they remove
+ * a pristine text, but a working copy that is simply deleted from disk
+ * leaves the shared files behind with only the store's own link.
+ *
+ * A concurrent install may find such a file gone between its check and
+ * creating its link; it then keeps its own copy of the text, which is
+ * harmless.
+ */
+static svn_error_t *
+cleanup_shared_store(const char *shared_store_abspath,
+                     apr_pool_t *scratch_pool)
+{
+  apr_hash_t *subdirs;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err;
+
+  err = svn_io_get_dirents3(&subdirs, shared_store_abspath, TRUE,
+                            scratch_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  for (hi = apr_hash_first(scratch_pool, subdirs); hi; hi = apr_hash_next(hi))
+    {
+      const char *subdir_name = svn__apr_hash_index_key(hi);
+      const svn_io_dirent2_t *subdir = svn__apr_hash_index_val(hi);
+      const char *subdir_abspath;
+      apr_hash_t *files;
+      apr_hash_index_t *hi2;
+
+      svn_pool_clear(iterpool);
+
+      if (subdir->kind != svn_node_dir || strlen(subdir_name) != 2)
+        continue;
+
+      subdir_abspath = svn_dirent_join(shared_store_abspath, subdir_name,
+                                       iterpool);
+      SVN_ERR(svn_io_get_dirents3(&files, subdir_abspath, TRUE,
+                                  iterpool, iterpool));
+
+      for (hi2 = apr_hash_first(iterpool, files); hi2;
+           hi2 = apr_hash_next(hi2))
+        {
+          const char *name = svn__apr_hash_index_key(hi2);
+          const svn_io_dirent2_t *dirent = svn__apr_hash_index_val(hi2);
+          const char *file_abspath;
+          apr_finfo_t finfo;
+
+          /* Only touch files that look like pristine texts. */
+          if (dirent->kind != svn_node_file
+              || (!has_suffix(name, PRISTINE_STORAGE_EXT)
+                  && !has_suffix(name, PRISTINE_COMPRESSED_STORAGE_EXT)))
+            continue;
+
+          file_abspath = svn_dirent_join(subdir_abspath, name, iterpool);
+          err = svn_io_stat(&finfo, file_abspath, APR_FINFO_NLINK, iterpool);
+          if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+            {
+              svn_error_clear(err);
+              continue;
+            }
+          SVN_ERR(err);
+
+          if (finfo.nlink == 1)
+            SVN_ERR(svn_io_remove_file2(file_abspath, TRUE, iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                             const char *wri_abspath,
@@ -904,7 +1603,11 @@ svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
-  SVN_ERR(pristine_cleanup_wcroot(wcroot, scratch_pool));
+  SVN_ERR(pristine_cleanup_wcroot(wcroot, db->shared_pristine_abspath,
+                                  scratch_pool));
+
+  if (db->shared_pristine_abspath)
+    SVN_ERR(cleanup_shared_store(db->shared_pristine_abspath, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -943,8 +1646,19 @@ svn_wc__db_pristine_check(svn_boolean_t *present,
     svn_node_kind_t kind_on_disk;
 
     SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                               sha1_checksum, scratch_pool, scratch_pool));
+                               sha1_checksum, FALSE,
+                               scratch_pool, scratch_pool));
     SVN_ERR(svn_io_check_path(pristine_abspath, &kind_on_disk, scratch_pool));
+
+    if (kind_on_disk == svn_node_none)
+      {
+        SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                   sha1_checksum, TRUE,
+                                   scratch_pool, scratch_pool));
+        SVN_ERR(svn_io_check_path(pristine_abspath, &kind_on_disk,
+                                  scratch_pool));
+      }
+
     if (kind_on_disk != svn_node_file)
       {
         *present = FALSE;
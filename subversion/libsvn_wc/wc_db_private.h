@@ -52,6 +52,13 @@ struct svn_wc__db_t {
   /* Busy timeout in ms., 0 for the libsvn_subr default. */
   apr_int32_t timeout;
 
+  /* Should newly installed pristine texts be stored compressed? */
+  svn_boolean_t compress_pristines;
+
+  /* Absolute path of the pristine store shared with other working copies,
+     or NULL when not using one. */
+  const char *shared_pristine_abspath;
+
   /* Map a given working copy directory to its relevant data.
      const char *local_abspath -> svn_wc__db_wcroot_t *wcroot  */
   apr_hash_t *dir_data;
@@ -155,7 +162,8 @@ svn_wc__db_verify_no_work(svn_sqlite__db_t *sdb);
 /* Assert that the given WCROOT is usable.
    NOTE: the expression is multiply-evaluated!!  */
 #define VERIFY_USABLE_WCROOT(wcroot)  SVN_ERR_ASSERT(               \
-    (wcroot) != NULL && (wcroot)->format == SVN_WC__VERSION)
+    (wcroot) != NULL && ((wcroot)->format == SVN_WC__VERSION             \
+                         || (wcroot)->format == SVN_WC__COMPRESSED_PRISTINES))
 
 /* Check if the WCROOT is usable for light db operations such as path
    calculations */
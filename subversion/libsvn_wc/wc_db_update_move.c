@@ -916,6 +916,7 @@ update_working_file(update_move_baton_t *b,
   enum svn_wc_merge_outcome_t merge_outcome;
   svn_wc_notify_state_t prop_state, content_state;
   svn_skel_t *work_item, *work_items = NULL;
+  svn_skel_t *cleanup_items = NULL;
 
   /* ### TODO: Only do this when there is no higher WORKING layer */
   SVN_ERR(update_working_props(&prop_state, &conflict_skel, &propchanges,
@@ -952,14 +953,26 @@ update_working_file(update_move_baton_t *b,
            * text as the merge-left version, and the current content of the
            * moved-here working file as the merge-right version.
            */
-          SVN_ERR(svn_wc__db_pristine_get_path(&old_pristine_abspath,
-                                               b->db, b->wcroot->abspath,
-                                               old_version->checksum,
-                                               scratch_pool, scratch_pool));
-          SVN_ERR(svn_wc__db_pristine_get_path(&new_pristine_abspath,
-                                               b->db, b->wcroot->abspath,
-                                               new_version->checksum,
-                                               scratch_pool, scratch_pool));
+          svn_skel_t *cleanup_item;
+
+          /* The merge queues work items that read the pristine files, so
+           * decompressed copies must be removed after those have run. */
+          SVN_ERR(svn_wc__db_pristine_get_path_for_wq(&old_pristine_abspath,
+                                                      &cleanup_items,
+                                                      b->db,
+                                                      b->wcroot->abspath,
+                                                      old_version->checksum,
+                                                      scratch_pool,
+                                                      scratch_pool));
+          SVN_ERR(svn_wc__db_pristine_get_path_for_wq(&new_pristine_abspath,
+                                                      &cleanup_item,
+                                                      b->db,
+                                                      b->wcroot->abspath,
+                                                      new_version->checksum,
+                                                      scratch_pool,
+                                                      scratch_pool));
+          cleanup_items = svn_wc__wq_merge(cleanup_items, cleanup_item,
+                                           scratch_pool);
           SVN_ERR(svn_wc__internal_merge(&work_item, &conflict_skel,
                                          &merge_outcome, b->db,
                                          old_pristine_abspath,
@@ -1003,6 +1016,8 @@ update_working_file(update_move_baton_t *b,
       work_items = svn_wc__wq_merge(work_items, work_item, scratch_pool);
     }
 
+  work_items = svn_wc__wq_merge(work_items, cleanup_items, scratch_pool);
+
   SVN_ERR(svn_wc__db_wq_add(b->db, b->wcroot->abspath, work_items,
                             scratch_pool));
 
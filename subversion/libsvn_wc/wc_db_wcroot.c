@@ -206,6 +206,8 @@ svn_wc__db_open(svn_wc__db_t **db,
     {
       svn_error_t *err;
       svn_boolean_t sqlite_exclusive = FALSE;
+      svn_boolean_t compress_pristines = FALSE;
+      const char *shared_pristine_store;
       apr_int64_t timeout;
 
       err = svn_config_get_bool(config, &sqlite_exclusive,
@@ -227,6 +229,32 @@ svn_wc__db_open(svn_wc__db_t **db,
         svn_error_clear(err);
       else
         (*db)->timeout = (apr_int32_t)timeout;
+
+      err = svn_config_get_bool(config, &compress_pristines,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_COMPRESS_PRISTINES,
+                                FALSE);
+      if (err)
+        svn_error_clear(err);
+      else
+        (*db)->compress_pristines = compress_pristines;
+
+      svn_config_get(config, &shared_pristine_store,
+                     SVN_CONFIG_SECTION_WORKING_COPY,
+                     SVN_CONFIG_OPTION_SHARED_PRISTINE_STORE, NULL);
+      if (shared_pristine_store && *shared_pristine_store)
+        {
+          err = svn_dirent_get_absolute(&(*db)->shared_pristine_abspath,
+                                        svn_dirent_internal_style(
+                                                     shared_pristine_store,
+                                                     scratch_pool),
+                                        result_pool);
+          if (err)
+            {
+              svn_error_clear(err);
+              (*db)->shared_pristine_abspath = NULL;
+            }
+        }
     }
 
   return SVN_NO_ERROR;
@@ -287,7 +315,7 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
     }
 
   /* If this working copy is from a future version, then bail out.  */
-  if (format > SVN_WC__VERSION)
+  if (format > SVN_WC__COMPRESSED_PRISTINES)
     {
       return svn_error_createf(
         SVN_ERR_WC_UNSUPPORTED_FORMAT, NULL,
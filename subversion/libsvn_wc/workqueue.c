@@ -84,6 +84,11 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
                         svn_boolean_t ignore_enoent,
                         apr_pool_t *scratch_pool);
 
+/* Forward definition */
+static void
+record_shared_bytes(work_item_baton_t *wqb,
+                    svn_filesize_t shared_bytes);
+
 /* ------------------------------------------------------------------------ */
 /* OP_REMOVE_BASE  */
 
@@ -468,11 +473,11 @@ run_file_install(work_item_baton_t *wqb,
   svn_subst_eol_style_t style;
   const char *eol;
   apr_hash_t *keywords;
+  svn_boolean_t translate;
   const char *temp_dir_abspath;
   svn_stream_t *dst_stream;
   apr_int64_t val;
   const char *wcroot_abspath;
-  const char *source_abspath;
   const svn_checksum_t *checksum;
   apr_hash_t *props;
   apr_time_t changed_date;
@@ -494,11 +499,15 @@ run_file_install(work_item_baton_t *wqb,
 
   if (arg4 != NULL)
     {
+      const char *source_abspath;
+
       /* Use the provided path for the source.  */
       local_relpath = apr_pstrmemdup(scratch_pool, arg4->data, arg4->len);
       SVN_ERR(svn_wc__db_from_relpath(&source_abspath, db, wri_abspath,
                                       local_relpath,
                                       scratch_pool, scratch_pool));
+      SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
+                                       scratch_pool, scratch_pool));
     }
   else if (! checksum)
     {
@@ -518,15 +527,11 @@ run_file_install(work_item_baton_t *wqb,
     }
   else
     {
-      SVN_ERR(svn_wc__db_pristine_get_future_path(&source_abspath,
-                                                  wcroot_abspath,
-                                                  checksum,
-                                                  scratch_pool, scratch_pool));
+      SVN_ERR(svn_wc__db_pristine_open_future(&src_stream, wcroot_abspath,
+                                              checksum,
+                                              scratch_pool, scratch_pool));
     }
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
-                                   scratch_pool, scratch_pool));
-
   /* Fetch all the translation bits.  */
   SVN_ERR(svn_wc__get_translate_info(&style, &eol,
                                      &keywords,
@@ -552,9 +557,10 @@ run_file_install(work_item_baton_t *wqb,
       return SVN_NO_ERROR;
     }
 
-  if (svn_subst_translation_required(style, eol, keywords,
-                                     FALSE /* special */,
-                                     TRUE /* force_eol_check */))
+  translate = svn_subst_translation_required(style, eol, keywords,
+                                             FALSE /* special */,
+                                             TRUE /* force_eol_check */);
+  if (translate)
     {
       /* Wrap it in a translating (expanding) stream.  */
       src_stream = svn_subst_stream_translated(src_stream, eol,
@@ -575,11 +581,30 @@ run_file_install(work_item_baton_t *wqb,
   SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
                                          scratch_pool, scratch_pool));
 
-  /* Copy from the source to the dest, translating as we go. This will also
-     close both streams.  */
-  SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                           cancel_func, cancel_baton,
-                           scratch_pool));
+  if (translate || !svn_stream__aprfile(src_stream))
+    {
+      /* Copy from the source to the dest, translating (or decompressing)
+         as we go. This will also close both streams.  */
+      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
+                               cancel_func, cancel_baton,
+                               scratch_pool));
+    }
+  else
+    {
+      svn_filesize_t shared_bytes;
+
+      /* The working file is identical to the pristine, so let the
+         filesystem share the data blocks (reflink) if it can.  */
+      SVN_ERR(svn_io__copy_file_contents(&shared_bytes,
+                                         svn_stream__aprfile(src_stream),
+                                         svn_stream__aprfile(dst_stream),
+                                         cancel_func, cancel_baton,
+                                         scratch_pool));
+      record_shared_bytes(wqb, shared_bytes);
+
+      SVN_ERR(svn_stream_close(src_stream));
+      SVN_ERR(svn_stream_close(dst_stream));
+    }
 
   /* All done. Move the file into place.  */
   /* With a single db we might want to install files in a missing directory.
@@ -1413,6 +1438,8 @@ struct work_item_baton_t
   svn_boolean_t used; /* needs reset */
 
   apr_hash_t *record_map; /* const char * -> svn_io_dirent2_t map */
+
+  svn_filesize_t shared_bytes; /* Bytes installed as pristine clones */
 };
 
 
@@ -1557,6 +1584,11 @@ svn_wc__wq_run(svn_wc__db_t *db,
       last_id = id;
     }
 
+#ifdef SVN_DEBUG_WORK_QUEUE
+  SVN_DBG(("wq_run: %" SVN_FILESIZE_T_FMT " bytes shared with pristines\n",
+           wib.shared_bytes));
+#endif
+
   svn_pool_destroy(iterpool);
   return SVN_NO_ERROR;
 }
@@ -1634,3 +1666,10 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
 
   return SVN_NO_ERROR;
 }
+
+static void
+record_shared_bytes(work_item_baton_t *wqb,
+                    svn_filesize_t shared_bytes)
+{
+  wqb->shared_bytes += shared_bytes;
+}
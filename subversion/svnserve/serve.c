@@ -54,6 +54,7 @@
 #include "private/svn_log.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_ra_svn_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_fspath.h"
 
 #ifdef HAVE_UNISTD_H
@@ -417,12 +418,12 @@ static void convert_case(char *text, svn_boolean_t to_uppercase)
 /* Set *ALLOWED to TRUE if PATH is accessible in the REQUIRED mode to
    the user described in BATON according to the authz rules in BATON.
    Use POOL for temporary allocations only.  If no authz rules are
-   present in BATON, grant access by default. */
-static svn_error_t *authz_check_access(svn_boolean_t *allowed,
-                                       const char *path,
-                                       svn_repos_authz_access_t required,
-                                       server_baton_t *b,
-                                       apr_pool_t *pool)
+   present in BATON, grant access by default.  Denials are not logged. */
+static svn_error_t *authz_lookup_access(svn_boolean_t *allowed,
+                                        const char *path,
+                                        svn_repos_authz_access_t required,
+                                        server_baton_t *b,
+                                        apr_pool_t *pool)
 {
   repository_t *repository = b->repository;
   client_info_t *client_info = b->client_info;
@@ -460,12 +461,25 @@ static svn_error_t *authz_check_access(svn_boolean_t *allowed,
       client_info->authz_user = authz_user;
     }
 
-  SVN_ERR(svn_repos_authz_check_access(repository->authzdb,
-                                       repository->authz_repos_name,
-                                       path, client_info->authz_user,
-                                       required, allowed, pool));
+  return svn_error_trace(
+           svn_repos_authz_check_access(repository->authzdb,
+                                        repository->authz_repos_name,
+                                        path, client_info->authz_user,
+                                        required, allowed, pool));
+}
+
+/* Like authz_lookup_access but log any denial. */
+static svn_error_t *authz_check_access(svn_boolean_t *allowed,
+                                       const char *path,
+                                       svn_repos_authz_access_t required,
+                                       server_baton_t *b,
+                                       apr_pool_t *pool)
+{
+  SVN_ERR(authz_lookup_access(allowed, path, required, b, pool));
   if (!*allowed)
-    SVN_ERR(log_authz_denied(path, required, b, pool));
+    SVN_ERR(log_authz_denied(path ? svn_fspath__canonicalize(path, pool)
+                                  : NULL,
+                             required, b, pool));
 
   return SVN_NO_ERROR;
 }
@@ -495,6 +509,24 @@ static svn_repos_authz_func_t authz_check_access_cb_func(server_baton_t *baton)
   return NULL;
 }
 
+/* Set *ALLOWED to TRUE if the REQUIRED access to PATH is granted,
+ * according to the state in BATON.  Use POOL for temporary allocations
+ * only.  ROOT is not used.  In contrast to authz_commit_cb, a denial is
+ * not an error condition and won't be logged.  Implements the
+ * svn_repos_authz_callback_t interface.
+ */
+static svn_error_t *authz_subtree_cb(svn_repos_authz_access_t required,
+                                     svn_boolean_t *allowed,
+                                     svn_fs_root_t *root,
+                                     const char *path,
+                                     void *baton,
+                                     apr_pool_t *pool)
+{
+  authz_baton_t *sb = baton;
+
+  return authz_lookup_access(allowed, path, required, sb->server, pool);
+}
+
 /* Set *ALLOWED to TRUE if the REQUIRED access to PATH is granted,
  * according to the state in BATON.  Use POOL for temporary
  * allocations only.  ROOT is not used.  Implements the
@@ -806,7 +838,17 @@ static svn_error_t *must_have_access(svn_ra_svn_conn_t *conn,
       && b->repository->auth_access >= req
       && (b->client_info->tunnel_user || b->repository->pwdb
           || b->repository->use_sasl))
-    SVN_ERR(auth_request(conn, pool, b, req, TRUE));
+    {
+      /* The client already sent further commands that it expects us to
+         process next.  It will retry this one without pipelining. */
+      if (b->pipelined)
+        return svn_error_create(SVN_ERR_RA_SVN_CMD_ERR,
+                                svn_error_create(SVN_ERR_RA_SVN_AUTH_REQUIRED,
+                                                 NULL, NULL),
+                                NULL);
+
+      SVN_ERR(auth_request(conn, pool, b, req, TRUE));
+    }
 
   /* Now that an authentication has been done get the new take of
      authz on the request. */
@@ -976,6 +1018,11 @@ static svn_error_t *accept_report(svn_boolean_t *only_empty_entry,
                                       &ab, svn_ra_svn_zero_copy_limit(conn),
                                       pool));
 
+  /* Let the reporter skip per-node authz checks in readable subtrees. */
+  if (b->repository->authzdb)
+    svn_repos__report_set_authz_subtree_func(report_baton, authz_subtree_cb,
+                                             &ab);
+
   rb.sb = b;
   rb.repos_url = svn_path_uri_decode(b->repository->repos_url, pool);
   rb.report_baton = report_baton;
@@ -1513,6 +1560,52 @@ static svn_error_t *commit(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   return SVN_NO_ERROR;
 }
 
+/* Baton type to be passed into send_zero_copy_contents.
+ */
+typedef struct zero_copy_baton_t
+{
+  /* connection to send the data to */
+  svn_ra_svn_conn_t *conn;
+
+  /* return value: will be set to TRUE, if the data was sent. */
+  svn_boolean_t zero_copy_succeeded;
+} zero_copy_baton_t;
+
+/* Implement svn_fs_process_contents_func_t.  If LEN does not exceed the
+ * zero-copy limit of the connection in *BATON, send CONTENTS as a single
+ * string straight from the FS cache and set the ZERO_COPY_SUCCEEDED flag
+ * in BATON.  Otherwise, don't send anything and reset that flag.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+send_zero_copy_contents(const unsigned char *contents,
+                        apr_size_t len,
+                        void *baton,
+                        apr_pool_t *scratch_pool)
+{
+  zero_copy_baton_t *zero_copy_baton = baton;
+  svn_string_t write_str;
+
+  /* Large items would block the cache for too long.  Let the caller
+     revert to traditional streaming code. */
+  if (len > svn_ra_svn_zero_copy_limit(zero_copy_baton->conn))
+    {
+      zero_copy_baton->zero_copy_succeeded = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  if (len > 0)
+    {
+      write_str.data = (const char *)contents;
+      write_str.len = len;
+      SVN_ERR(svn_ra_svn__write_string(zero_copy_baton->conn, scratch_pool,
+                                       &write_str));
+    }
+
+  zero_copy_baton->zero_copy_succeeded = TRUE;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *get_file(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                              apr_array_header_t *params, void *baton)
 {
@@ -1524,7 +1617,7 @@ static svn_error_t *get_file(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   apr_hash_t *props = NULL;
   apr_array_header_t *inherited_props;
   svn_string_t write_str;
-  char buf[4096];
+  char *buf;
   apr_size_t len;
   svn_boolean_t want_props, want_contents;
   apr_uint64_t wants_inherited_props;
@@ -1605,23 +1698,43 @@ static svn_error_t *get_file(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   /* Now send the file's contents. */
   if (want_contents)
     {
+      zero_copy_baton_t zero_copy_baton;
+      svn_boolean_t called = FALSE;
+
+      /* Cached fulltexts can be sent directly from the cache. */
+      zero_copy_baton.conn = conn;
+      zero_copy_baton.zero_copy_succeeded = FALSE;
       err = SVN_NO_ERROR;
-      while (1)
+      if (svn_ra_svn_zero_copy_limit(conn) > 0)
+        err = svn_fs_try_process_file_contents(&called, root, full_path,
+                                               send_zero_copy_contents,
+                                               &zero_copy_baton, pool);
+
+      if (!err && called && zero_copy_baton.zero_copy_succeeded)
         {
-          len = sizeof(buf);
-          err = svn_stream_read_full(contents, buf, &len);
-          if (err)
-            break;
-          if (len > 0)
-            {
-              write_str.data = buf;
-              write_str.len = len;
-              SVN_ERR(svn_ra_svn__write_string(conn, pool, &write_str));
-            }
-          if (len < sizeof(buf))
+          err = svn_stream_close(contents);
+        }
+      else if (!err)
+        {
+          /* Chunks this large bypass the connection's write buffer. */
+          buf = apr_palloc(pool, SVN__STREAM_CHUNK_SIZE);
+          while (1)
             {
-              err = svn_stream_close(contents);
-              break;
+              len = SVN__STREAM_CHUNK_SIZE;
+              err = svn_stream_read_full(contents, buf, &len);
+              if (err)
+                break;
+              if (len > 0)
+                {
+                  write_str.data = buf;
+                  write_str.len = len;
+                  SVN_ERR(svn_ra_svn__write_string(conn, pool, &write_str));
+                }
+              if (len < SVN__STREAM_CHUNK_SIZE)
+                {
+                  err = svn_stream_close(contents);
+                  break;
+                }
             }
         }
       write_err = svn_ra_svn__write_cstring(conn, pool, "");
@@ -3348,6 +3461,61 @@ get_inherited_props(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* The commands that may be wrapped in a "pipelined" command.  They only
+ * read from the repository and send a single command response. */
+static const svn_ra_svn_cmd_entry_t pipelined_commands[] = {
+  { "get-latest-rev",  get_latest_rev },
+  { "get-dated-rev",   get_dated_rev },
+  { "rev-proplist",    rev_proplist },
+  { "rev-prop",        rev_prop },
+  { "get-file",        get_file },
+  { "get-dir",         get_dir },
+  { "check-path",      check_path },
+  { "stat",            stat_cmd },
+  { "get-lock",        get_lock },
+  { "get-iprops",      get_inherited_props },
+  { NULL }
+};
+
+/* Execute the command given in PARAMS, which must be one of the
+ * PIPELINED_COMMANDS, as if it had been sent directly.  The client will
+ * not wait for its response before sending further commands, so don't
+ * try to authenticate the client if it lacks the required access. */
+static svn_error_t *
+pipelined(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          apr_array_header_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  const char *cmdname;
+  apr_array_header_t *cmd_params;
+  const svn_ra_svn_cmd_entry_t *command;
+  svn_error_t *err;
+
+  SVN_ERR(svn_ra_svn__parse_tuple(params, pool, "wl", &cmdname,
+                                  &cmd_params));
+
+  for (command = pipelined_commands; command->cmdname; command++)
+    if (strcmp(command->cmdname, cmdname) == 0)
+      break;
+
+  if (! command->cmdname)
+    return svn_error_create(SVN_ERR_RA_SVN_CMD_ERR,
+                            svn_error_createf(SVN_ERR_RA_SVN_UNKNOWN_CMD,
+                                              NULL,
+                                              _("Command '%s' cannot be "
+                                                "pipelined"),
+                                              cmdname),
+                            NULL);
+
+  b->pipelined = TRUE;
+  err = command->handler(conn, pool, cmd_params, baton);
+  b->pipelined = FALSE;
+
+  return svn_error_trace(err);
+}
+
 static const svn_ra_svn_cmd_entry_t main_commands[] = {
   { "reparent",        reparent },
   { "get-latest-rev",  get_latest_rev },
@@ -3380,6 +3548,7 @@ static const svn_ra_svn_cmd_entry_t main_commands[] = {
   { "replay-range",    replay_range },
   { "get-deleted-rev", get_deleted_rev },
   { "get-iprops",      get_inherited_props },
+  { "pipelined",       pipelined },
   { NULL }
 };
 
@@ -3440,8 +3609,9 @@ repos_path_valid(const char *path)
  * and fs_path fields of REPOSITORY.  VHOST and READ_ONLY flags are the
  * same as in the server baton.
  *
- * CONFIG_POOL and AUTHZ_POOL shall be used to load any object of the
- * respective type.
+ * REPOS_POOL, CONFIG_POOL and AUTHZ_POOL shall be used to load any object
+ * of the respective type.  The repository will be returned to REPOS_POOL
+ * when RESULT_POOL gets cleaned up.
  *
  * Use SCRATCH_POOL for temporary allocations.
  *
@@ -3453,9 +3623,9 @@ find_repos(const char *url,
            svn_boolean_t read_only,
            svn_config_t *cfg,
            repository_t *repository,
+           svn_repos__repos_pool_t *repos_pool,
            svn_repos__config_pool_t *config_pool,
            svn_repos__authz_pool_t *authz_pool,
-           apr_hash_t *fs_config,
            apr_pool_t *result_pool,
            apr_pool_t *scratch_pool)
 {
@@ -3494,8 +3664,9 @@ find_repos(const char *url,
                              "No repository found in '%s'", url);
 
   /* Open the repository and fill in b with the resulting information. */
-  SVN_ERR(svn_repos_open3(&repository->repos, repository->repos_root,
-                          fs_config, result_pool, scratch_pool));
+  SVN_ERR(svn_repos__repos_pool_get(&repository->repos, repos_pool,
+                                    repository->repos_root,
+                                    result_pool, scratch_pool));
   SVN_ERR(svn_repos_remember_client_capabilities(repository->repos,
                                                  repository->capabilities));
   repository->fs = svn_repos_fs(repository->repos);
@@ -3778,7 +3949,7 @@ construct_server_baton(server_baton_t **baton,
    * send an empty mechlist. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -3790,11 +3961,12 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_PARTIAL_REPLAY,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
-                                           SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE
+                                           SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
+                                           SVN_RA_SVN_CAP_PIPELINED_READS
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwww)",
+                                           "nn()(wwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -3805,7 +3977,8 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_PARTIAL_REPLAY,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
-                                           SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE
+                                           SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
+                                           SVN_RA_SVN_CAP_PIPELINED_READS
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
@@ -3859,8 +4032,9 @@ construct_server_baton(server_baton_t **baton,
 
   err = handle_config_error(find_repos(client_url, params->root, b->vhost,
                                        b->read_only, params->cfg,
-                                       b->repository, params->config_pool,
-                                       params->authz_pool, params->fs_config, 
+                                       b->repository, params->repos_pool,
+                                       params->config_pool,
+                                       params->authz_pool,
                                        conn_pool, scratch_pool),
                             b);
   if (!err)
@@ -88,6 +88,8 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  svn_boolean_t pipelined; /* Executing a "pipelined" command; must not
+                              start an authentication exchange. */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -122,6 +124,9 @@ typedef struct serve_params_t {
   /* logging data structure; possibly NULL. */
   struct logger_t *logger;
 
+  /* all repositories should be opened through this factory */
+  svn_repos__repos_pool_t *repos_pool;
+
   /* all configurations should be opened through this factory */
   svn_repos__config_pool_t *config_pool;
 
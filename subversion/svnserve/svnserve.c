@@ -56,10 +56,12 @@
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
 #include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_subr_private.h"
 
 #if APR_HAS_THREADS
 #    include <apr_thread_pool.h>
+#    include <apr_poll.h>
 #endif
 
 #include "winservice.h"
@@ -145,6 +147,22 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Expected number of idle connections in threaded mode.  Connections that
+ * have no request pending are kept in a pollset until the client sends
+ * its next command.
+ *
+ * This is only a sizing hint for the OS-specific implementation (epoll,
+ * kqueue etc.).  There may be more idle connections than this.
+ */
+#define IDLE_CONNECTIONS_HINT 1024
+
+/* If polling the idle connections fails, wait this long before trying
+ * again, doubling the delay with every consecutive failure up to the
+ * maximum.  In microseconds.
+ */
+#define DISPATCH_RETRY_DELAY_MIN 1000
+#define DISPATCH_RETRY_DELAY_MAX 1000000
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -562,19 +580,161 @@ static svn_root_pools__t *connection_pools;
 /* The global thread pool serving all connections. */
 static apr_thread_pool_t *threads;
 
+/* Connections without a pending request.  They get handed back to
+   THREADS by dispatch_thread() as soon as the client sends data.
+   NULL, if the platform has no thread-safe pollset implementation. */
+static apr_pollset_t *idle_connections;
+
 /* Very simple load determination callback for serve_interruptable:
-   With less than half the threads in THREADS in use, we can afford to
-   wait in the socket read() function.  Otherwise, poll them round-robin. */
+   With event-driven dispatching, a worker never waits for the next
+   command.  Otherwise, with less than half the threads in THREADS in use,
+   we can afford to wait in the socket read() function.  Beyond that,
+   poll them round-robin. */
 static svn_boolean_t
 is_busy(connection_t *connection)
 {
+  if (idle_connections)
+    return TRUE;
+
   return apr_thread_pool_threads_count(threads) * 2
        > apr_thread_pool_thread_max_get(threads);
 }
 
+static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data);
+
+/* Schedule CONNECTION to be served by one of the THREADS. */
+static void
+schedule_connection(connection_t *connection)
+{
+  apr_status_t status = apr_thread_pool_push(threads, serve_thread,
+                                             connection, 0, NULL);
+  if (status)
+    {
+      svn_error_t *err = svn_error_wrap_apr(status, _("Can't push task"));
+      logger__log_error(connection->params->logger, err, NULL, NULL);
+      svn_error_clear(err);
+      close_connection(connection);
+    }
+}
+
+/* Return the pollset entry for CONNECTION. */
+static apr_pollfd_t
+connection_pollfd(connection_t *connection)
+{
+  apr_pollfd_t pfd = { 0 };
+
+  pfd.desc_type = APR_POLL_SOCKET;
+  pfd.desc.s = connection->usock;
+  pfd.reqevents = APR_POLLIN;
+  pfd.client_data = connection;
+
+  return pfd;
+}
+
+/* CONNECTION has no more requests to process right now.  Unless there
+   is already more data waiting in its buffers, add it to IDLE_CONNECTIONS
+   where it will not occupy a worker thread until the client sends its
+   next command.  Use SCRATCH_POOL for temporary allocations. */
+static void
+park_connection(connection_t *connection,
+                apr_pool_t *scratch_pool)
+{
+  svn_boolean_t has_command, terminated;
+  apr_pollfd_t pfd;
+  svn_error_t *err;
+
+  /* This also flushes any pending output to the client. */
+  err = svn_ra_svn__has_command(&has_command, &terminated, connection->conn,
+                                scratch_pool);
+  if (err)
+    {
+      logger__log_error(connection->params->logger, err, NULL,
+                        get_client_info(connection->conn, connection->params,
+                                        scratch_pool));
+      svn_error_clear(err);
+      close_connection(connection);
+    }
+  else if (terminated)
+    {
+      close_connection(connection);
+    }
+  else if (has_command)
+    {
+      schedule_connection(connection);
+    }
+  else
+    {
+      /* The pollset is level-triggered, so data arriving before the
+         socket has been added will still be reported. */
+      pfd = connection_pollfd(connection);
+      if (apr_pollset_add(idle_connections, &pfd))
+        schedule_connection(connection);
+    }
+}
+
+/* Wait for data to arrive on any of the IDLE_CONNECTIONS and schedule
+   those connections to be served by THREADS.  This never returns. */
+static void * APR_THREAD_FUNC dispatch_thread(apr_thread_t *tid, void *data)
+{
+  apr_interval_time_t retry_delay = 0;
+
+  while (1)
+    {
+      apr_int32_t count, i;
+      const apr_pollfd_t *ready;
+      apr_status_t status = apr_pollset_poll(idle_connections, -1,
+                                             &count, &ready);
+      if (status)
+        {
+          if (!APR_STATUS_IS_EINTR(status) && !APR_STATUS_IS_TIMEUP(status))
+            {
+              /* Don't flood the log nor burn CPU if the error persists.
+                 Only log the first of a series of failures. */
+              if (retry_delay == 0)
+                {
+                  svn_error_t *err
+                    = svn_error_wrap_apr(status,
+                                         _("Can't poll idle connections"));
+                  logger__log_error(data, err, NULL, NULL);
+                  svn_error_clear(err);
+
+                  retry_delay = DISPATCH_RETRY_DELAY_MIN;
+                }
+              else
+                {
+                  retry_delay *= 2;
+                  if (retry_delay > DISPATCH_RETRY_DELAY_MAX)
+                    retry_delay = DISPATCH_RETRY_DELAY_MAX;
+                }
+
+              apr_sleep(retry_delay);
+            }
+
+          continue;
+        }
+
+      retry_delay = 0;
+
+      for (i = 0; i < count; ++i)
+        {
+          connection_t *connection = ready[i].client_data;
+
+          /* Make sure we don't get notified again before the worker has
+             consumed the data. */
+          apr_pollset_remove(idle_connections, &ready[i]);
+          schedule_connection(connection);
+        }
+    }
+
+  /* NOTREACHED */
+  return NULL;
+}
+
 /* Serve the connection given by DATA.  Under high load, serve only
    the current command (if any) and then put the connection back into
-   THREAD's task pool. */
+   THREAD's task pool.  With event-driven dispatching, park the
+   connection in IDLE_CONNECTIONS once there are no more commands
+   waiting. */
 static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 {
   svn_boolean_t done;
@@ -593,14 +753,17 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
       svn_error_clear(err);
       done = TRUE;
     }
-  svn_root_pools__release_pool(pool, connection_pools);
 
   /* Close or re-schedule connection. */
   if (done)
     close_connection(connection);
+  else if (idle_connections)
+    park_connection(connection, pool);
   else
-    apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
-    
+    schedule_connection(connection);
+
+  svn_root_pools__release_pool(pool, connection_pools);
+
   return NULL;
 }
 
@@ -708,6 +871,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.cfg = NULL;
   params.compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
   params.logger = NULL;
+  params.repos_pool = NULL;
   params.config_pool = NULL;
   params.authz_pool = NULL;
   params.fs_config = NULL;
@@ -967,6 +1131,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS,
                 cache_revprops ? "2" :"0");
 
+  SVN_ERR(svn_repos__repos_pool_create(&params.repos_pool,
+                                       params.fs_config,
+                                       is_multi_threaded,
+                                       pool));
   SVN_ERR(svn_repos__config_pool_create(&params.config_pool,
                                         is_multi_threaded,
                                         pool));
@@ -1241,10 +1409,31 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
       /* don't queue requests unless we reached the worker thread limit */
       apr_thread_pool_threshold_set(threads, 0);
+
+      /* Where supported, keep idle connections in a pollset instead of
+         a worker thread.  Otherwise, fall back to polling them
+         round-robin in the workers (see is_busy()). */
+      status = apr_pollset_create(&idle_connections, IDLE_CONNECTIONS_HINT,
+                                  pool, APR_POLLSET_THREADSAFE);
+      if (status == APR_SUCCESS)
+        {
+          apr_thread_t *tid;
+
+          status = apr_thread_create(&tid, NULL, dispatch_thread,
+                                     params.logger, pool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create dispatcher thread"));
+        }
+      else
+        {
+          idle_connections = NULL;
+        }
     }
   else
     {
       threads = NULL;
+      idle_connections = NULL;
     }
 #endif
 
@@ -1285,9 +1474,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           break;
 
         case connection_mode_thread:
-          /* Create a detached thread for each connection.  That's not a
-             particularly sophisticated strategy for a threaded server, it's
-             little different from forking one process per connection. */
+          /* Hand the connection to the thread pool.  Between requests,
+             idle connections will be parked in IDLE_CONNECTIONS rather
+             than occupying a worker thread. */
 #if APR_HAS_THREADS
           attach_connection(connection);
 
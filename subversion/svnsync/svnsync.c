@@ -972,6 +972,11 @@ typedef struct replay_baton_t {
   svn_ra_session_t *from_session;
   svn_ra_session_t *to_session;
   svn_revnum_t current_revision;
+  /* The last revision svn_ra_replay_range() will replay */
+  svn_revnum_t end_revision;
+  /* The revision we know SVNSYNC_PROP_CURRENTLY_COPYING to be set to in
+     the target, or SVN_INVALID_REVNUM */
+  svn_revnum_t currently_copying;
   subcommand_baton_t *sb;
   svn_boolean_t has_commit_revprops_capability;
   svn_boolean_t has_atomic_revprops_capability;
@@ -997,6 +1002,8 @@ make_replay_baton(replay_baton_t **baton_p,
   rb->from_session = from_session;
   rb->to_session = to_session;
   rb->sb = sb;
+  rb->end_revision = SVN_INVALID_REVNUM;
+  rb->currently_copying = SVN_INVALID_REVNUM;
 
   SVN_ERR(svn_ra_get_repos_root2(to_session, &rb->to_root, pool));
 
@@ -1220,12 +1227,17 @@ replay_rev_started(svn_revnum_t revision,
 
      NOTE: We have to set this before we start the commit editor,
      because ra_svn doesn't let you change rev props during a
-     commit. */
-  SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
-                                  SVNSYNC_PROP_CURRENTLY_COPYING,
-                                  NULL,
-                                  svn_string_createf(pool, "%ld", revision),
-                                  pool));
+     commit.
+
+     When replaying a range, replay_rev_finished() already set it
+     for this revision while finishing the previous one. */
+  if (rb->currently_copying != revision)
+    SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
+                                    SVNSYNC_PROP_CURRENTLY_COPYING,
+                                    NULL,
+                                    svn_string_createf(pool, "%ld", revision),
+                                    pool));
+  rb->currently_copying = revision;
 
   /* The actual copy is just a replay hooked up to a commit.  Include
      all the revision properties from the source repositories, except
@@ -1354,12 +1366,30 @@ replay_rev_finished(svn_revnum_t revision,
            subpool));
 
   /* And finally drop the currently copying prop, since we're done
-     with this revision. */
-  SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
-                                  SVNSYNC_PROP_CURRENTLY_COPYING,
-                                  rb->has_atomic_revprops_capability
-                                    ? &rev_str : NULL,
-                                  NULL, subpool));
+     with this revision.  If there is another revision to replay, move
+     the prop on to that revision instead, which saves a round trip to
+     the target per revision; the state is the same as when we would
+     have failed right after setting it in replay_rev_started(). */
+  if (SVN_IS_VALID_REVNUM(rb->end_revision) && revision < rb->end_revision)
+    {
+      SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
+                                      SVNSYNC_PROP_CURRENTLY_COPYING,
+                                      rb->has_atomic_revprops_capability
+                                        ? &rev_str : NULL,
+                                      svn_string_createf(subpool, "%ld",
+                                                         revision + 1),
+                                      subpool));
+      rb->currently_copying = revision + 1;
+    }
+  else
+    {
+      SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
+                                      SVNSYNC_PROP_CURRENTLY_COPYING,
+                                      rb->has_atomic_revprops_capability
+                                        ? &rev_str : NULL,
+                                      NULL, subpool));
+      rb->currently_copying = SVN_INVALID_REVNUM;
+    }
 
   /* Notify the user that we copied revision properties. */
   if (! rb->sb->quiet)
@@ -1496,6 +1526,7 @@ do_synchronize(svn_ra_session_t *to_session,
 
   start_revision = last_merged + 1;
   end_revision = from_latest;
+  rb->end_revision = end_revision;
 
   SVN_ERR(check_cancel(NULL));
 
@@ -797,6 +797,34 @@ def load_prop_change_in_non_deltas_dump(sbox):
                                           [], [], 0,
                                           '-q', 'load', sbox.repo_url)
 
+#----------------------------------------------------------------------
+@Issue(4116)
+@SkipUnless(svntest.main.is_ra_type_dav)
+def dump_with_http2_offered(sbox):
+  "dump: ordered editor drive with HTTP/2 offered"
+  sbox.build(create_wc = True)
+
+  # Change every file in one revision, so that the update fetches many
+  # texts while the REPORT response is still being received.
+  for path in ['iota', 'A/mu', 'A/B/lambda', 'A/B/E/alpha', 'A/B/E/beta',
+               'A/D/gamma', 'A/D/G/pi', 'A/D/G/rho', 'A/D/G/tau',
+               'A/D/H/chi', 'A/D/H/omega', 'A/D/H/psi']:
+    svntest.main.file_append(sbox.ospath(path), "More text.\n")
+    sbox.simple_propset('p', 'v', path)
+  sbox.simple_commit()
+
+  # svnrdump's dump editor needs the editor drive in order, which it
+  # gets by limiting ra_serf to two connections.  Offering HTTP/2 must
+  # not undo that.
+  svnrdump_dumpfile = \
+      svntest.actions.run_and_verify_svnrdump(None, svntest.verify.AnyOutput,
+                                              [], 0,
+                                              '--config-option',
+                                              'servers:global:http-http2=yes',
+                                              '-q', 'dump', sbox.repo_url)
+
+  compare_repos_dumps(sbox, svnrdump_dumpfile)
+
 
 ########################################################################
 # Run the tests
@@ -853,6 +881,7 @@ test_list = [ None,
               only_trunk_range_dump,
               only_trunk_A_range_dump,
               load_prop_change_in_non_deltas_dump,
+              dump_with_http2_offered,
              ]
 
 if __name__ == '__main__':
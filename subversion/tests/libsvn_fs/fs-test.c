@@ -5307,6 +5307,103 @@ dir_prop_merge(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Verify that CATALOG contains exactly the mergeinfo given in the
+   NULL-terminated list of path / mergeinfo string pairs EXPECTED. */
+static svn_error_t *
+verify_mergeinfo_catalog(svn_mergeinfo_catalog_t catalog,
+                         const char **expected,
+                         apr_pool_t *pool)
+{
+  int count = 0;
+
+  for (; *expected; expected += 2, ++count)
+    {
+      svn_mergeinfo_t mergeinfo = svn_hash_gets(catalog, expected[0]);
+      svn_string_t *mergeinfo_string;
+
+      if (!mergeinfo)
+        return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                 "No mergeinfo for '%s'", expected[0]);
+
+      SVN_ERR(svn_mergeinfo_to_string(&mergeinfo_string, mergeinfo, pool));
+      if (strcmp(mergeinfo_string->data, expected[1]))
+        return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                 "Expected mergeinfo '%s' for '%s', got '%s'",
+                                 expected[1], expected[0],
+                                 mergeinfo_string->data);
+    }
+
+  SVN_TEST_ASSERT(apr_hash_count(catalog) == count);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_descendant_mergeinfo(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev1, rev2;
+  svn_mergeinfo_catalog_t catalog;
+  apr_array_header_t *paths = apr_array_make(pool, 1, sizeof(const char *));
+  const char *expected1[] = { "/A/B", "/trunk/B:1",
+                              "/A/D/G", "/trunk/G:1",
+                              NULL };
+  const char *expected2[] = { "/A/B", "/trunk/B:1",
+                              "/A/D/G", "/trunk/G:1-2",
+                              NULL };
+
+  APR_ARRAY_PUSH(paths, const char *) = "/A";
+
+  SVN_ERR(svn_test__create_fs(&fs, "test-get-descendant-mergeinfo", opts,
+                              pool));
+
+  /* r1: greek tree with mergeinfo on A/B and A/D/G.  The invalid mergeinfo
+     on A/C must be ignored. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(root, pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "A/B", SVN_PROP_MERGEINFO,
+                                  svn_string_create("/trunk/B:1", pool),
+                                  pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "A/C", SVN_PROP_MERGEINFO,
+                                  svn_string_create("bogus", pool), pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "A/D/G", SVN_PROP_MERGEINFO,
+                                  svn_string_create("/trunk/G:1", pool),
+                                  pool));
+  SVN_ERR(test_commit_txn(&rev1, txn, NULL, pool));
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev1, pool));
+  SVN_ERR(svn_fs_get_mergeinfo2(&catalog, root, paths,
+                                svn_mergeinfo_explicit, TRUE, TRUE,
+                                pool, pool));
+  SVN_ERR(verify_mergeinfo_catalog(catalog, expected1, pool));
+
+  /* r2: modify the mergeinfo on A/D/G only. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev1, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "A/D/G", SVN_PROP_MERGEINFO,
+                                  svn_string_create("/trunk/G:1-2", pool),
+                                  pool));
+  SVN_ERR(test_commit_txn(&rev2, txn, NULL, pool));
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev2, pool));
+  SVN_ERR(svn_fs_get_mergeinfo2(&catalog, root, paths,
+                                svn_mergeinfo_explicit, TRUE, TRUE,
+                                pool, pool));
+  SVN_ERR(verify_mergeinfo_catalog(catalog, expected2, pool));
+
+  /* Querying the old revision again must not return the new mergeinfo. */
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev1, pool));
+  SVN_ERR(svn_fs_get_mergeinfo2(&catalog, root, paths,
+                                svn_mergeinfo_explicit, TRUE, TRUE,
+                                pool, pool));
+  SVN_ERR(verify_mergeinfo_catalog(catalog, expected1, pool));
+
+  return SVN_NO_ERROR;
+}
+
 
 /* ------------------------------------------------------------------------ */
 
@@ -5402,6 +5499,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_fs__compatible_version"),
     SVN_TEST_OPTS_PASS(dir_prop_merge,
                        "test merge directory properties"),
+    SVN_TEST_OPTS_PASS(get_descendant_mergeinfo,
+                       "test svn_fs_get_mergeinfo2 with descendants"),
     SVN_TEST_NULL
   };
 
@@ -29,6 +29,8 @@
 #include "svn_error.h"
 #include "svn_fs.h"
 #include "svn_hash.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
 
 #include "../svn_test_fs.h"
 
@@ -334,6 +336,25 @@ get_locks(const svn_test_opts_t *opts,
                                        num_expected_paths, pool));
   }
 
+  /* Verify from "/A/D/H/omega" and "/A/D/G" with depth empty. */
+  {
+    static const char *expected_paths[] = {
+      "/A/D/H/omega",
+    };
+    num_expected_paths = sizeof(expected_paths) / sizeof(const char *);
+    get_locks_baton = make_get_locks_baton(pool);
+    SVN_ERR(svn_fs_get_locks2(fs, "A/D/H/omega", svn_depth_empty,
+                              get_locks_callback, get_locks_baton, pool));
+    SVN_ERR(verify_matching_lock_paths(get_locks_baton, expected_paths,
+                                       num_expected_paths, pool));
+
+    get_locks_baton = make_get_locks_baton(pool);
+    SVN_ERR(svn_fs_get_locks2(fs, "A/D/G", svn_depth_empty,
+                              get_locks_callback, get_locks_baton, pool));
+    SVN_ERR(verify_matching_lock_paths(get_locks_baton, expected_paths, 0,
+                                       pool));
+  }
+
   /* Verify from "/iota" (which wasn't locked... tricky...). */
   {
     static const char *expected_paths[] = { 0 };
@@ -1012,6 +1033,131 @@ lock_multiple_paths(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Test that lock changes made through one FS object are visible to
+   another FS object for the same repository, even with lock caching
+   enabled. */
+static svn_error_t *
+lock_cache_invalidation(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_fs_t *fs, *fs1, *fs2;
+  svn_fs_access_t *access;
+  svn_lock_t *mylock;
+  struct get_locks_baton_t *get_locks_baton;
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  static const char *expected_paths[] = {
+    "/A/D/G/pi",
+  };
+
+  SVN_ERR(create_greek_fs(&fs, NULL, "test-repo-lock-cache-invalidation",
+                          opts, pool));
+
+  /* Open two more instances with lock caching (if available). */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_LOCKS, "2");
+  SVN_ERR(svn_fs_open2(&fs1, svn_fs_path(fs, pool), fs_config, pool, pool));
+  SVN_ERR(svn_fs_open2(&fs2, svn_fs_path(fs, pool), fs_config, pool, pool));
+
+  SVN_ERR(svn_fs_create_access(&access, "bubba", pool));
+  SVN_ERR(svn_fs_set_access(fs1, access));
+
+  /* Populate the cache through FS2. */
+  get_locks_baton = make_get_locks_baton(pool);
+  SVN_ERR(svn_fs_get_locks2(fs2, "", svn_depth_infinity,
+                            get_locks_callback, get_locks_baton, pool));
+  SVN_ERR(verify_matching_lock_paths(get_locks_baton, expected_paths, 0,
+                                     pool));
+
+  /* Lock through FS1, the new lock must be visible through FS2. */
+  SVN_ERR(svn_fs_lock(&mylock, fs1, "/A/D/G/pi", NULL, "", 0, 0,
+                      SVN_INVALID_REVNUM, FALSE, pool));
+  get_locks_baton = make_get_locks_baton(pool);
+  SVN_ERR(svn_fs_get_locks2(fs2, "", svn_depth_infinity,
+                            get_locks_callback, get_locks_baton, pool));
+  SVN_ERR(verify_matching_lock_paths(get_locks_baton, expected_paths, 1,
+                                     pool));
+
+  /* Same for unlocking. */
+  SVN_ERR(svn_fs_unlock(fs1, "/A/D/G/pi", mylock->token, FALSE, pool));
+  get_locks_baton = make_get_locks_baton(pool);
+  SVN_ERR(svn_fs_get_locks2(fs2, "A/D", svn_depth_infinity,
+                            get_locks_callback, get_locks_baton, pool));
+  SVN_ERR(verify_matching_lock_paths(get_locks_baton, expected_paths, 0,
+                                     pool));
+  SVN_ERR(svn_fs_get_lock(&mylock, fs2, "/A/D/G/pi", pool));
+  SVN_TEST_ASSERT(mylock == NULL);
+
+  /* Lock changes made without lock caching (e.g. by hook scripts or
+     svnadmin) must invalidate FS2's cache as well. */
+  SVN_ERR(svn_fs_set_access(fs, access));
+  SVN_ERR(svn_fs_lock(&mylock, fs, "/A/D/G/pi", NULL, "", 0, 0,
+                      SVN_INVALID_REVNUM, FALSE, pool));
+  SVN_ERR(svn_fs_get_lock(&mylock, fs2, "/A/D/G/pi", pool));
+  SVN_TEST_ASSERT(mylock != NULL);
+
+  SVN_ERR(svn_fs_unlock(fs, "/A/D/G/pi", mylock->token, FALSE, pool));
+  SVN_ERR(svn_fs_get_lock(&mylock, fs2, "/A/D/G/pi", pool));
+  SVN_TEST_ASSERT(mylock == NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that locking and unlocking in FSFS work when the shared memory
+   used to announce lock changes to other processes is unavailable. */
+static svn_error_t *
+lock_without_lock_atomics(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  svn_fs_t *fs, *fs1;
+  svn_fs_access_t *access;
+  svn_lock_t *mylock, *somelock;
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  const char *fs_path;
+  const char *mutex_path, *shm_path;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  SVN_ERR(create_greek_fs(&fs, NULL, "test-repo-lock-without-atomics",
+                          opts, pool));
+  fs_path = svn_fs_path(fs, pool);
+
+  /* Block the files that back the lock atomics namespace. */
+  mutex_path = svn_dirent_join(fs_path, "lock-atomics.mutex", pool);
+  shm_path = svn_dirent_join(fs_path, "lock-atomics.shm", pool);
+  SVN_ERR(svn_io_remove_file2(mutex_path, TRUE, pool));
+  SVN_ERR(svn_io_remove_file2(shm_path, TRUE, pool));
+  SVN_ERR(svn_io_dir_make(mutex_path, APR_OS_DEFAULT, pool));
+  SVN_ERR(svn_io_dir_make(shm_path, APR_OS_DEFAULT, pool));
+
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_LOCKS, "2");
+  SVN_ERR(svn_fs_open2(&fs1, fs_path, fs_config, pool, pool));
+
+  SVN_ERR(svn_fs_create_access(&access, "bubba", pool));
+  SVN_ERR(svn_fs_set_access(fs, access));
+  SVN_ERR(svn_fs_set_access(fs1, access));
+
+  /* Both with and without lock caching. */
+  SVN_ERR(svn_fs_lock(&mylock, fs1, "/A/D/G/pi", NULL, "", 0, 0,
+                      SVN_INVALID_REVNUM, FALSE, pool));
+  SVN_ERR(svn_fs_get_lock(&somelock, fs1, "/A/D/G/pi", pool));
+  SVN_TEST_ASSERT(somelock != NULL);
+  SVN_TEST_STRING_ASSERT(somelock->token, mylock->token);
+  SVN_ERR(svn_fs_unlock(fs1, "/A/D/G/pi", mylock->token, FALSE, pool));
+  SVN_ERR(svn_fs_get_lock(&somelock, fs1, "/A/D/G/pi", pool));
+  SVN_TEST_ASSERT(somelock == NULL);
+
+  SVN_ERR(svn_fs_lock(&mylock, fs, "/A/mu", NULL, "", 0, 0,
+                      SVN_INVALID_REVNUM, FALSE, pool));
+  SVN_ERR(svn_fs_get_lock(&somelock, fs1, "/A/mu", pool));
+  SVN_TEST_ASSERT(somelock != NULL);
+  SVN_ERR(svn_fs_unlock(fs, "/A/mu", mylock->token, FALSE, pool));
+  SVN_ERR(svn_fs_get_lock(&somelock, fs1, "/A/mu", pool));
+  SVN_TEST_ASSERT(somelock == NULL);
+
+  return SVN_NO_ERROR;
+}
+
 /* ------------------------------------------------------------------------ */
 
 /* The test table.  */
@@ -1045,6 +1191,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "check out-of-dateness before locking"),
     SVN_TEST_OPTS_PASS(lock_multiple_paths,
                        "lock multiple paths"),
+    SVN_TEST_OPTS_PASS(lock_cache_invalidation,
+                       "lock changes invalidate cached lock data"),
+    SVN_TEST_OPTS_PASS(lock_without_lock_atomics,
+                       "lock and unlock without lock atomics"),
     SVN_TEST_NULL
   };
 
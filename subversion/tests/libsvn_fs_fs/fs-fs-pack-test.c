@@ -27,9 +27,12 @@
 #include "../svn_test.h"
 #include "../../libsvn_fs_fs/fs.h"
 #include "../../libsvn_fs_fs/fs_fs.h"
+#include "../../libsvn_fs_fs/util.h"
+#include "../../libsvn_fs/fs-loader.h"
 
 #include "svn_pools.h"
 #include "svn_props.h"
+#include "svn_dirent_uri.h"
 #include "svn_fs.h"
 #include "private/svn_string_private.h"
 
@@ -1163,6 +1166,272 @@ recursive_locking(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-rep_sharing_many_reps"
+#define FILE_COUNT 1000
+static svn_error_t *
+rep_sharing_many_reps(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  const char *conflict;
+  svn_revnum_t rev;
+  apr_finfo_t finfo1, finfo2;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  apr_time_t start;
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support rep-sharing");
+
+  /* Some content that is large enough to dominate the rev file size. */
+  for (i = 0; i < 20; ++i)
+    svn_stringbuf_appendcstr(contents, "Some shared file content.\n");
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+
+  /* r1 adds many files with unique contents.  This makes more lookups
+     than needed to activate the rep-cache filter. */
+  start = apr_time_now();
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  for (i = 0; i < FILE_COUNT; ++i)
+    {
+      const char *path;
+
+      svn_pool_clear(iterpool);
+      path = apr_psprintf(iterpool, "f%d", i);
+      SVN_ERR(svn_fs_make_file(txn_root, path, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                          apr_psprintf(iterpool, "%s%d\n",
+                                                       contents->data, i),
+                                          iterpool));
+    }
+  SVN_ERR(svn_fs_commit_txn(&conflict, &rev, txn, pool));
+  SVN_TEST_ASSERT(rev == 1);
+
+  if (opts->verbose)
+    printf("r1: %d new files committed in %" APR_TIME_T_FMT " usec\n",
+           FILE_COUNT, apr_time_now() - start);
+
+  /* r2 adds copies of these files, created from scratch.  All of their
+     reps must be shared with r1 despite the filter. */
+  start = apr_time_now();
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  for (i = 0; i < FILE_COUNT; ++i)
+    {
+      const char *path;
+
+      svn_pool_clear(iterpool);
+      path = apr_psprintf(iterpool, "g%d", i);
+      SVN_ERR(svn_fs_make_file(txn_root, path, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                          apr_psprintf(iterpool, "%s%d\n",
+                                                       contents->data, i),
+                                          iterpool));
+    }
+  SVN_ERR(svn_fs_commit_txn(&conflict, &rev, txn, pool));
+  SVN_TEST_ASSERT(rev == 2);
+
+  if (opts->verbose)
+    printf("r2: %d shared files committed in %" APR_TIME_T_FMT " usec\n",
+           FILE_COUNT, apr_time_now() - start);
+
+  /* Without rep-sharing, r2 would be about as large as r1. */
+  SVN_ERR(svn_io_stat(&finfo1, svn_fs_fs__path_rev_absolute(fs, 1, pool),
+                      APR_FINFO_SIZE, pool));
+  SVN_ERR(svn_io_stat(&finfo2, svn_fs_fs__path_rev_absolute(fs, 2, pool),
+                      APR_FINFO_SIZE, pool));
+  SVN_TEST_ASSERT(finfo2.size < finfo1.size / 2);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef FILE_COUNT
+
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-revprop-cache-per-revision"
+#define SHARD_SIZE 4
+#define MAX_REV 10
+static svn_error_t *
+revprop_cache_per_revision(const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  svn_fs_t *fs, *fs2;
+  apr_hash_t *config = apr_hash_make(pool);
+  svn_string_t *prop_value;
+  svn_revnum_t rev;
+
+  /* Create the packed FS and open it twice with revprop caching. */
+  SVN_ERR(prepare_revprop_repo(&fs, REPO_NAME, MAX_REV, SHARD_SIZE, opts,
+                               pool));
+  svn_hash_sets(config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS, "2");
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, config, pool, pool));
+  SVN_ERR(svn_fs_open2(&fs2, REPO_NAME, config, pool, pool));
+
+  /* Populate the caches. */
+  for (rev = 0; rev <= MAX_REV; ++rev)
+    SVN_ERR(svn_fs_revision_prop(&prop_value, fs2, rev,
+                                 SVN_PROP_REVISION_AUTHOR, pool));
+
+  /* Change a packed revprop through the other FS object. */
+  SVN_ERR(svn_fs_change_rev_prop(fs, 5, SVN_PROP_REVISION_AUTHOR,
+                                 svn_string_create("tweaked-author", pool),
+                                 pool));
+
+  /* The change must be visible while the other revisions still read
+   * their original values. */
+  SVN_ERR(svn_fs_revision_prop(&prop_value, fs2, 5, SVN_PROP_REVISION_AUTHOR,
+                               pool));
+  SVN_TEST_STRING_ASSERT(prop_value->data, "tweaked-author");
+
+  for (rev = 1; rev <= MAX_REV; ++rev)
+    {
+      svn_string_t *expected;
+
+      SVN_ERR(svn_fs_revision_prop(&expected, fs, rev,
+                                   SVN_PROP_REVISION_AUTHOR, pool));
+      SVN_ERR(svn_fs_revision_prop(&prop_value, fs2, rev,
+                                   SVN_PROP_REVISION_AUTHOR, pool));
+      SVN_TEST_ASSERT(svn_string_compare(prop_value, expected));
+    }
+
+  /* Change it once more and check the cached copy gets replaced. */
+  SVN_ERR(svn_fs_change_rev_prop(fs, 5, SVN_PROP_REVISION_AUTHOR,
+                                 svn_string_create("tweaked-again", pool),
+                                 pool));
+  SVN_ERR(svn_fs_revision_prop(&prop_value, fs2, 5, SVN_PROP_REVISION_AUTHOR,
+                               pool));
+  SVN_TEST_STRING_ASSERT(prop_value->data, "tweaked-again");
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-large-dir-caching"
+#define DIR_COUNT 3
+#define ENTRY_COUNT 10000
+
+/* Return the name of entry I in the large directories of the
+   large_dir_caching test. */
+static const char *
+large_dir_entry_name(int i,
+                     apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "%0100d", i);
+}
+
+static svn_error_t *
+large_dir_caching(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  const char *conflict;
+  svn_revnum_t rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i, k;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* Create a few directories that are too large for the default
+     membuffer cache settings. */
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  for (k = 0; k < DIR_COUNT; ++k)
+    {
+      const char *dir = apr_psprintf(pool, "d%d", k);
+
+      SVN_ERR(svn_fs_make_dir(txn_root, dir, pool));
+      for (i = 0; i < ENTRY_COUNT; ++i)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(svn_fs_make_file(txn_root,
+                                   svn_relpath_join(dir,
+                                     large_dir_entry_name(i, iterpool),
+                                     iterpool),
+                                   iterpool));
+        }
+    }
+  SVN_ERR(svn_fs_commit_txn(&conflict, &rev, txn, pool));
+  SVN_TEST_ASSERT(rev == 1);
+
+  /* Read them through a new FS object, i.e. with cold caches. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  for (k = 0; k < DIR_COUNT; ++k)
+    {
+      apr_hash_t *entries;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_dir_entries(&entries, rev_root,
+                                 apr_psprintf(iterpool, "d%d", k),
+                                 iterpool));
+      SVN_TEST_ASSERT(apr_hash_count(entries) == ENTRY_COUNT);
+    }
+
+  /* Alternate between the directories for single entry lookups.  They
+     must be served from the dir cache or the remembered large dirs. */
+  for (i = 0; i < ENTRY_COUNT; i += 97)
+    for (k = 0; k < DIR_COUNT; ++k)
+      {
+        svn_node_kind_t kind;
+        const char *dir;
+
+        svn_pool_clear(iterpool);
+        dir = apr_psprintf(iterpool, "d%d", k);
+        SVN_ERR(svn_fs_check_path(&kind, rev_root,
+                                  svn_relpath_join(dir,
+                                    large_dir_entry_name(i, iterpool),
+                                    iterpool),
+                                  iterpool));
+        SVN_TEST_ASSERT(kind == svn_node_file);
+
+        SVN_ERR(svn_fs_check_path(&kind, rev_root,
+                                  svn_relpath_join(dir, "no-such-entry",
+                                                   iterpool),
+                                  iterpool));
+        SVN_TEST_ASSERT(kind == svn_node_none);
+      }
+
+  /* Only caches that limit the size of their entries may have caused
+     directories to be kept outside of them. */
+  ffd = fs->fsap_data;
+  if (!ffd->dir_cache_size_limited)
+    for (k = 0; k < SVN_FS_FS__LARGE_DIR_SLOTS; ++k)
+      SVN_TEST_ASSERT(ffd->large_dirs[k] == NULL);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef DIR_COUNT
+#undef ENTRY_COUNT
+
 /* ------------------------------------------------------------------------ */
 
 /* The test table.  */
@@ -1202,6 +1471,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "upgrade txns started before svnadmin upgrade"),
     SVN_TEST_OPTS_PASS(recursive_locking,
                        "prevent recursive locking"),
+    SVN_TEST_OPTS_PASS(rep_sharing_many_reps,
+                       "rep-sharing with many reps in one commit"),
+    SVN_TEST_OPTS_PASS(revprop_cache_per_revision,
+                       "revprop cache invalidation per revision"),
+    SVN_TEST_OPTS_PASS(large_dir_caching,
+                       "caching of directories too large for the cache"),
     SVN_TEST_NULL
   };
 
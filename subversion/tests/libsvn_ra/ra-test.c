@@ -43,6 +43,10 @@
 
 static const char tunnel_repos_name[] = "test-repo-tunnel";
 
+/* Contents of the non-empty files created by commit_tree(). */
+static const char B_f_contents[] = "This is the file 'A/B/f'.\n";
+static const char BB_f_contents[] = "This is the file 'A/BB/f'.\n";
+
 /*-------------------------------------------------------------------*/
 
 /** Helper routines. **/
@@ -102,6 +106,24 @@ commit_changes(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+/* Send CONTENTS as the full text of the file FILE_BATON in EDITOR. */
+static svn_error_t *
+send_file_contents(const svn_delta_editor_t *editor,
+                   void *file_baton,
+                   const char *contents,
+                   apr_pool_t *pool)
+{
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  SVN_ERR(editor->apply_textdelta(file_baton, NULL, pool,
+                                  &handler, &handler_baton));
+  return svn_error_trace(svn_txdelta_send_string(svn_string_create(contents,
+                                                                   pool),
+                                                 handler, handler_baton,
+                                                 pool));
+}
+
 static svn_error_t *
 commit_tree(svn_ra_session_t *session,
             apr_pool_t *pool)
@@ -125,6 +147,7 @@ commit_tree(svn_ra_session_t *session,
                                 pool, &B_baton));
   SVN_ERR(editor->add_file("A/B/f", B_baton, NULL, SVN_INVALID_REVNUM,
                            pool, &file_baton));
+  SVN_ERR(send_file_contents(editor, file_baton, B_f_contents, pool));
   SVN_ERR(editor->close_file(file_baton, NULL, pool));
   SVN_ERR(editor->add_file("A/B/g", B_baton, NULL, SVN_INVALID_REVNUM,
                            pool, &file_baton));
@@ -134,6 +157,7 @@ commit_tree(svn_ra_session_t *session,
                                 pool, &B_baton));
   SVN_ERR(editor->add_file("A/BB/f", B_baton, NULL, SVN_INVALID_REVNUM,
                            pool, &file_baton));
+  SVN_ERR(send_file_contents(editor, file_baton, BB_f_contents, pool));
   SVN_ERR(editor->close_file(file_baton, NULL, pool));
   SVN_ERR(editor->add_file("A/BB/g", B_baton, NULL, SVN_INVALID_REVNUM,
                            pool, &file_baton));
@@ -154,7 +178,8 @@ check_tunnel(void *tunnel_baton, const char *tunnel_name)
 {
   if (tunnel_baton != check_tunnel_baton)
     abort();
-  last_tunnel_check = (0 == strcmp(tunnel_name, "test"));
+  last_tunnel_check = (0 == strcmp(tunnel_name, "test")
+                       || 0 == strcmp(tunnel_name, "inetd"));
   return last_tunnel_check;
 }
 
@@ -179,6 +204,11 @@ open_tunnel(svn_stream_t **request, svn_stream_t **response,
 
   SVN_TEST_ASSERT(tunnel_baton == check_tunnel_baton);
 
+  /* The "inetd" tunnel runs svnserve without tunnel mode, so that it
+     doesn't offer EXTERNAL authentication. */
+  if (strcmp(tunnel_name, "inetd") == 0)
+    args[1] = "-i";
+
   SVN_ERR(svn_dirent_get_absolute(&svnserve, "../../svnserve/svnserve", pool));
 #ifdef WIN32
   svnserve = apr_pstrcat(pool, svnserve, ".exe", SVN_VA_NULL);
@@ -565,6 +595,244 @@ lock_test(const svn_test_opts_t *opts,
 }
 
 
+/* Check the svn_ra_*_many() functions against the tree created by
+ * commit_tree() in SESSION. */
+static svn_error_t *
+check_many(svn_ra_session_t *session,
+           apr_pool_t *pool)
+{
+  apr_array_header_t *paths = apr_array_make(pool, 3, sizeof(const char *));
+  apr_array_header_t *streams = apr_array_make(pool, 2,
+                                               sizeof(svn_stream_t *));
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  apr_hash_t *dirents, *props, *entries;
+  svn_dirent_t *dirent;
+  svn_revnum_t fetched_rev;
+
+  /* Stat existing and non-existing paths. */
+  APR_ARRAY_PUSH(paths, const char *) = "A";
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/f";
+  APR_ARRAY_PUSH(paths, const char *) = "X";
+  SVN_ERR(svn_ra_stat_many(session, paths, SVN_INVALID_REVNUM, &dirents,
+                           pool));
+  SVN_TEST_ASSERT(apr_hash_count(dirents) == 2);
+  dirent = svn_hash_gets(dirents, "A");
+  SVN_TEST_ASSERT(dirent && dirent->kind == svn_node_dir);
+  dirent = svn_hash_gets(dirents, "A/B/f");
+  SVN_TEST_ASSERT(dirent && dirent->kind == svn_node_file);
+
+  /* List directories. */
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  SVN_ERR(svn_ra_get_dir_many(session, &dirents, &fetched_rev, &props,
+                              paths, SVN_INVALID_REVNUM, SVN_DIRENT_KIND,
+                              pool));
+  SVN_TEST_ASSERT(fetched_rev == 1);
+  SVN_TEST_ASSERT(apr_hash_count(dirents) == 2);
+  SVN_TEST_ASSERT(apr_hash_count(props) == 2);
+  entries = svn_hash_gets(dirents, "A");
+  SVN_TEST_ASSERT(entries && apr_hash_count(entries) == 2);
+  dirent = svn_hash_gets(entries, "BB");
+  SVN_TEST_ASSERT(dirent && dirent->kind == svn_node_dir);
+  entries = svn_hash_gets(dirents, "A/BB");
+  SVN_TEST_ASSERT(entries && apr_hash_count(entries) == 2);
+  dirent = svn_hash_gets(entries, "g");
+  SVN_TEST_ASSERT(dirent && dirent->kind == svn_node_file);
+
+  /* Fetch files, one of them without contents. */
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/f";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/g";
+  APR_ARRAY_PUSH(streams, svn_stream_t *)
+    = svn_stream_from_stringbuf(contents, pool);
+  APR_ARRAY_PUSH(streams, svn_stream_t *) = NULL;
+  SVN_ERR(svn_ra_get_file_many(session, paths, 1, streams, &fetched_rev,
+                               &props, pool));
+  SVN_TEST_ASSERT(fetched_rev == 1);
+  SVN_TEST_ASSERT(apr_hash_count(props) == 2);
+  SVN_TEST_ASSERT(svn_hash_gets(props, "A/BB/g"));
+  SVN_TEST_STRING_ASSERT(contents->data, B_f_contents);
+
+  /* Failures must not leave the session in an unusable state. */
+  APR_ARRAY_PUSH(paths, const char *) = "X/z";
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_file_many(session, paths, 1, NULL, NULL,
+                                             NULL, pool),
+                        SVN_ERR_FS_NOT_FOUND);
+  SVN_ERR(svn_ra_stat(session, "A", 1, &dirent, pool));
+  SVN_TEST_ASSERT(dirent && dirent->kind == svn_node_dir);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test the svn_ra_*_many() fallback implementations. */
+static svn_error_t *
+many_paths_test(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+
+  SVN_ERR(make_and_open_local_repos(&session, "test-repo-many-paths", opts,
+                                    pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  return svn_error_trace(check_many(session, pool));
+}
+
+/* Test the pipelined svn_ra_*_many() implementation of ra_svn. */
+static svn_error_t *
+many_paths_tunnel_test(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  const char *repos_name = "test-repo-many-paths-tunnel";
+  svn_ra_session_t *session;
+  svn_ra_callbacks2_t *cbtable;
+  const char *url;
+  svn_error_t *err;
+
+  /* Populate the repository through ra_local. */
+  SVN_ERR(make_and_open_local_repos(&session, repos_name, opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", repos_name, SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = check_tunnel_baton = &cbtable;
+  SVN_ERR(svn_cmdline_create_auth_baton(&cbtable->auth_baton,
+                                        TRUE  /* non_interactive */,
+                                        "jrandom", "rayjandom",
+                                        NULL,
+                                        TRUE  /* no_auth_cache */,
+                                        FALSE /* trust_server_cert */,
+                                        NULL, NULL, NULL, pool));
+
+  err = svn_ra_open4(&session, NULL, url, NULL, cbtable, NULL, NULL, pool);
+  if (err && err->apr_err == SVN_ERR_TEST_FAILED)
+    {
+      svn_handle_error2(err, stderr, FALSE, "svn_tests: ");
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  return svn_error_trace(check_many(session, pool));
+}
+
+/* Test that ra_svn resends pipelined commands that need authentication
+   once the batch is done. */
+static svn_error_t *
+many_paths_auth_test(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  const char *repos_name = "test-repo-many-paths-auth";
+  svn_ra_session_t *session;
+  svn_ra_callbacks2_t *cbtable;
+  const char *url;
+  const char *conf_dir;
+  apr_array_header_t *paths = apr_array_make(pool, 3, sizeof(const char *));
+  apr_array_header_t *streams = apr_array_make(pool, 3,
+                                               sizeof(svn_stream_t *));
+  svn_stringbuf_t *B_f = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *BB_f = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *B_g = svn_stringbuf_create_empty(pool);
+  apr_hash_t *dirents, *props, *entries;
+  svn_dirent_t *dirent;
+  svn_revnum_t fetched_rev;
+  svn_error_t *err;
+
+  static const char svnserve_conf[] =
+    "[general]"                   APR_EOL_STR
+    "anon-access = read"          APR_EOL_STR
+    "auth-access = read"          APR_EOL_STR
+    "password-db = passwd"        APR_EOL_STR
+    "authz-db = authz"            APR_EOL_STR;
+  static const char passwd[] =
+    "[users]"                     APR_EOL_STR
+    "jrandom = rayjandom"         APR_EOL_STR;
+  static const char authz[] =
+    "[/]"                         APR_EOL_STR
+    "* = r"                       APR_EOL_STR
+    "[/A/BB]"                     APR_EOL_STR
+    "$anonymous ="                APR_EOL_STR
+    "$authenticated = r"          APR_EOL_STR;
+
+  /* Populate the repository through ra_local. */
+  SVN_ERR(make_and_open_local_repos(&session, repos_name, opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  /* Anonymous users may read everything but A/BB. */
+  conf_dir = svn_dirent_join(repos_name, "conf", pool);
+  SVN_ERR(svn_io_write_atomic(svn_dirent_join(conf_dir, "svnserve.conf",
+                                              pool),
+                              svnserve_conf, strlen(svnserve_conf),
+                              NULL, pool));
+  SVN_ERR(svn_io_write_atomic(svn_dirent_join(conf_dir, "passwd", pool),
+                              passwd, strlen(passwd), NULL, pool));
+  SVN_ERR(svn_io_write_atomic(svn_dirent_join(conf_dir, "authz", pool),
+                              authz, strlen(authz), NULL, pool));
+
+  url = apr_pstrcat(pool, "svn+inetd://localhost/", repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = check_tunnel_baton = &cbtable;
+  SVN_ERR(svn_cmdline_create_auth_baton(&cbtable->auth_baton,
+                                        TRUE  /* non_interactive */,
+                                        "jrandom", "rayjandom",
+                                        NULL,
+                                        TRUE  /* no_auth_cache */,
+                                        FALSE /* trust_server_cert */,
+                                        NULL, NULL, NULL, pool));
+
+  err = svn_ra_open4(&session, NULL, url, NULL, cbtable, NULL, NULL, pool);
+  if (err && err->apr_err == SVN_ERR_TEST_FAILED)
+    {
+      svn_handle_error2(err, stderr, FALSE, "svn_tests: ");
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* The session starts out anonymous.  The second file needs
+     authentication, which the pipelined command can't start. */
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/f";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/f";
+  APR_ARRAY_PUSH(paths, const char *) = "A/B/g";
+  APR_ARRAY_PUSH(streams, svn_stream_t *)
+    = svn_stream_from_stringbuf(B_f, pool);
+  APR_ARRAY_PUSH(streams, svn_stream_t *)
+    = svn_stream_from_stringbuf(BB_f, pool);
+  APR_ARRAY_PUSH(streams, svn_stream_t *)
+    = svn_stream_from_stringbuf(B_g, pool);
+  SVN_ERR(svn_ra_get_file_many(session, paths, 1, streams, &fetched_rev,
+                               &props, pool));
+  SVN_TEST_ASSERT(fetched_rev == 1);
+  SVN_TEST_ASSERT(apr_hash_count(props) == 3);
+  SVN_TEST_STRING_ASSERT(B_f->data, B_f_contents);
+  SVN_TEST_STRING_ASSERT(BB_f->data, BB_f_contents);
+  SVN_TEST_ASSERT(B_g->len == 0);
+
+  /* Now authenticated, A/BB is readable in pipelined commands, too. */
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/g";
+  SVN_ERR(svn_ra_stat_many(session, paths, 1, &dirents, pool));
+  SVN_TEST_ASSERT(apr_hash_count(dirents) == 2);
+  dirent = svn_hash_gets(dirents, "A/BB/g");
+  SVN_TEST_ASSERT(dirent && dirent->kind == svn_node_file);
+
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  SVN_ERR(svn_ra_get_dir_many(session, &dirents, &fetched_rev, NULL,
+                              paths, 1, SVN_DIRENT_KIND, pool));
+  entries = svn_hash_gets(dirents, "A/BB");
+  SVN_TEST_ASSERT(entries && apr_hash_count(entries) == 2);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -581,6 +849,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test ra_svn tunnel creation callbacks"),
     SVN_TEST_OPTS_PASS(lock_test,
                        "lock multiple paths"),
+    SVN_TEST_OPTS_PASS(many_paths_test,
+                       "batched stat, get-file and get-dir"),
+    SVN_TEST_OPTS_PASS(many_paths_tunnel_test,
+                       "pipelined stat, get-file and get-dir over ra_svn"),
+    SVN_TEST_OPTS_PASS(many_paths_auth_test,
+                       "pipelined commands that need authentication"),
     SVN_TEST_NULL
   };
 
@@ -37,6 +37,7 @@
 #include "svn_props.h"
 #include "svn_version.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_fspath.h"
 
 /* be able to look into svn_config_t */
 #include "../../libsvn_subr/config_impl.h"
@@ -1393,6 +1394,96 @@ authz(apr_pool_t *pool)
 }
 
 
+/* Helper for the authz_many_users test.  Verify that USER gets the
+   REQUIRED access to PATH in the "greek" repository from AUTHZ_CFG iff
+   EXPECTED is set. */
+static svn_error_t *
+authz_check_user_access(svn_authz_t *authz_cfg,
+                        const char *path,
+                        const char *user,
+                        svn_repos_authz_access_t required,
+                        svn_boolean_t expected,
+                        apr_pool_t *pool)
+{
+  svn_boolean_t access_granted;
+
+  SVN_ERR(svn_repos_authz_check_access(authz_cfg, "greek", path, user,
+                                       required, &access_granted, pool));
+  if (access_granted != expected)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                             "Authz incorrectly %s access %d to %s "
+                             "for user %s",
+                             access_granted ? "grants" : "denies",
+                             (int)required, path ? path : "(any)", user);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test authz with more users than get their rules compiled and cached,
+   checking each user repeatedly. */
+static svn_error_t *
+authz_many_users(apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *members = svn_stringbuf_create_empty(pool);
+  svn_authz_t *authz_cfg;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int round, i;
+
+  /* Even users may read /A, except for /A/secret which only user0 may
+     read.  Odd users may read and write /B. */
+  for (i = 0; i < 100; i += 2)
+    svn_stringbuf_appendcstr(members, apr_psprintf(pool, "%suser%d",
+                                                   i ? ", " : "", i));
+
+  svn_stringbuf_appendcstr(contents,
+    apr_pstrcat(pool,
+                "[groups]"                                                   NL
+                "even = ", members->data,                                    NL
+                ""                                                           NL
+                "[/A]"                                                       NL
+                "@even = r"                                                  NL
+                ""                                                           NL
+                "[greek:/A/secret]"                                          NL
+                "* ="                                                        NL
+                "user0 = r"                                                  NL
+                ""                                                           NL
+                "[/B]"                                                       NL
+                "~@even = rw"                                                NL,
+                SVN_VA_NULL));
+
+  SVN_ERR(authz_get_handle(&authz_cfg, contents->data, FALSE, pool));
+
+  for (round = 0; round < 2; ++round)
+    for (i = 0; i < 100; ++i)
+      {
+        const char *user;
+        svn_boolean_t even = (i % 2) == 0;
+
+        svn_pool_clear(iterpool);
+        user = apr_psprintf(iterpool, "user%d", i);
+
+        SVN_ERR(authz_check_user_access(authz_cfg, "/A", user,
+                                        svn_authz_read, even, iterpool));
+        SVN_ERR(authz_check_user_access(authz_cfg, "/A/B", user,
+                                        svn_authz_read, even, iterpool));
+        SVN_ERR(authz_check_user_access(authz_cfg, "/A/secret", user,
+                                        svn_authz_read, i == 0, iterpool));
+        SVN_ERR(authz_check_user_access(authz_cfg, "/A", user,
+                                        svn_authz_read | svn_authz_recursive,
+                                        i == 0, iterpool));
+        SVN_ERR(authz_check_user_access(authz_cfg, "/B", user,
+                                        svn_authz_write, !even, iterpool));
+        SVN_ERR(authz_check_user_access(authz_cfg, NULL, user,
+                                        svn_authz_write, !even, iterpool));
+      }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Test in-repo authz paths */
 static svn_error_t *
 in_repo_authz(const svn_test_opts_t *opts,
@@ -2739,6 +2830,111 @@ reporter_depth_exclude(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_authz_func_t for reporter_authz_subtree.
+   Everything but /A/B is readable.  Fail if called for any path within
+   the fully readable subtrees /A/C and /A/D. */
+static svn_error_t *
+subtree_test_read_func(svn_boolean_t *allowed,
+                       svn_fs_root_t *root,
+                       const char *path,
+                       void *baton,
+                       apr_pool_t *pool)
+{
+  const char *c_relpath = svn_fspath__skip_ancestor("/A/C", path);
+  const char *d_relpath = svn_fspath__skip_ancestor("/A/D", path);
+
+  if ((c_relpath && *c_relpath) || (d_relpath && *d_relpath))
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                             "Unexpected authz check for '%s'", path);
+
+  *allowed = svn_fspath__skip_ancestor("/A/B", path) == NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_authz_callback_t for reporter_authz_subtree.
+   Only subtrees that neither are nor contain /A/B are readable. */
+static svn_error_t *
+subtree_test_subtree_func(svn_repos_authz_access_t required,
+                          svn_boolean_t *allowed,
+                          svn_fs_root_t *root,
+                          const char *path,
+                          void *baton,
+                          apr_pool_t *pool)
+{
+  SVN_TEST_ASSERT(required == (svn_authz_read | svn_authz_recursive));
+
+  *allowed = svn_fspath__skip_ancestor(path, "/A/B") == NULL
+          && svn_fspath__skip_ancestor("/A/B", path) == NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Test that the reporter skips per-node authz checks in subtrees that
+   are readable as a whole. */
+static svn_error_t *
+reporter_authz_subtree(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *report_baton;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-reporter-authz-subtree",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+
+  /* Update from r0 to r1 and record the result in a txn based on r0. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                               txn_root, "", pool));
+
+  SVN_ERR(svn_repos_begin_report3(&report_baton, youngest_rev, repos,
+                                  "/", "", NULL, TRUE, svn_depth_infinity,
+                                  FALSE, FALSE, editor, edit_baton,
+                                  subtree_test_read_func, NULL, 0, pool));
+  svn_repos__report_set_authz_subtree_func(report_baton,
+                                           subtree_test_subtree_func, NULL);
+  SVN_ERR(svn_repos_set_path3(report_baton, "", 0, svn_depth_infinity,
+                              FALSE, NULL, pool));
+  SVN_ERR(svn_repos_finish_report(report_baton, pool));
+
+  /* Everything but A/B must have been sent. */
+  {
+    static svn_test__tree_entry_t entries[] = {
+      { "iota",        "This is the file 'iota'.\n" },
+      { "A",           0 },
+      { "A/mu",        "This is the file 'mu'.\n" },
+      { "A/C",         0 },
+      { "A/D",         0 },
+      { "A/D/gamma",   "This is the file 'gamma'.\n" },
+      { "A/D/G",       0 },
+      { "A/D/G/pi",    "This is the file 'pi'.\n" },
+      { "A/D/G/rho",   "This is the file 'rho'.\n" },
+      { "A/D/G/tau",   "This is the file 'tau'.\n" },
+      { "A/D/H",       0 },
+      { "A/D/H/chi",   "This is the file 'chi'.\n" },
+      { "A/D/H/psi",   "This is the file 'psi'.\n" },
+      { "A/D/H/omega", "This is the file 'omega'.\n" }
+    };
+    SVN_ERR(svn_test__validate_tree(txn_root,
+                                    entries,
+                                    sizeof(entries)/sizeof(entries[0]),
+                                    pool));
+  }
+
+  return svn_error_trace(svn_fs_abort_txn(txn, pool));
+}
+
 
 
 /* Test if prop values received by the server are validated.
@@ -3517,6 +3713,56 @@ test_config_pool(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_repos_pool(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_repos_t *repos, *repos1, *repos2, *repos3;
+  svn_repos__repos_pool_t *repos_pool;
+  svn_fs_access_t *access_ctx;
+  const char *path;
+  svn_error_t *err;
+  apr_pool_t *subpool1 = svn_pool_create(pool);
+  apr_pool_t *subpool2 = svn_pool_create(pool);
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-repos-pool",
+                                 opts, pool));
+  path = svn_repos_path(repos, pool);
+  SVN_ERR(svn_repos__repos_pool_create(&repos_pool, NULL, TRUE, pool));
+
+  /* Leave some per-user state in the first instance. */
+  SVN_ERR(svn_repos__repos_pool_get(&repos1, repos_pool, path,
+                                    subpool1, pool));
+  SVN_ERR(svn_fs_create_access(&access_ctx, "jrandom", subpool1));
+  SVN_ERR(svn_fs_set_access(svn_repos_fs(repos1), access_ctx));
+  svn_pool_clear(subpool1);
+
+  /* Released instances get reused and have been reset. */
+  SVN_ERR(svn_repos__repos_pool_get(&repos2, repos_pool, path,
+                                    subpool1, pool));
+  SVN_TEST_ASSERT(repos2 == repos1);
+  SVN_ERR(svn_fs_get_access(&access_ctx, svn_repos_fs(repos2)));
+  SVN_TEST_ASSERT(access_ctx == NULL);
+
+  /* Instances in use never get handed out twice. */
+  SVN_ERR(svn_repos__repos_pool_get(&repos3, repos_pool, path,
+                                    subpool2, pool));
+  SVN_TEST_ASSERT(repos3 != repos2);
+  SVN_TEST_STRING_ASSERT(svn_repos_path(repos3, pool),
+                         svn_repos_path(repos2, pool));
+
+  svn_pool_destroy(subpool1);
+  svn_pool_destroy(subpool2);
+
+  /* Paths that are not repositories still yield the usual error. */
+  err = svn_repos__repos_pool_get(&repos1, repos_pool, "not-a-repos",
+                                  pool, pool);
+  SVN_TEST_ASSERT(err);
+  svn_error_clear(err);
+
+  return SVN_NO_ERROR;
+}
+
 
 static svn_error_t *
 test_repos_fs_type(const svn_test_opts_t *opts,
@@ -3560,6 +3806,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test removal of defunct locks"),
     SVN_TEST_PASS2(authz,
                    "test authz access control"),
+    SVN_TEST_PASS2(authz_many_users,
+                   "test authz access control for many users"),
     SVN_TEST_OPTS_PASS(in_repo_authz,
                        "test authz stored in the repo"),
     SVN_TEST_OPTS_PASS(in_repo_groups_authz,
@@ -3574,6 +3822,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_repos_node_location_segments"),
     SVN_TEST_OPTS_PASS(reporter_depth_exclude,
                        "test reporter and svn_depth_exclude"),
+    SVN_TEST_OPTS_PASS(reporter_authz_subtree,
+                       "test reporter with readable authz subtrees"),
     SVN_TEST_OPTS_PASS(prop_validation,
                        "test if revprops are validated by repos"),
     SVN_TEST_OPTS_PASS(get_logs,
@@ -3590,6 +3840,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_repos_info_*"),
     SVN_TEST_OPTS_PASS(test_config_pool,
                        "test svn_repos__config_pool_*"),
+    SVN_TEST_OPTS_PASS(test_repos_pool,
+                       "test svn_repos__repos_pool_*"),
     SVN_TEST_OPTS_PASS(test_repos_fs_type,
                        "test test_repos_fs_type"),
     SVN_TEST_NULL
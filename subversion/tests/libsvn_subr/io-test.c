@@ -30,7 +30,9 @@
 
 #include "svn_pools.h"
 #include "svn_string.h"
+#include "svn_io.h"
 #include "private/svn_skel.h"
+#include "private/svn_io_private.h"
 #include "private/svn_dep_compat.h"
 
 #include "../svn_test.h"
@@ -680,6 +682,56 @@ aligned_seek_test(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+copy_file_contents_test(apr_pool_t *pool)
+{
+  apr_size_t i;
+  const char *tmp_dir;
+  const char *src_file;
+  const char *dst_file;
+  apr_file_t *from_file;
+  apr_file_t *to_file;
+  svn_stringbuf_t *contents;
+  svn_stringbuf_t *copy;
+  svn_filesize_t shared_bytes;
+  const apr_size_t file_size = 300000;
+
+  /* create a temp folder & schedule it for automatic cleanup */
+
+  SVN_ERR(svn_dirent_get_absolute(&tmp_dir, "copy_contents_tmp", pool));
+  SVN_ERR(svn_io_remove_dir2(tmp_dir, TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_io_make_dir_recursively(tmp_dir, pool));
+  svn_test_add_dir_cleanup(tmp_dir);
+
+  contents = svn_stringbuf_create_ensure(file_size, pool);
+  for (i = 0; i < file_size; ++i)
+    svn_stringbuf_appendbyte(contents, (char)rand());
+
+  SVN_ERR(svn_io_write_unique(&src_file, tmp_dir, contents->data,
+                              contents->len,
+                              svn_io_file_del_on_pool_cleanup, pool));
+
+  /* Clone or copy into a fresh file.  Whether the data gets shared depends
+     on the filesystem the test runs on, but either way it must be all or
+     nothing. */
+  SVN_ERR(svn_io_file_open(&from_file, src_file, APR_READ | APR_BUFFERED,
+                           APR_OS_DEFAULT, pool));
+  SVN_ERR(svn_io_open_unique_file3(&to_file, &dst_file, tmp_dir,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   pool, pool));
+  SVN_ERR(svn_io__copy_file_contents(&shared_bytes, from_file, to_file,
+                                     NULL, NULL, pool));
+  SVN_ERR(svn_io_file_close(from_file, pool));
+  SVN_ERR(svn_io_file_close(to_file, pool));
+
+  SVN_TEST_ASSERT(shared_bytes == 0 || shared_bytes == file_size);
+
+  SVN_ERR(svn_stringbuf_from_file2(&copy, dst_file, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(contents, copy));
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -700,6 +752,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "svn_io_read_length_line() shouldn't loop"),
     SVN_TEST_PASS2(aligned_seek_test,
                    "test aligned seek"),
+    SVN_TEST_PASS2(copy_file_contents_test,
+                   "test svn_io__copy_file_contents"),
     SVN_TEST_NULL
   };
 
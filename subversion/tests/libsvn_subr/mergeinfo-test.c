@@ -1669,6 +1669,115 @@ test_remove_prefix_from_catalog(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Merge and parse rangelists with many ranges.  With quadratic
+   algorithms, this would take ages. */
+static svn_error_t *
+test_rangelist_merge_large(apr_pool_t *pool)
+{
+  enum { RANGE_COUNT = 50000 };
+  svn_rangelist_t *rangelist, *changes;
+  svn_stringbuf_t *revisions = svn_stringbuf_create_empty(pool);
+  svn_merge_range_t *range;
+  int i;
+
+  /* Interleave inheritable odd with non-inheritable even revisions. */
+  rangelist = apr_array_make(pool, RANGE_COUNT, sizeof(svn_merge_range_t *));
+  changes = apr_array_make(pool, RANGE_COUNT, sizeof(svn_merge_range_t *));
+  for (i = 0; i < RANGE_COUNT; i++)
+    {
+      range = apr_palloc(pool, sizeof(*range));
+      range->start = 2 * i;
+      range->end = 2 * i + 1;
+      range->inheritable = TRUE;
+      APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = range;
+
+      range = apr_palloc(pool, sizeof(*range));
+      range->start = 2 * i + 1;
+      range->end = 2 * i + 2;
+      range->inheritable = FALSE;
+      APR_ARRAY_PUSH(changes, svn_merge_range_t *) = range;
+    }
+
+  SVN_ERR(svn_rangelist_merge2(rangelist, changes, pool, pool));
+  SVN_TEST_ASSERT(rangelist->nelts == 2 * RANGE_COUNT);
+  for (i = 0; i < rangelist->nelts; i++)
+    {
+      range = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+      SVN_TEST_ASSERT(range->start == i && range->end == i + 1);
+      SVN_TEST_ASSERT(range->inheritable == (i % 2 == 0));
+    }
+
+  /* Merging an inheritable range covering everything collapses them. */
+  SVN_ERR(svn_rangelist_merge2(rangelist,
+                               svn_rangelist__initialize(0, 2 * RANGE_COUNT,
+                                                         TRUE, pool),
+                               pool, pool));
+  SVN_TEST_ASSERT(rangelist->nelts == 1);
+  range = APR_ARRAY_IDX(rangelist, 0, svn_merge_range_t *);
+  SVN_TEST_ASSERT(range->start == 0 && range->end == 2 * RANGE_COUNT
+                  && range->inheritable);
+
+  /* Parsing combines adjacent revisions. */
+  for (i = 1; i <= RANGE_COUNT; i++)
+    svn_stringbuf_appendcstr(revisions, apr_psprintf(pool, "%s%d",
+                                                     i > 1 ? "," : "", i));
+  SVN_ERR(svn_rangelist__parse(&rangelist, revisions->data, pool));
+  SVN_TEST_ASSERT(rangelist->nelts == 1);
+  range = APR_ARRAY_IDX(rangelist, 0, svn_merge_range_t *);
+  SVN_TEST_ASSERT(range->start == 0 && range->end == RANGE_COUNT
+                  && range->inheritable);
+
+  return SVN_NO_ERROR;
+}
+
+/* Parse the same large mergeinfo twice.  The second parse should be
+   served from the parse cache yet return an independent copy. */
+static svn_error_t *
+test_mergeinfo_parse_cache(apr_pool_t *pool)
+{
+  svn_stringbuf_t *input = svn_stringbuf_create_empty(pool);
+  const char *path;
+  svn_mergeinfo_t first, second;
+  svn_rangelist_t *rangelist;
+  apr_uint64_t hits, misses, new_hits, new_misses;
+  svn_boolean_t equal;
+  int i;
+
+  /* Make the input unique to this test run and long enough to be cached. */
+  path = apr_psprintf(pool, "/parse-cache/%p", (void *)input);
+  svn_stringbuf_appendcstr(input, path);
+  svn_stringbuf_appendbyte(input, ':');
+  for (i = 1; i <= 200; i++)
+    svn_stringbuf_appendcstr(input, apr_psprintf(pool, "%s%d",
+                                                 i > 1 ? "," : "", 2 * i));
+
+  SVN_ERR(svn_mergeinfo__get_parse_cache_stats(&hits, &misses));
+  SVN_ERR(svn_mergeinfo_parse(&first, input->data, pool));
+  SVN_ERR(svn_mergeinfo__get_parse_cache_stats(&new_hits, &new_misses));
+  SVN_TEST_ASSERT(new_misses > misses);
+
+  SVN_ERR(svn_mergeinfo_parse(&second, input->data, pool));
+  SVN_ERR(svn_mergeinfo__get_parse_cache_stats(&hits, &misses));
+  SVN_TEST_ASSERT(hits > new_hits);
+
+  SVN_ERR(svn_mergeinfo__equals(&equal, first, second, TRUE, pool));
+  SVN_TEST_ASSERT(equal);
+
+  /* Modifying one result must affect neither the other nor the cache. */
+  rangelist = svn_hash_gets(first, path);
+  SVN_TEST_ASSERT(rangelist && rangelist->nelts == 200);
+  APR_ARRAY_IDX(rangelist, 0, svn_merge_range_t *)->inheritable = FALSE;
+
+  SVN_ERR(svn_mergeinfo__equals(&equal, first, second, TRUE, pool));
+  SVN_TEST_ASSERT(!equal);
+
+  SVN_ERR(svn_mergeinfo_parse(&first, input->data, pool));
+  SVN_ERR(svn_mergeinfo__equals(&equal, first, second, TRUE, pool));
+  SVN_TEST_ASSERT(equal);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -1709,6 +1818,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "turning mergeinfo back into a string"),
     SVN_TEST_PASS2(test_rangelist_merge,
                    "merge of rangelists"),
+    SVN_TEST_PASS2(test_rangelist_merge_large,
+                   "merge of rangelists with many ranges"),
+    SVN_TEST_PASS2(test_mergeinfo_parse_cache,
+                   "repeated parsing of large mergeinfo"),
     SVN_TEST_PASS2(test_rangelist_diff,
                    "diff of rangelists"),
     SVN_TEST_PASS2(test_remove_prefix_from_catalog,
@@ -215,6 +215,104 @@ utf_validate2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Compare the implementations using long, mostly ASCII strings with a
+   few (possibly broken) multi-byte chars at random positions and with
+   random alignment.  This covers the chunky ASCII scanners.  In verbose
+   mode, also report the time taken by the validators. */
+static svn_error_t *
+utf_validate_long(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  enum { BUFFER_SIZE = 4096 };
+  static const char * const sequences[] = {
+    "\xC5\x81", "\xE5\x81\x81", "\xF2\x91\x81\x81",
+    "\xE0\x9F\x81", "\xC0", "\x80", "\xF4\x91"
+  };
+  char *buffer = apr_palloc(pool, BUFFER_SIZE + 1);
+  apr_time_t validate_time = 0;
+  apr_size_t total = 0;
+  int i;
+
+  seed_val();
+
+  for (i = 0; i < 10000; ++i)
+    {
+      apr_size_t offset = range_rand(0, 15);
+      apr_size_t len = range_rand(0, BUFFER_SIZE - 16 - 4);
+      apr_size_t count = range_rand(0, 3);
+      char *str = buffer + offset;
+      apr_time_t start;
+      svn_boolean_t valid, cvalid;
+      const char *last;
+      apr_size_t j;
+
+      for (j = 0; j < len; ++j)
+        str[j] = (char)range_rand(1, 127);
+
+      for (j = 0; j < count && len > 4; ++j)
+        {
+          const char *seq = sequences[range_rand(0, 6)];
+          memcpy(str + range_rand(0, (apr_uint32_t)len - 4), seq,
+                 strlen(seq));
+        }
+      str[len] = 0;
+
+      start = apr_time_now();
+      valid = svn_utf__is_valid(str, len);
+      cvalid = svn_utf__cstring_is_valid(str);
+      last = svn_utf__last_valid(str, len);
+      validate_time += apr_time_now() - start;
+      total += len;
+
+      if (last != svn_utf__last_valid2(str, len)
+          || valid != (last == str + len)
+          || cvalid != valid)
+        return svn_error_createf
+          (SVN_ERR_TEST_FAILED, NULL, "validate_long test %d failed", i);
+    }
+
+  if (opts->verbose)
+    printf("validated %" APR_SIZE_T_FMT " bytes 3x in %" APR_TIME_T_FMT
+           " usec\n", total, validate_time);
+
+  return SVN_NO_ERROR;
+}
+
+/* Check that pure ASCII data, including control chars, survives the
+   conversions to and from the native encoding unchanged. */
+static svn_error_t *
+test_utf_ascii_conversion(apr_pool_t *pool)
+{
+  const char *ascii = "plain/ascii path\twith\x01control chars\n";
+  const svn_string_t *string = svn_string_create(ascii, pool);
+  svn_stringbuf_t *stringbuf = svn_stringbuf_create(ascii, pool);
+  const svn_string_t *string_result;
+  svn_stringbuf_t *stringbuf_result;
+  const char *result;
+
+  SVN_ERR(svn_utf_cstring_to_utf8(&result, ascii, pool));
+  SVN_TEST_STRING_ASSERT(result, ascii);
+  SVN_ERR(svn_utf_cstring_from_utf8(&result, ascii, pool));
+  SVN_TEST_STRING_ASSERT(result, ascii);
+  SVN_ERR(svn_utf_cstring_from_utf8_string(&result, string, pool));
+  SVN_TEST_STRING_ASSERT(result, ascii);
+
+  SVN_ERR(svn_utf_string_to_utf8(&string_result, string, pool));
+  SVN_TEST_ASSERT(svn_string_compare(string_result, string));
+  SVN_ERR(svn_utf_string_from_utf8(&string_result, string, pool));
+  SVN_TEST_ASSERT(svn_string_compare(string_result, string));
+
+  SVN_ERR(svn_utf_stringbuf_to_utf8(&stringbuf_result, stringbuf, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(stringbuf_result, stringbuf));
+  SVN_ERR(svn_utf_stringbuf_from_utf8(&stringbuf_result, stringbuf, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(stringbuf_result, stringbuf));
+
+  SVN_TEST_ASSERT(svn_utf__is_ascii(ascii, strlen(ascii)));
+  SVN_TEST_ASSERT(!svn_utf__is_ascii("Edelwei\xc3\x9f", 9));
+
+  return SVN_NO_ERROR;
+}
+
 /* Test conversion from different codepages to utf8. */
 static svn_error_t *
 test_utf_cstring_to_utf8_ex2(apr_pool_t *pool)
@@ -749,6 +847,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test is_valid/last_valid"),
     SVN_TEST_PASS2(utf_validate2,
                    "test last_valid/last_valid2"),
+    SVN_TEST_OPTS_PASS(utf_validate_long,
+                       "test validation of long mixed strings"),
+    SVN_TEST_PASS2(test_utf_ascii_conversion,
+                   "test ASCII conversion fast path"),
     SVN_TEST_PASS2(test_utf_cstring_to_utf8_ex2,
                    "test svn_utf_cstring_to_utf8_ex2"),
     SVN_TEST_PASS2(test_utf_cstring_from_utf8_ex2,
@@ -39,6 +39,7 @@
 #include "svn_repos.h"
 #include "svn_wc.h"
 #include "svn_client.h"
+#include "svn_config.h"
 
 #include "utils.h"
 
@@ -170,6 +171,509 @@ pristine_write_read(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Exercise storing and reading back a compressed pristine text. */
+static svn_error_t *
+pristine_compressed(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  svn_config_t *config;
+  const char *wc_abspath;
+
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  apr_size_t sz;
+
+  const char data[] = "Blah blah blah blah blah blah blah blah\n";
+  svn_string_t *data_string = svn_string_create(data, pool);
+  svn_checksum_t *data_sha1, *data_md5;
+
+  SVN_ERR(create_repos_and_wc(&wc_abspath, &db,
+                              "pristine_compressed", opts, pool));
+
+  /* Use a separate DB context that compresses pristines. */
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set_bool(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                      SVN_CONFIG_OPTION_COMPRESS_PRISTINES, TRUE);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  {
+    svn_boolean_t present;
+
+    SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                      pool));
+    SVN_TEST_ASSERT(present);
+  }
+
+  /* Reading it back streams the decompressed text and reports its
+     uncompressed size. */
+  {
+    svn_stream_t *data_stream = svn_stream_from_string(data_string, pool);
+    svn_stream_t *data_read_back;
+    svn_filesize_t size;
+    svn_boolean_t same;
+
+    SVN_ERR(svn_wc__db_pristine_read(&data_read_back, &size, db, wc_abspath,
+                                     data_sha1, pool, pool));
+    SVN_TEST_ASSERT(size == (svn_filesize_t)strlen(data));
+    SVN_ERR(svn_stream_contents_same2(&same, data_read_back, data_stream,
+                                      pool));
+    SVN_TEST_ASSERT(same);
+  }
+
+  /* The same without going through the database. */
+  {
+    svn_stream_t *data_stream = svn_stream_from_string(data_string, pool);
+    svn_stream_t *data_read_back;
+    svn_boolean_t same;
+
+    SVN_ERR(svn_wc__db_pristine_open_future(&data_read_back, wc_abspath,
+                                            data_sha1, pool, pool));
+    SVN_ERR(svn_stream_contents_same2(&same, data_read_back, data_stream,
+                                      pool));
+    SVN_TEST_ASSERT(same);
+  }
+
+  /* Path based access gets a decompressed copy. */
+  {
+    const char *pristine_abspath;
+    svn_stringbuf_t *contents;
+
+    SVN_ERR(svn_wc__db_pristine_get_path(&pristine_abspath, db, wc_abspath,
+                                         data_sha1, pool, pool));
+    SVN_ERR(svn_stringbuf_from_file2(&contents, pristine_abspath, pool));
+    SVN_TEST_STRING_ASSERT(contents->data, data);
+  }
+
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc_abspath, data_sha1, pool));
+
+  {
+    svn_boolean_t present;
+
+    SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                      pool));
+    SVN_TEST_ASSERT(! present);
+  }
+
+  return svn_error_trace(svn_wc__db_close(db));
+}
+
+/* Install DATA into the pristine store of the working copy at WC_ABSPATH
+ * using DB, and set *SHA1_CHECKSUM and *MD5_CHECKSUM to its checksums. */
+static svn_error_t *
+install_text(svn_checksum_t **sha1_checksum,
+             svn_checksum_t **md5_checksum,
+             svn_wc__db_t *db,
+             const char *wc_abspath,
+             const char *data,
+             apr_pool_t *pool)
+{
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  apr_size_t sz = strlen(data);
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              sha1_checksum, md5_checksum,
+                                              db, wc_abspath,
+                                              pool, pool));
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+
+  return svn_error_trace(svn_wc__db_pristine_install(install_data,
+                                                     *sha1_checksum,
+                                                     *md5_checksum, pool));
+}
+
+/* Replace the WC context of B with one that stores pristine texts
+ * compressed. */
+static svn_error_t *
+use_compressed_pristines(svn_test__sandbox_t *b)
+{
+  svn_config_t *config;
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, b->pool));
+  svn_config_set_bool(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                      SVN_CONFIG_OPTION_COMPRESS_PRISTINES, TRUE);
+  SVN_ERR(svn_wc_context_destroy(b->wc_ctx));
+  SVN_ERR(svn_wc_context_create(&b->wc_ctx, config, b->pool, b->pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that the file PATH in B has the contents EXPECTED. */
+static svn_error_t *
+check_file_text(svn_test__sandbox_t *b,
+                const char *path,
+                const char *expected)
+{
+  svn_stringbuf_t *contents;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, sbox_wc_path(b, path),
+                                   b->pool));
+  SVN_TEST_STRING_ASSERT(contents->data, expected);
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that no decompressed pristine copies were left behind in the
+ * temporary directory of the WC in B. */
+static svn_error_t *
+check_no_tmp_files(svn_test__sandbox_t *b)
+{
+  const char *tmpdir_abspath;
+  apr_hash_t *dirents;
+
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&tmpdir_abspath, b->wc_ctx->db,
+                                         b->wc_abspath, b->pool, b->pool));
+  SVN_ERR(svn_io_get_dirents3(&dirents, tmpdir_abspath, TRUE,
+                              b->pool, b->pool));
+  SVN_TEST_ASSERT(apr_hash_count(dirents) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+/* Update and merge local modifications with compressed pristine texts. */
+static svn_error_t *
+pristine_compressed_update(const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  int format;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "pristine_compressed_update",
+                                   opts, pool));
+  SVN_ERR(use_compressed_pristines(&b));
+
+  SVN_ERR(svn_wc__db_temp_get_format(&format, b.wc_ctx->db, b.wc_abspath,
+                                     pool));
+  SVN_TEST_ASSERT(format == SVN_WC__VERSION);
+
+  sbox_file_write(&b, "f", "one\ntwo\nthree\n");
+  SVN_ERR(sbox_wc_add(&b, "f"));
+  SVN_ERR(sbox_wc_commit(&b, ""));
+  sbox_file_write(&b, "f", "one\ntwo\nthree changed\n");
+  SVN_ERR(sbox_wc_commit(&b, ""));
+
+  /* Storing the first compressed text marked the working copy. */
+  SVN_ERR(svn_wc__db_temp_get_format(&format, b.wc_ctx->db, b.wc_abspath,
+                                     pool));
+  SVN_TEST_ASSERT(format == SVN_WC__COMPRESSED_PRISTINES);
+
+  /* A clean merge of the incoming change into a local modification. */
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+  sbox_file_write(&b, "f", "one changed\ntwo\nthree\n");
+  SVN_ERR(sbox_wc_update(&b, "", 2));
+  SVN_ERR(check_file_text(&b, "f", "one changed\ntwo\nthree changed\n"));
+  SVN_ERR(check_no_tmp_files(&b));
+
+  /* A conflicting merge; the work queue copies both pristine texts into
+     the conflict files. */
+  SVN_ERR(sbox_wc_revert(&b, "f", svn_depth_empty));
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+  sbox_file_write(&b, "f", "one\ntwo\nthree mine\n");
+  SVN_ERR(sbox_wc_update(&b, "", 2));
+  {
+    svn_boolean_t text_conflicted;
+
+    SVN_ERR(svn_wc__internal_conflicted_p(&text_conflicted, NULL, NULL,
+                                          b.wc_ctx->db, sbox_wc_path(&b, "f"),
+                                          pool));
+    SVN_TEST_ASSERT(text_conflicted);
+  }
+  SVN_ERR(check_file_text(&b, "f.r1", "one\ntwo\nthree\n"));
+  SVN_ERR(check_file_text(&b, "f.r2", "one\ntwo\nthree changed\n"));
+  SVN_ERR(check_file_text(&b, "f.mine", "one\ntwo\nthree mine\n"));
+  SVN_ERR(check_no_tmp_files(&b));
+
+  return SVN_NO_ERROR;
+}
+
+/* Update a moved file with compressed pristine texts, merging the incoming
+ * change into the move destination. */
+static svn_error_t *
+pristine_compressed_move_update(const svn_test_opts_t *opts,
+                                apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "pristine_compressed_move_update",
+                                   opts, pool));
+  SVN_ERR(use_compressed_pristines(&b));
+
+  SVN_ERR(sbox_wc_mkdir(&b, "A"));
+  sbox_file_write(&b, "A/f", "one\ntwo\nthree\n");
+  SVN_ERR(sbox_wc_add(&b, "A/f"));
+  SVN_ERR(sbox_wc_commit(&b, ""));
+  sbox_file_write(&b, "A/f", "one\ntwo\nthree changed\n");
+  SVN_ERR(sbox_wc_commit(&b, ""));
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+
+  SVN_ERR(sbox_wc_move(&b, "A", "A2"));
+  sbox_file_write(&b, "A2/f", "one changed\ntwo\nthree\n");
+
+  /* The update raises a tree conflict on A; resolving it merges the
+     incoming change into A2/f. */
+  SVN_ERR(sbox_wc_update(&b, "", 2));
+  SVN_ERR(sbox_wc_resolve(&b, "A", svn_depth_empty,
+                          svn_wc_conflict_choose_mine_conflict));
+  SVN_ERR(check_file_text(&b, "A2/f",
+                          "one changed\ntwo\nthree changed\n"));
+  SVN_ERR(check_no_tmp_files(&b));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test sharing pristine texts between working copies. */
+static svn_error_t *
+pristine_shared(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  svn_config_t *config;
+  const char *wc1_abspath, *wc2_abspath;
+  const char *store_abspath;
+  svn_stream_t *contents;
+
+  const char data[] = "Shared blah\n";
+  svn_checksum_t *data_sha1, *data_md5;
+
+  SVN_ERR(create_repos_and_wc(&wc1_abspath, &db,
+                              "pristine_shared_1", opts, pool));
+  SVN_ERR(create_repos_and_wc(&wc2_abspath, &db,
+                              "pristine_shared_2", opts, pool));
+
+  store_abspath = svn_dirent_join(svn_dirent_dirname(wc1_abspath, pool),
+                                  "pristine_shared-store", pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+
+  /* Use a separate DB context that uses the shared store. */
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db,
+                                          svn_checksum_create(
+                                            svn_checksum_sha1, pool),
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents == NULL);
+
+  /* Installing a text in one working copy makes it available to others. */
+  SVN_ERR(install_text(&data_sha1, &data_md5, db, wc1_abspath, data, pool));
+
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  if (contents == NULL)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "Hard links are not supported here");
+  {
+    svn_stringbuf_t *buf;
+
+    SVN_ERR(svn_stringbuf_from_stream(&buf, contents, 0, pool));
+    SVN_ERR(svn_stream_close(contents));
+    SVN_TEST_STRING_ASSERT(buf->data, data);
+  }
+
+  SVN_ERR(install_text(&data_sha1, &data_md5, db, wc2_abspath, data, pool));
+
+  /* The text stays shared until the last working copy removes it. */
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc1_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents != NULL);
+  SVN_ERR(svn_stream_close(contents));
+
+  {
+    svn_stream_t *data_read_back;
+    svn_boolean_t same;
+
+    SVN_ERR(svn_wc__db_pristine_read(&data_read_back, NULL, db, wc2_abspath,
+                                     data_sha1, pool, pool));
+    SVN_ERR(svn_stream_contents_same2(&same, data_read_back,
+                                      svn_stream_from_string(
+                                        svn_string_create(data, pool), pool),
+                                      pool));
+    SVN_TEST_ASSERT(same);
+  }
+
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc2_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents == NULL);
+
+  return svn_error_trace(svn_wc__db_close(db));
+}
+
+/* Write TEXT to the file of the shared pristine store STORE_ABSPATH
+ * that should hold the text SHA1_CHECKSUM, as seen from WC_ABSPATH.
+ * Set *SHARED_ABSPATH to that file and *PRISTINE_ABSPATH to the
+ * working copy's own pristine file for that text. */
+static svn_error_t *
+plant_shared_text(const char **shared_abspath,
+                  const char **pristine_abspath,
+                  const char *store_abspath,
+                  const char *wc_abspath,
+                  const svn_checksum_t *sha1_checksum,
+                  const char *text,
+                  apr_pool_t *pool)
+{
+  SVN_ERR(svn_wc__db_pristine_get_future_path(pristine_abspath,
+                                              wc_abspath, sha1_checksum,
+                                              pool, pool));
+  *shared_abspath = svn_dirent_join_many(pool, store_abspath,
+                                         svn_dirent_basename(
+                                           svn_dirent_dirname(
+                                             *pristine_abspath, pool),
+                                           pool),
+                                         svn_dirent_basename(
+                                           *pristine_abspath, pool),
+                                         SVN_VA_NULL);
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(*shared_abspath,
+                                                         pool), pool));
+  return svn_error_trace(svn_io_file_create(*shared_abspath, text, pool));
+}
+
+/* Test that texts adopted from the shared pristine store are verified
+ * and that cleanup removes shared texts no working copy uses anymore. */
+static svn_error_t *
+pristine_shared_verify_cleanup(const svn_test_opts_t *opts,
+                               apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  svn_config_t *config;
+  const char *wc1_abspath, *wc2_abspath;
+  const char *store_abspath;
+  const char *shared_abspath;
+  const char *pristine_abspath;
+  svn_stream_t *contents;
+
+  const char data[] = "Shared blah\n";
+  svn_checksum_t *data_sha1, *data_md5;
+
+  SVN_ERR(create_repos_and_wc(&wc1_abspath, &db,
+                              "pristine_shared_verify_cleanup_1", opts, pool));
+  SVN_ERR(create_repos_and_wc(&wc2_abspath, &db,
+                              "pristine_shared_verify_cleanup_2", opts, pool));
+
+  store_abspath = svn_dirent_join(svn_dirent_dirname(wc1_abspath, pool),
+                                  "pristine_shared_verify_cleanup-store",
+                                  pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  /* Plant a bogus text in the shared store under the name of DATA. */
+  SVN_ERR(svn_checksum(&data_sha1, svn_checksum_sha1, data, strlen(data),
+                       pool));
+  SVN_ERR(plant_shared_text(&shared_abspath, &pristine_abspath,
+                            store_abspath, wc1_abspath, data_sha1,
+                            "Bogus\n", pool));
+
+  /* Installing the text must not adopt the bogus one, but replace it. */
+  SVN_ERR(install_text(&data_sha1, &data_md5, db, wc1_abspath, data, pool));
+  {
+    svn_stringbuf_t *buf;
+
+    SVN_ERR(svn_stringbuf_from_file2(&buf, pristine_abspath, pool));
+    SVN_TEST_STRING_ASSERT(buf->data, data);
+    SVN_ERR(svn_stringbuf_from_file2(&buf, shared_abspath, pool));
+    SVN_TEST_STRING_ASSERT(buf->data, data);
+  }
+
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  if (contents == NULL)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "Hard links are not supported here");
+  SVN_ERR(svn_stream_close(contents));
+
+  /* Losing the working copy leaves the shared text unreferenced, which
+   * cleanup of any other working copy then removes. */
+  SVN_ERR(svn_io_remove_file2(pristine_abspath, FALSE, pool));
+  SVN_ERR(svn_wc__db_pristine_cleanup(db, wc2_abspath, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents == NULL);
+
+  return svn_error_trace(svn_wc__db_close(db));
+}
+
+/* Test that a damaged text in the shared pristine store is not handed
+ * out for reading. */
+static svn_error_t *
+pristine_shared_corrupt(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  svn_config_t *config;
+  const char *wc_abspath;
+  const char *store_abspath;
+  const char *shared_abspath;
+  const char *pristine_abspath;
+  svn_stream_t *contents;
+
+  const char data[] = "Shared blah\n";
+  svn_checksum_t *data_sha1;
+
+  SVN_ERR(create_repos_and_wc(&wc_abspath, &db,
+                              "pristine_shared_corrupt", opts, pool));
+
+  store_abspath = svn_dirent_join(svn_dirent_dirname(wc_abspath, pool),
+                                  "pristine_shared_corrupt-store", pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  SVN_ERR(svn_checksum(&data_sha1, svn_checksum_sha1, data, strlen(data),
+                       pool));
+
+  /* A text of the right length but with different bytes. */
+  SVN_ERR(plant_shared_text(&shared_abspath, &pristine_abspath,
+                            store_abspath, wc_abspath, data_sha1,
+                            "Shared BLAH\n", pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents == NULL);
+
+  /* The intact text is handed out. */
+  SVN_ERR(svn_io_remove_file2(shared_abspath, FALSE, pool));
+  SVN_ERR(plant_shared_text(&shared_abspath, &pristine_abspath,
+                            store_abspath, wc_abspath, data_sha1,
+                            data, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents != NULL);
+  {
+    svn_stringbuf_t *buf;
+
+    SVN_ERR(svn_stringbuf_from_stream(&buf, contents, 0, pool));
+    SVN_ERR(svn_stream_close(contents));
+    SVN_TEST_STRING_ASSERT(buf->data, data);
+  }
+
+  return svn_error_trace(svn_wc__db_close(db));
+}
+
 /* Test deleting a pristine text while it is open for reading. */
 static svn_error_t *
 pristine_delete_while_open(const svn_test_opts_t *opts,
@@ -318,6 +822,18 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pristine_delete_while_open"),
     SVN_TEST_OPTS_PASS(reject_mismatching_text,
                        "reject_mismatching_text"),
+    SVN_TEST_OPTS_PASS(pristine_compressed,
+                       "pristine_compressed"),
+    SVN_TEST_OPTS_PASS(pristine_compressed_update,
+                       "pristine_compressed_update"),
+    SVN_TEST_OPTS_PASS(pristine_compressed_move_update,
+                       "pristine_compressed_move_update"),
+    SVN_TEST_OPTS_PASS(pristine_shared,
+                       "pristine_shared"),
+    SVN_TEST_OPTS_PASS(pristine_shared_verify_cleanup,
+                       "pristine_shared_verify_cleanup"),
+    SVN_TEST_OPTS_PASS(pristine_shared_corrupt,
+                       "pristine_shared_corrupt"),
     SVN_TEST_NULL
   };
 
@@ -0,0 +1,127 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Usage: file_throughput.py [options] svn://HOST[:PORT]/REPOS PATH...
+
+Measure the svnserve file content throughput.
+
+Fetches the contents of the given files in HEAD with 'get-file' commands,
+ROUNDS times, on PARALLEL connections and reports the resulting data rate.
+Run it from a separate machine to measure the network throughput, e.g. on
+a 10 GbE link.  To include the zero-copy code path, start svnserve with
+--client-speed set to the link speed and make sure the files fit into the
+server's fulltext cache.
+
+The repository must allow anonymous read access.
+"""
+
+import optparse
+import threading
+import time
+
+try:
+  from urllib.parse import urlparse
+except ImportError:
+  from urlparse import urlparse
+
+from idle_connections import Connection
+
+
+def read_string(conn):
+  """Read one length-prefixed string item from CONN and return its
+  length."""
+  while True:
+    data = conn.buf.lstrip()
+    colon = data.find(b':')
+    if colon >= 0:
+      break
+    conn.fill()
+  length = int(data[:colon])
+  conn.buf = data[colon + 1:]
+  while len(conn.buf) < length:
+    conn.fill()
+  conn.buf = conn.buf[length:]
+  return length
+
+
+def get_file(conn, path):
+  """Fetch the contents of PATH in HEAD and return their size."""
+  conn.write('( get-file ( %d:%s ( ) false true ) ) ' % (len(path), path))
+  conn.read_item()               # auth response
+  conn.read_item()               # file info
+  total = 0
+  while True:
+    length = read_string(conn)
+    if length == 0:
+      break
+    total += length
+  conn.read_item()               # command response
+  return total
+
+
+def fetch(conn, paths, rounds, sizes):
+  total = 0
+  for i in range(rounds):
+    for path in paths:
+      total += get_file(conn, path)
+  sizes.append(total)
+
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('-r', '--rounds', type='int', default=10,
+                    help='number of times to fetch each file [%default]')
+  parser.add_option('-p', '--parallel', type='int', default=1,
+                    help='number of parallel connections [%default]')
+  options, args = parser.parse_args()
+  if len(args) < 2:
+    parser.error('wrong number of arguments')
+
+  url = args[0]
+  paths = [path.lstrip('/') for path in args[1:]]
+  parsed = urlparse(url)
+  if parsed.scheme != 'svn':
+    parser.error('URL must use the svn:// scheme')
+  host = parsed.hostname
+  port = parsed.port or 3690
+
+  connections = [Connection(url, host, port)
+                 for i in range(options.parallel)]
+  sizes = []
+  threads = [threading.Thread(target=fetch,
+                              args=(conn, paths, options.rounds, sizes))
+             for conn in connections]
+
+  start = time.time()
+  for thread in threads:
+    thread.start()
+  for thread in threads:
+    thread.join()
+  elapsed = time.time() - start
+
+  for conn in connections:
+    conn.close()
+
+  total = sum(sizes)
+  print('%d bytes in %.2f s (%.1f MB/s)'
+        % (total, elapsed, total / elapsed / 1000000))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,185 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Usage: idle_connections.py [options] svn://HOST[:PORT]/REPOS
+
+Load test for svnserve with many mostly idle client connections.
+
+Opens IDLE connections to the repository and leaves them sitting after the
+initial handshake, similar to CI clients that keep their sessions open.
+Then, ACTIVE connections each issue REQUESTS 'get-latest-rev' commands and
+the request latencies get reported.
+
+Run svnserve in threaded mode (--threads) with a low --max-threads value
+to see whether idle connections block worker threads.  The repository
+must allow anonymous read access.  For thousands of connections, you may
+need to raise the open file limit (ulimit -n) for both processes.
+"""
+
+import optparse
+import socket
+import sys
+import threading
+import time
+
+try:
+  from urllib.parse import urlparse
+except ImportError:
+  from urlparse import urlparse
+
+CAPABILITIES = 'edit-pipeline svndiff1 absent-entries depth mergeinfo ' \
+               'log-revprops'
+
+
+class Connection(object):
+  """A minimal ra_svn client that knows just enough of the protocol to
+  open a session and send simple commands."""
+
+  def __init__(self, url, host, port):
+    self.sock = socket.create_connection((host, port))
+    self.buf = b''
+    self.read_item()
+    self.write('( 2 ( %s ) %d:%s 16:idle-connections ( ) ) '
+               % (CAPABILITIES, len(url), url))
+
+    # Authenticate anonymously.
+    auth = self.read_item()
+    if b'ANONYMOUS' not in auth:
+      raise Exception('Repository does not allow anonymous access')
+    self.write('( ANONYMOUS ( 0: ) ) ')
+    self.read_item()
+
+    # Repository info.
+    self.read_item()
+
+  def write(self, data):
+    self.sock.sendall(data.encode('ascii'))
+
+  def fill(self):
+    data = self.sock.recv(4096)
+    if not data:
+      raise Exception('Connection closed by server')
+    self.buf += data
+
+  def read_item(self):
+    """Read one complete tuple and return its raw representation."""
+    pos = 0
+    depth = 0
+    while True:
+      while pos >= len(self.buf):
+        self.fill()
+      c = self.buf[pos:pos+1]
+      if c.isdigit():
+        # Number or length-prefixed string.  The latter may contain
+        # parentheses, so skip over its contents.
+        end = pos
+        while True:
+          while end >= len(self.buf):
+            self.fill()
+          if not self.buf[end:end+1].isdigit():
+            break
+          end += 1
+        if self.buf[end:end+1] == b':':
+          end += 1 + int(self.buf[pos:end])
+          while end > len(self.buf):
+            self.fill()
+        pos = end
+      elif c == b'(':
+        depth += 1
+        pos += 1
+      elif c == b')':
+        depth -= 1
+        pos += 1
+        if depth == 0:
+          item = self.buf[:pos]
+          self.buf = self.buf[pos:]
+          return item
+      else:
+        pos += 1
+
+  def get_latest_rev(self):
+    self.write('( get-latest-rev ( ) ) ')
+    self.read_item()               # auth response
+    return self.read_item()
+
+  def close(self):
+    self.sock.close()
+
+
+def measure(conn, requests, latencies):
+  for i in range(requests):
+    start = time.time()
+    conn.get_latest_rev()
+    latencies.append(time.time() - start)
+
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('-i', '--idle', type='int', default=2000,
+                    help='number of idle connections [%default]')
+  parser.add_option('-a', '--active', type='int', default=8,
+                    help='number of active connections [%default]')
+  parser.add_option('-r', '--requests', type='int', default=100,
+                    help='requests per active connection [%default]')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('wrong number of arguments')
+
+  url = args[0]
+  parsed = urlparse(url)
+  if parsed.scheme != 'svn':
+    parser.error('URL must use the svn:// scheme')
+  host = parsed.hostname
+  port = parsed.port or 3690
+
+  start = time.time()
+  idle = [Connection(url, host, port) for i in range(options.idle)]
+  print('%d idle connections opened in %.2f s'
+        % (len(idle), time.time() - start))
+
+  active = [Connection(url, host, port) for i in range(options.active)]
+  latencies = []
+  threads = [threading.Thread(target=measure,
+                              args=(conn, options.requests, latencies))
+             for conn in active]
+
+  start = time.time()
+  for thread in threads:
+    thread.start()
+  for thread in threads:
+    thread.join()
+  elapsed = time.time() - start
+
+  for conn in idle + active:
+    conn.close()
+
+  if not latencies:
+    return
+
+  latencies.sort()
+  count = len(latencies)
+  print('%d requests in %.2f s (%.0f requests/s)'
+        % (count, elapsed, count / elapsed))
+  print('latency [ms]: min %.2f  median %.2f  90%% %.2f  max %.2f'
+        % (latencies[0] * 1000, latencies[count // 2] * 1000,
+           latencies[count * 9 // 10] * 1000, latencies[-1] * 1000))
+
+
+if __name__ == '__main__':
+  main()
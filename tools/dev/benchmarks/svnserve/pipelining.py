@@ -0,0 +1,114 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Usage: pipelining.py [options] svn://HOST[:PORT]/REPOS PATH...
+
+Compare sequential and pipelined ra_svn command execution.
+
+Issues one 'stat' command per PATH in HEAD, first waiting for each
+response before sending the next command, then with up to DEPTH
+commands in flight using the 'pipelined' command wrapper.  Both are
+repeated ROUNDS times and the time per round is reported.
+
+The difference shows with network latency.  To simulate that on the
+loopback interface, run (as root) e.g.
+
+  tc qdisc add dev lo root netem delay 25ms
+
+and remove the delay afterwards with
+
+  tc qdisc del dev lo root
+
+The repository must allow anonymous read access and the server must
+announce the pipelined-reads capability.
+"""
+
+import optparse
+import time
+
+try:
+  from urllib.parse import urlparse
+except ImportError:
+  from urlparse import urlparse
+
+from idle_connections import Connection
+
+
+def stat_command(path):
+  return '( stat ( %d:%s ( ) ) ) ' % (len(path), path)
+
+
+def read_response(conn):
+  """Read the auth request and the command response.  A failed pipelined
+  command only sends a single failure response."""
+  if conn.read_item().startswith(b'( failure'):
+    return
+  conn.read_item()
+
+
+def sequential(conn, paths):
+  for path in paths:
+    conn.write(stat_command(path))
+    read_response(conn)
+
+
+def pipelined(conn, paths, depth):
+  sent = 0
+  for received in range(len(paths)):
+    while sent < len(paths) and sent - received < depth:
+      conn.write('( pipelined %s) ' % stat_command(paths[sent]))
+      sent += 1
+    read_response(conn)
+
+
+def measure(name, func, rounds):
+  start = time.time()
+  for i in range(rounds):
+    func()
+  elapsed = time.time() - start
+  print('%-10s %.2f ms per round' % (name, elapsed * 1000 / rounds))
+
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('-r', '--rounds', type='int', default=10,
+                    help='number of rounds [%default]')
+  parser.add_option('-d', '--depth', type='int', default=32,
+                    help='maximum number of commands in flight [%default]')
+  options, args = parser.parse_args()
+  if len(args) < 2:
+    parser.error('wrong number of arguments')
+
+  url = args[0]
+  paths = [path.lstrip('/') for path in args[1:]]
+  parsed = urlparse(url)
+  if parsed.scheme != 'svn':
+    parser.error('URL must use the svn:// scheme')
+  host = parsed.hostname
+  port = parsed.port or 3690
+
+  conn = Connection(url, host, port)
+  measure('sequential', lambda: sequential(conn, paths), options.rounds)
+  measure('pipelined', lambda: pipelined(conn, paths, options.depth),
+          options.rounds)
+  conn.close()
+
+
+if __name__ == '__main__':
+  main()
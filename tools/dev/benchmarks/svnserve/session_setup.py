@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Usage: session_setup.py [options] svn://HOST[:PORT]/REPOS
+
+Measure the svnserve connection setup latency.
+
+Opens SESSIONS short-lived connections one after another, similar to
+build bots polling a repository with 'svn info'.  Each session performs
+the handshake (which opens the repository on the server side), issues a
+single 'get-latest-rev' command and disconnects.  The latencies of the
+setup and of the command are reported separately.
+
+The repository must allow anonymous read access.
+"""
+
+import optparse
+import time
+
+try:
+  from urllib.parse import urlparse
+except ImportError:
+  from urlparse import urlparse
+
+from idle_connections import Connection
+
+
+def report(name, latencies):
+  latencies = sorted(latencies)
+  count = len(latencies)
+  print('%-8s [ms]: min %.2f  median %.2f  90%% %.2f  max %.2f'
+        % (name, latencies[0] * 1000, latencies[count // 2] * 1000,
+           latencies[count * 9 // 10] * 1000, latencies[-1] * 1000))
+
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('-s', '--sessions', type='int', default=1000,
+                    help='number of sessions to open [%default]')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('wrong number of arguments')
+  if options.sessions < 1:
+    parser.error('need at least one session')
+
+  url = args[0]
+  parsed = urlparse(url)
+  if parsed.scheme != 'svn':
+    parser.error('URL must use the svn:// scheme')
+  host = parsed.hostname
+  port = parsed.port or 3690
+
+  setup = []
+  command = []
+  for i in range(options.sessions):
+    start = time.time()
+    conn = Connection(url, host, port)
+    connected = time.time()
+    conn.get_latest_rev()
+    command.append(time.time() - connected)
+    setup.append(connected - start)
+    conn.close()
+
+  report('setup', setup)
+  report('command', command)
+
+
+if __name__ == '__main__':
+  main()